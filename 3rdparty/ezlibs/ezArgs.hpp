@@ -40,6 +40,10 @@ SOFTWARE.
 
 #include "ezLog.hpp"
 
+#ifndef EZ_STATS_SPAN  // include ezStats.hpp before this include for the trace spans
+#define EZ_STATS_SPAN(category, name)
+#endif  // EZ_STATS_SPAN
+
 namespace ez {
 
 class Args {
@@ -251,12 +255,14 @@ public:
     void printHelp() const { std::cout << getHelp() << std::endl; }
 
     bool parse(const int32_t vArgc, char **vArgv, const int32_t vStartIdx = 1U) {
+        EZ_STATS_SPAN("Args", "parse");
         size_t positional_idx = 0;
         for (int32_t idx = vStartIdx; idx < vArgc; ++idx) {
             std::string arg = m_trim(vArgv[idx]);
 
-            // print help
+            // print help, isPresent("help") tell the caller to stop there
             if (m_HelpArgument.m_full_args.find(arg) != m_HelpArgument.m_full_args.end()) {
+                m_HelpArgument.m_is_present = true;
                 printHelp();
                 return m_errors.empty();
             }
@@ -366,6 +372,9 @@ private:
                 }
             }
         }
+        if (ret == nullptr && m_HelpArgument.m_full_args.find(vKey) != m_HelpArgument.m_full_args.end()) {
+            ret = &m_HelpArgument;
+        }
         if (ret == nullptr && vNoExcept == false) {
             throw std::runtime_error("Argument not found");
         }
@@ -486,4 +495,10 @@ inline bool Args::m_convertString<bool>(const std::string &str) const {
     }
     throw std::runtime_error("Invalid boolean string");
 }
+
+// the value as is, a path can hold spaces
+template <>
+inline std::string Args::m_convertString<std::string>(const std::string &str) const {
+    return str;
+}
 }  // namespace ez
@@ -0,0 +1,542 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezBatchIO is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// read or write many small files in a few batches.
+// use io_uring on linux when available, else the blocking calls
+
+#include "ezOS.hpp"
+#include "ezFile.hpp"
+
+#if defined(LINUX_OS) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define EZ_BATCH_IO_URING
+#endif
+#endif
+
+#ifdef EZ_BATCH_IO_URING
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+namespace ez {
+
+class BatchIO {
+public:
+    // called once per file as soon as its content is final, vOk is false if it cant be read
+    typedef std::function<void(const size_t vIdx, const bool vOk)> ReadFunctor;
+
+private:
+    bool m_useIoUring = false;
+#ifdef EZ_BATCH_IO_URING
+    static constexpr uint32_t ringEntries = 256U;
+    static constexpr size_t readChunkSize = 65536U;  // enough for a build id header in one read
+    static constexpr size_t maxFilesPerBatch = 1024U;  // files opened at once, if the limit of the process allows it
+    int m_ringFd = -1;
+    void* m_sqPtr = nullptr;
+    void* m_cqPtr = nullptr;
+    size_t m_sqSize = 0;
+    size_t m_cqSize = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqesSize = 0;
+    uint32_t* m_sqHead = nullptr;
+    uint32_t* m_sqTail = nullptr;
+    uint32_t* m_sqMask = nullptr;
+    uint32_t* m_sqArray = nullptr;
+    uint32_t m_sqEntries = 0;
+    uint32_t* m_cqHead = nullptr;
+    uint32_t* m_cqTail = nullptr;
+    uint32_t* m_cqMask = nullptr;
+    io_uring_cqe* m_cqes = nullptr;
+#endif
+
+public:
+    BatchIO(const bool vUseIoUring = true) {
+#ifdef EZ_BATCH_IO_URING
+        if (vUseIoUring) {
+            m_useIoUring = m_initRing();
+        }
+#else
+        (void)vUseIoUring;
+#endif
+    }
+    ~BatchIO() {
+#ifdef EZ_BATCH_IO_URING
+        m_releaseRing();
+#endif
+    }
+    BatchIO(const BatchIO&) = delete;
+    BatchIO& operator=(const BatchIO&) = delete;
+
+    bool isIoUringUsed() const { return m_useIoUring; }
+
+    // read the files, vOutStatus[i] is false if the file i cant be read.
+    // vOnRead is called from this thread while the other files are still read, it must not touch vOutStatus
+    void readFiles(const std::vector<std::string>& vFiles,
+                   std::vector<std::string>& vOutContents,
+                   std::vector<bool>& vOutStatus,
+                   const ReadFunctor& vOnRead = nullptr) {
+        vOutContents.resize(vFiles.size());
+        vOutStatus.assign(vFiles.size(), false);
+        std::vector<bool> blocking(vFiles.size(), true);  // the files left to the blocking path
+#ifdef EZ_BATCH_IO_URING
+        if (m_useIoUring) {
+            const size_t filesPerBatch = m_getFilesPerBatch();
+            for (size_t begin = 0; begin < vFiles.size() && m_useIoUring; begin += filesPerBatch) {
+                m_readFilesUring(vFiles, begin, std::min(vFiles.size(), begin + filesPerBatch), vOutContents, vOutStatus, blocking, vOnRead);
+            }
+        }
+#endif
+        for (size_t i = 0; i < vFiles.size(); ++i) {
+            if (blocking[i]) {
+                vOutStatus[i] = m_readFileBlocking(vFiles[i], vOutContents[i]);
+                if (vOnRead) {
+                    vOnRead(i, vOutStatus[i]);
+                }
+            }
+        }
+    }
+
+    // write the files in a temporary file then rename it, vOutStatus[i] is false if the file i cant be written
+    void writeFiles(const std::vector<std::string>& vFiles, const std::vector<const std::string*>& vContents, std::vector<bool>& vOutStatus) {
+        vOutStatus.assign(vFiles.size(), false);
+        std::vector<std::string> tmpFiles(vFiles.size());
+        for (size_t i = 0; i < vFiles.size(); ++i) {
+            ez::file::getTempFileName(vFiles[i], tmpFiles[i]);
+        }
+        std::vector<bool> blocking(vFiles.size(), true);  // the files left to the blocking path
+#ifdef EZ_BATCH_IO_URING
+        if (m_useIoUring) {
+            const size_t filesPerBatch = m_getFilesPerBatch();
+            for (size_t begin = 0; begin < vFiles.size() && m_useIoUring; begin += filesPerBatch) {
+                m_writeFilesUring(vFiles, tmpFiles, vContents, begin, std::min(vFiles.size(), begin + filesPerBatch), vOutStatus, blocking);
+            }
+        }
+#endif
+        for (size_t i = 0; i < vFiles.size(); ++i) {
+            if (blocking[i]) {
+                vOutStatus[i] = m_writeFileBlocking(vFiles[i], tmpFiles[i], *vContents[i]);
+            }
+        }
+    }
+
+private:
+    static bool m_readFileBlocking(const std::string& vFile, std::string& vOutContent) {
+        std::ifstream file(vFile, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        vOutContent.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    static bool m_writeFileBlocking(const std::string& vFile, const std::string& vTmpFile, const std::string& vContent) {
+        return ez::file::writeThenRename(vTmpFile, vFile, vContent.data(), vContent.size());
+    }
+
+#ifdef EZ_BATCH_IO_URING
+    bool m_initRing() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, ringEntries, &params));
+        if (m_ringFd < 0) {
+            return false;  // not available (old kernel, seccomp, etc..)
+        }
+        m_sqSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            m_sqSize = m_cqSize = std::max(m_sqSize, m_cqSize);
+        }
+        m_sqPtr = mmap(nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqPtr == MAP_FAILED) {
+            m_sqPtr = nullptr;
+            m_releaseRing();
+            return false;
+        }
+        if (singleMmap) {
+            m_cqPtr = m_sqPtr;
+        } else {
+            m_cqPtr = mmap(nullptr, m_cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+            if (m_cqPtr == MAP_FAILED) {
+                m_cqPtr = nullptr;
+                m_releaseRing();
+                return false;
+            }
+        }
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            m_releaseRing();
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+        auto* sq = static_cast<uint8_t*>(m_sqPtr);
+        auto* cq = static_cast<uint8_t*>(m_cqPtr);
+        m_sqHead = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+        m_sqMask = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        m_sqEntries = params.sq_entries;
+        m_cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+        m_cqMask = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        if (!m_isSupported()) {
+            m_releaseRing();
+            return false;
+        }
+        return true;
+    }
+
+    void m_releaseRing() {
+        if (m_sqes != nullptr) {
+            munmap(m_sqes, m_sqesSize);
+            m_sqes = nullptr;
+        }
+        if (m_cqPtr != nullptr && m_cqPtr != m_sqPtr) {
+            munmap(m_cqPtr, m_cqSize);
+        }
+        m_cqPtr = nullptr;
+        if (m_sqPtr != nullptr) {
+            munmap(m_sqPtr, m_sqSize);
+            m_sqPtr = nullptr;
+        }
+        if (m_ringFd >= 0) {
+            close(m_ringFd);
+            m_ringFd = -1;
+        }
+    }
+
+    // all the opcodes used must be known by the kernel
+    bool m_isSupported() {
+        static constexpr size_t opsCount = 256U;
+        std::vector<uint8_t> buffer(sizeof(io_uring_probe) + opsCount * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PROBE, probe, opsCount) < 0) {
+            return false;
+        }
+        const uint8_t needed[] = {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE, IORING_OP_RENAMEAT};
+        for (const auto op : needed) {
+            if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the files opened at once by a batch : half of the limit of the process, the other half is left to its other files.
+    // a file still refused for lack of descriptors is done with the blocking path
+    static size_t m_getFilesPerBatch() {
+        size_t ret = maxFilesPerBatch;
+        rlimit limit{};
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+            ret = std::min<size_t>(ret, static_cast<size_t>(limit.rlim_cur / 2U));
+        }
+        return std::max<size_t>(ret, 1U);
+    }
+
+    // the file can be done by the blocking path : no descriptor left, or its sqe was not submitted
+    static bool m_isRetryable(const int32_t vResult) { return vResult == -EMFILE || vResult == -ENFILE || vResult == -ECANCELED; }
+
+    // submit all the sqes by chunks of the ring size and wait their completion.
+    // vOutResults[i] is the result of vSqes[i], -ECANCELED if it was not submitted.
+    // on an error of the ring, the sqes not taken by the kernel are withdrawn but the submitted ones are still waited,
+    // the kernel use their buffers until their completion. returns false on an error.
+    // with vOnComplete, each completion is given as soon as it is reaped, not after the whole chunk
+    bool m_run(std::vector<io_uring_sqe>& vSqes, std::vector<int32_t>& vOutResults, const std::function<void(const size_t vIdx)>& vOnComplete = nullptr) {
+        vOutResults.assign(vSqes.size(), -ECANCELED);
+        bool ret = true;
+        size_t done = 0;
+        while (done < vSqes.size() && ret) {
+            const uint32_t count = static_cast<uint32_t>(std::min<size_t>(m_sqEntries, vSqes.size() - done));
+            const uint32_t firstTail = *m_sqTail;
+            uint32_t tail = firstTail;
+            const uint32_t mask = *m_sqMask;
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t idx = tail & mask;
+                m_sqes[idx] = vSqes[done + i];
+                m_sqes[idx].user_data = done + i;
+                m_sqArray[idx] = idx;
+                ++tail;
+            }
+            __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+            uint32_t inFlight = count;  // submitted or to submit, not completed
+            uint32_t completed = 0;
+            uint32_t toSubmit = count;
+            while (completed < inFlight) {
+                const uint32_t toWait = vOnComplete ? 1U : inFlight - completed;
+                const long entered = syscall(__NR_io_uring_enter, m_ringFd, toSubmit, toWait, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (entered >= 0) {
+                    toSubmit -= std::min<uint32_t>(toSubmit, static_cast<uint32_t>(entered));
+                }
+                completed += m_reapCompletions(vOutResults, vOnComplete);
+                if (entered >= 0 || errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                    continue;
+                }
+                if (!ret) {
+                    m_useIoUring = false;  // the ring can't even wait its sqes, it is not used anymore
+                    return false;
+                }
+                ret = false;
+                // the sqes not taken by the kernel are withdrawn, they keep -ECANCELED
+                const uint32_t head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+                __atomic_store_n(m_sqTail, head, __ATOMIC_RELEASE);
+                inFlight = head - firstTail;
+                toSubmit = 0;
+            }
+            done += count;
+        }
+        return ret;
+    }
+
+    // the results of the completions in the ring, returns their count
+    uint32_t m_reapCompletions(std::vector<int32_t>& vOutResults, const std::function<void(const size_t vIdx)>& vOnComplete) {
+        uint32_t ret = 0;
+        uint32_t head = *m_cqHead;
+        const uint32_t cqMask = *m_cqMask;
+        while (head != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) {
+            const auto& cqe = m_cqes[head & cqMask];
+            const auto idx = static_cast<size_t>(cqe.user_data);
+            vOutResults[idx] = cqe.res;
+            ++head;
+            ++ret;
+            if (vOnComplete) {
+                __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);  // the entry is given back to the kernel before the callback
+                vOnComplete(idx);
+            }
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+        return ret;
+    }
+
+    static io_uring_sqe m_makeSqe(const uint8_t vOpCode) {
+        io_uring_sqe sqe;
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = vOpCode;
+        return sqe;
+    }
+
+    static io_uring_sqe m_makeOpen(const std::string& vFile, const int vFlags) {
+        auto sqe = m_makeSqe(IORING_OP_OPENAT);
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<uint64_t>(vFile.c_str());
+        sqe.open_flags = static_cast<uint32_t>(vFlags | O_CLOEXEC);
+        sqe.len = static_cast<uint32_t>(ez::file::tempFileMode);
+        return sqe;
+    }
+
+    static io_uring_sqe m_makeClose(const int vFd) {
+        auto sqe = m_makeSqe(IORING_OP_CLOSE);
+        sqe.fd = vFd;
+        return sqe;
+    }
+
+    // close the opened files in one batch, the closes not done by the ring are done here
+    void m_closeFiles(const std::vector<int32_t>& vFds) {
+        std::vector<io_uring_sqe> sqes;
+        std::vector<int32_t> opened, results;
+        for (const auto fd : vFds) {
+            if (fd >= 0) {
+                sqes.push_back(m_makeClose(fd));
+                opened.push_back(fd);
+            }
+        }
+        if (m_useIoUring) {
+            m_run(sqes, results);
+        }
+        for (size_t j = 0; j < opened.size(); ++j) {
+            if (!m_useIoUring || results[j] == -ECANCELED) {
+                close(opened[j]);
+            }
+        }
+    }
+
+    // 3 batches for the files [vBegin, vEnd) : open all, read all, close all.
+    // vInOutBlocking[i] is cleared for the files done here
+    void m_readFilesUring(const std::vector<std::string>& vFiles,
+                          const size_t vBegin,
+                          const size_t vEnd,
+                          std::vector<std::string>& vOutContents,
+                          std::vector<bool>& vOutStatus,
+                          std::vector<bool>& vInOutBlocking,
+                          const ReadFunctor& vOnRead) {
+        std::vector<io_uring_sqe> sqes;
+        std::vector<int32_t> fds, results;
+        sqes.reserve(vEnd - vBegin);
+        for (size_t i = vBegin; i < vEnd; ++i) {
+            sqes.push_back(m_makeOpen(vFiles[i], O_RDONLY));
+        }
+        m_run(sqes, fds);
+        sqes.clear();
+        std::vector<size_t> indexs;
+        for (size_t k = 0; k < fds.size(); ++k) {
+            const size_t i = vBegin + k;
+            vInOutBlocking[i] = m_isRetryable(fds[k]);
+            if (fds[k] < 0 && !vInOutBlocking[i] && vOnRead) {
+                vOnRead(i, false);
+            }
+            if (fds[k] >= 0) {
+                vOutContents[i].resize(readChunkSize);
+                auto sqe = m_makeSqe(IORING_OP_READ);
+                sqe.fd = fds[k];
+                sqe.addr = reinterpret_cast<uint64_t>(&vOutContents[i][0]);
+                sqe.len = static_cast<uint32_t>(readChunkSize);
+                sqe.off = 0;
+                sqes.push_back(sqe);
+                indexs.push_back(i);
+            }
+        }
+        // a file is given to vOnRead from the completion loop, the reads of the others still in flight
+        std::vector<uint8_t> completed(indexs.size(), 0);
+        auto onComplete = [&](const size_t j) {
+            const size_t i = indexs[j];
+            completed[j] = 1;
+            if (results[j] >= 0) {
+                vOutContents[i].resize(static_cast<size_t>(results[j]));
+                vOutStatus[i] = true;
+                if (static_cast<size_t>(results[j]) == readChunkSize) {
+                    // bigger than a chunk (large figfont label), the rest is read with the blocking path
+                    vInOutBlocking[i] = true;
+                }
+            } else {
+                vOutContents[i].clear();
+                vInOutBlocking[i] = m_isRetryable(results[j]);
+            }
+            if (!vInOutBlocking[i] && vOnRead) {
+                vOnRead(i, vOutStatus[i]);
+            }
+        };
+        if (m_useIoUring) {
+            m_run(sqes, results, onComplete);
+        } else {
+            results.assign(sqes.size(), -ECANCELED);
+        }
+        for (size_t j = 0; j < indexs.size(); ++j) {
+            if (completed[j] == 0) {  // not submitted, -ECANCELED
+                onComplete(j);
+            }
+        }
+        m_closeFiles(fds);
+    }
+
+    // 4 batches for the files [vBegin, vEnd) : open all the tmp files, write all, close all, rename all.
+    // vInOutBlocking[i] is cleared for the files done here
+    void m_writeFilesUring(const std::vector<std::string>& vFiles,
+                           const std::vector<std::string>& vTmpFiles,
+                           const std::vector<const std::string*>& vContents,
+                           const size_t vBegin,
+                           const size_t vEnd,
+                           std::vector<bool>& vOutStatus,
+                           std::vector<bool>& vInOutBlocking) {
+        std::vector<io_uring_sqe> sqes;
+        std::vector<int32_t> fds, results;
+        sqes.reserve(vEnd - vBegin);
+        for (size_t i = vBegin; i < vEnd; ++i) {
+            sqes.push_back(m_makeOpen(vTmpFiles[i], O_WRONLY | O_CREAT | O_TRUNC));
+        }
+        m_run(sqes, fds);
+        sqes.clear();
+        std::vector<size_t> indexs;
+        for (size_t k = 0; k < fds.size(); ++k) {
+            const size_t i = vBegin + k;
+            vInOutBlocking[i] = m_isRetryable(fds[k]);
+            if (fds[k] >= 0) {
+                auto sqe = m_makeSqe(IORING_OP_WRITE);
+                sqe.fd = fds[k];
+                sqe.addr = reinterpret_cast<uint64_t>(vContents[i]->data());
+                sqe.len = static_cast<uint32_t>(vContents[i]->size());
+                sqe.off = 0;
+                sqes.push_back(sqe);
+                indexs.push_back(i);
+            }
+        }
+        if (m_useIoUring) {
+            m_run(sqes, results);
+        } else {
+            results.assign(sqes.size(), -ECANCELED);
+        }
+        std::vector<bool> written(vFiles.size(), false);
+        for (size_t j = 0; j < indexs.size(); ++j) {
+            const size_t i = indexs[j];
+            written[i] = (results[j] >= 0 && static_cast<size_t>(results[j]) == vContents[i]->size());
+            vInOutBlocking[i] = !written[i] && m_isRetryable(results[j]);
+        }
+        m_closeFiles(fds);
+        sqes.clear();
+        indexs.clear();
+        for (size_t k = 0; k < fds.size(); ++k) {
+            const size_t i = vBegin + k;
+            if (written[i]) {
+                auto sqe = m_makeSqe(IORING_OP_RENAMEAT);
+                sqe.fd = AT_FDCWD;
+                sqe.addr = reinterpret_cast<uint64_t>(vTmpFiles[i].c_str());
+                sqe.len = static_cast<uint32_t>(AT_FDCWD);
+                sqe.addr2 = reinterpret_cast<uint64_t>(vFiles[i].c_str());
+                sqes.push_back(sqe);
+                indexs.push_back(i);
+            } else if (fds[k] >= 0) {
+                std::remove(vTmpFiles[i].c_str());
+            }
+        }
+        if (m_useIoUring) {
+            m_run(sqes, results);
+        } else {
+            results.assign(sqes.size(), -ECANCELED);
+        }
+        for (size_t j = 0; j < indexs.size(); ++j) {
+            const size_t i = indexs[j];
+            vOutStatus[i] = (results[j] == 0);
+            if (vOutStatus[i]) {
+                EZ_STATS_ADD(BytesWritten, vContents[i]->size());
+                EZ_STATS_ADD(FilesWritten, 1);
+            }
+            vInOutBlocking[i] = m_isRetryable(results[j]);  // the tmp file is written again then renamed
+            if (!vOutStatus[i] && !vInOutBlocking[i]) {
+                std::remove(vTmpFiles[i].c_str());
+            }
+        }
+    }
+#endif  // EZ_BATCH_IO_URING
+};
+
+}  // namespace ez
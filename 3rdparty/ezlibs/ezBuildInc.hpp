@@ -26,12 +26,59 @@ SOFTWARE.
 
 // ezBuildInc is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
 
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cctype>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
 #include <cstdint>
 #include <fstream>
-#include <sstream>
 #include <iostream>
 
+#if defined(__has_include)
+#if __has_include(<charconv>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#include <charconv>
+#define EZ_BUILDINC_TO_CHARS
+#endif
+#endif
+
+#include "ezFile.hpp"
+#include "ezFileLock.hpp"
+
+#include "ezOS.hpp"
+
+#ifdef EZ_FIG_FONT  // ezFigFont.hpp is included before
+#include "ezFigFontCache.hpp"
+#endif  // EZ_FIG_FONT
+
+#ifdef WINDOWS_OS
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef EZ_STATS_SCOPE  // include ezStats.hpp before this include for enable the stats
+#define EZ_STATS_SCOPE(phase)
+#define EZ_STATS_ADD(counter, value)
+#endif  // EZ_STATS_SCOPE
+
+#ifndef EZ_STATS_SPAN
+#define EZ_STATS_SPAN(category, name)
+#endif  // EZ_STATS_SPAN
+
 // you msut include ezFigFont.hpp before this include 
 // if you want to enable the FigFont Label Generation
 
@@ -46,26 +93,481 @@ namespace ez {
 #define Project_MajorNumber 0
 #define Project_BuildId "0.3.3629"
 #define Project_FigFontLabel "..." // Optionnal
+#define Project_Channel "beta" // Optionnal user fields
+// the user fields and the other lines are kept in their order after the generated lines
+*/
+
+/* Time based build id (no file needed)
+ 63 bits sortable integer :
+ [41 bits : milliseconds since 2024-01-01 UTC][14 bits : node][8 bits : sequence]
+ the node is the hostname hash xor the process id by default, and this start node is claimed
+ on the host (claimNode) : the processes of a user on a host never share a node, even when their hashes collide.
+ the hosts can't see the claims of the others, so the node must be given when many hosts
+ produce ids for the same project, and a given node used on the host is a collision
+*/
+class TimeBuildId {
+public:
+    static constexpr int64_t epochMs = 1704067200000LL;  // 2024-01-01 00:00:00 UTC
+    static constexpr int32_t nodeBits = 14;
+    static constexpr int32_t sequenceBits = 8;
+    static constexpr int64_t nodeMask = (1LL << nodeBits) - 1;
+    static constexpr int64_t sequenceMask = (1LL << sequenceBits) - 1;
+
+private:
+    std::mutex m_mutex;
+    int64_t m_lastMs = 0;
+    int64_t m_sequence = 0;
+    int64_t m_node = 0;
+    bool m_fixedTime = false;
+
+public:
+    TimeBuildId(const int64_t vNode) : m_node(vNode & nodeMask) {}
+    // works like an hybrid logical clock :
+    // the time never go back and the sequence overflow borrows the next millisecond
+    int64_t next() {
+        if (m_fixedTime) {
+            return (m_lastMs << (nodeBits + sequenceBits)) | (m_node << sequenceBits);
+        }
+        const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(  //
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count() -
+            epochMs;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (nowMs > m_lastMs) {
+            m_lastMs = nowMs;
+            m_sequence = 0;
+        } else if (++m_sequence > sequenceMask) {
+            ++m_lastMs;
+            m_sequence = 0;
+        }
+        return (m_lastMs << (nodeBits + sequenceBits)) | (m_node << sequenceBits) | m_sequence;
+    }
+    // wait until the clock is past the last id, so a process claiming the node after us can't give it again
+    void waitPastLastId() {
+        if (m_fixedTime) {
+            return;
+        }
+        int64_t lastMs = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            lastMs = m_lastMs;
+        }
+        while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count() - epochMs <= lastMs) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    // next() will always give the id of this time (SOURCE_DATE_EPOCH for a reproducible build)
+    TimeBuildId& setFixedTime(const int64_t vUnixMs) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lastMs = (std::max)(vUnixMs - epochMs, static_cast<int64_t>(0));
+        m_sequence = 0;
+        m_fixedTime = true;
+        return *this;
+    }
+    // the SOURCE_DATE_EPOCH env var, in seconds since the unix epoch
+    static bool getSourceDateEpoch(int64_t& vOutSeconds) {
+        const char* value = std::getenv("SOURCE_DATE_EPOCH");
+        if (value == nullptr || *value == '\0') {
+            return false;
+        }
+        int64_t seconds = 0;
+        for (const char* c = value; *c != '\0'; ++c) {
+            if (*c < '0' || *c > '9' || seconds > (INT64_MAX - 9) / 10) {
+                return false;
+            }
+            seconds = seconds * 10 + (*c - '0');
+        }
+        vOutSeconds = seconds;
+        return true;
+    }
+    // claim a node for the life of vOutLock, one byte per node in the lock file shared by the processes of the host.
+    // the next nodes are tried while busy, unless vExact (the node was given, busy is a collision)
+    static bool claimNode(const std::string& vLockFile, const int64_t vNode, const bool vExact, FileLock& vOutLock, int64_t& vOutNode) {
+        for (int64_t idx = 0; idx <= nodeMask; ++idx) {
+            const int64_t node = (vNode + idx) & nodeMask;
+            if (vOutLock.tryLockByte(vLockFile, node)) {
+                vOutNode = node;
+                return true;
+            }
+            if (vExact || !vOutLock.wasBusy()) {
+                break;
+            }
+        }
+#ifdef EZ_TOOLS_LOG
+        LogVarError("Failed to claim the node %lld in %s", static_cast<long long>(vNode), vLockFile.c_str());
+#endif  // EZ_TOOLS_LOG
+        return false;
+    }
+    // the lock file of the nodes, in a dir of the user : a lock file shared by the users of the host
+    // would be owned by the first one, and not writable by the others
+    static std::string getNodeLockFile() {
+#ifdef WINDOWS_OS
+        const char* dir = std::getenv("TEMP");  // per user
+        std::string ret = (dir != nullptr && *dir != '\0') ? dir : ".";
+        return ret + "\\buildinc-nodes";
+#else
+        const char* dir = std::getenv("XDG_RUNTIME_DIR");  // per user
+        if (dir != nullptr && *dir != '\0') {
+            return std::string(dir) + "/buildinc-nodes";
+        }
+        dir = std::getenv("TMPDIR");
+        std::string ret = (dir != nullptr && *dir != '\0') ? dir : "/tmp";
+        return ret + "/buildinc-nodes-" + std::to_string(static_cast<unsigned long long>(getuid()));
+#endif
+    }
+    static int64_t getDefaultNode(const std::string& vHostName, const int64_t vProcessId) {
+        uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+        for (const auto c : vHostName) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+        }
+        // xor keep the process ids distinct on a same host
+        return static_cast<int64_t>((hash ^ static_cast<uint64_t>(vProcessId)) & nodeMask);
+    }
+};
+
+/* Sharded build number (one slot per worker, no lock)
+ the worker k of K (k in [1, K]) gives k, k+K, k+2K, ...
+ the slot file is made of K fixed size rows, the worker k only write the row k-1
+ so two workers never touch the same bytes
 */
+class ShardBuildNumber {
+public:
+    static constexpr size_t slotSize = 21;  // 20 digits + '\n'
+
+private:
+    std::string m_slotFile;
+    int64_t m_shard = 0;
+    int64_t m_shardCount = 0;
+
+public:
+    ShardBuildNumber(const std::string& vSlotFile, const int64_t vShard, const int64_t vShardCount)
+        : m_slotFile(vSlotFile), m_shard(vShard), m_shardCount(vShardCount) {}
+    bool isValid() const { return m_shardCount > 0 && m_shard >= 1 && m_shard <= m_shardCount; }
+    // give the next number of the shard and commit it in the slot
+    bool next(const int64_t vFloor, int64_t& vOutNumber) {
+        if (!isValid()) {
+            return false;
+        }
+        {  // create the file without truncate it if another worker did it before
+            std::ofstream create(m_slotFile, std::ios::out | std::ios::binary | std::ios::app);
+        }
+        std::fstream file(m_slotFile, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        const auto offset = static_cast<std::streamoff>((m_shard - 1) * slotSize);
+        char slot[slotSize] = {};
+        file.seekg(offset);
+        file.read(slot, slotSize);
+        file.clear();
+        // the floor is only used to start an empty slot above the previous numbering
+        const int64_t last = m_parseSlot(slot);
+        int64_t base = (last > 0) ? last : vFloor;
+        if (base < 0) {
+            base = 0;
+        }
+        // first number > base in the sequence of the shard
+        int64_t number = base + ((m_shard - base) % m_shardCount + m_shardCount) % m_shardCount;
+        if (number <= base) {
+            number += m_shardCount;
+        }
+        std::snprintf(slot, slotSize, "%020lld", static_cast<long long>(number));
+        slot[slotSize - 1] = '\n';
+        file.seekp(offset);
+        file.write(slot, slotSize);
+        file.flush();
+        if (!file.good()) {
+            return false;
+        }
+        vOutNumber = number;
+        return true;
+    }
+    // the highest number committed by all the workers
+    int64_t getHighestCommitted() const {
+        int64_t ret = 0;
+        std::ifstream file(m_slotFile, std::ios::in | std::ios::binary);
+        char slot[slotSize] = {};
+        while (file.read(slot, slotSize)) {
+            const int64_t number = m_parseSlot(slot);
+            if (ret < number) {
+                ret = number;
+            }
+        }
+        return ret;
+    }
+
+private:
+    // an empty slot (never written or hole of the file) is 0
+    static int64_t m_parseSlot(const char* vSlot) {
+        int64_t ret = 0;
+        for (size_t i = 0; i < slotSize - 1; ++i) {
+            if (vSlot[i] < '0' || vSlot[i] > '9') {
+                return 0;
+            }
+            ret = ret * 10 + (vSlot[i] - '0');
+        }
+        return ret;
+    }
+};
+
+namespace buildinc {
+
+// the keys generated by BuildInc, the others are user fields
+enum class Key : uint8_t { Unknown = 0, Label, BuildNumber, MinorNumber, MajorNumber, BuildId, BuildIdNum, FigFontLabel, Marker, Count };
+
+constexpr const char* keyNames[] = {"", "Label", "BuildNumber", "MinorNumber", "MajorNumber", "BuildId", "BuildIdNum", "FigFontLabel", "Marker"};
+
+// the marker is a string compiled in the binaries, 'BUILDINC\nProject=..\nLabel=..\n..', ended by '\0'.
+// gcc and clang put it in this section of the elf files
+constexpr const char markerTag[] = "BUILDINC\n";
+constexpr const char markerSection[] = ".buildinc";
+
+constexpr size_t keyLen(const char* vStr) {
+    size_t len = 0;
+    while (vStr[len] != '\0') {
+        ++len;
+    }
+    return len;
+}
+
+// perfect hash of the built-in keys, the 2 first chars and the length are enough
+constexpr size_t keyHash(const char* vStr, const size_t vLen) {
+    return vLen < 2 ? 0 : (static_cast<size_t>(static_cast<unsigned char>(vStr[0])) * 3U + static_cast<unsigned char>(vStr[1]) + vLen) & 15U;
+}
+
+struct KeyTable {
+    Key slots[16] = {};
+};
+
+constexpr KeyTable makeKeyTable() {
+    KeyTable table;
+    for (size_t k = 1; k < static_cast<size_t>(Key::Count); ++k) {
+        table.slots[keyHash(keyNames[k], keyLen(keyNames[k]))] = static_cast<Key>(k);
+    }
+    return table;
+}
+
+constexpr bool isPerfectHash() {
+    bool used[16] = {};
+    for (size_t k = 1; k < static_cast<size_t>(Key::Count); ++k) {
+        const auto slot = keyHash(keyNames[k], keyLen(keyNames[k]));
+        if (slot == 0 || used[slot]) {  // slot 0 is the 'too short' slot
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+static_assert(isPerfectHash(), "the built-in keys of BuildInc collide, change keyHash");
+
+// a function like macro or a comment is not a field
+inline bool isIdentifier(const std::string& vStr) {
+    if (vStr.empty()) {
+        return false;
+    }
+    for (const auto c : vStr) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// will parse a line '#define [PROJECT]_[KEY] [VALUE]', the value is kept as is (quotes included)
+// return true is succeed, false if the format is not recognized
+inline bool parseDefine(const std::string& vRowContent, std::string& vOutProject, std::string& vOutKey, std::string& vOutValue) {
+    if (vRowContent.compare(0, 8, "#define ") == 0) {
+        const size_t def_pos = 8;  // offset for '#define '
+        size_t underScore_pos = vRowContent.find('_', def_pos);
+        if (underScore_pos != std::string::npos) {
+            vOutProject = vRowContent.substr(def_pos, underScore_pos - def_pos);
+            ++underScore_pos;  // offset for '_'
+            size_t space_pos = vRowContent.find(' ', underScore_pos);
+            if (space_pos != std::string::npos) {
+                vOutKey = vRowContent.substr(underScore_pos, space_pos - underScore_pos);
+                ++space_pos;  // offset for ' '
+                const auto first = vRowContent.find_first_not_of(" \t", space_pos);
+                const auto last = vRowContent.find_last_not_of(" \t");
+                vOutValue = (first == std::string::npos) ? std::string() : vRowContent.substr(first, last + 1 - first);
+                return isIdentifier(vOutProject) && isIdentifier(vOutKey);
+            }
+        }
+    }
+    return false;
+}
+
+// keep some room after the content of a reused buffer,
+// so a number getting one more digit at the next write do not reallocate it
+inline void reserveRoom(std::string& vBuffer, const size_t vSize) {
+    if (vBuffer.capacity() < vSize + 16) {
+        vBuffer.reserve(vSize + 64);
+    }
+}
+
+// append a number without temporary string, left padded with zeros to vMinDigits
+inline void appendNumber(std::string& vOut, const int64_t vNumber, const size_t vMinDigits = 1) {
+    char buffer[24];
+#ifdef EZ_BUILDINC_TO_CHARS
+    char* const end = std::to_chars(buffer, buffer + sizeof(buffer), vNumber).ptr;
+#else
+    char* end = buffer;
+    uint64_t number = (vNumber < 0) ? (0ULL - static_cast<uint64_t>(vNumber)) : static_cast<uint64_t>(vNumber);
+    if (vNumber < 0) {
+        *end++ = '-';
+    }
+    char* const digits = end;
+    do {
+        *end++ = static_cast<char>('0' + number % 10U);
+        number /= 10U;
+    } while (number != 0U);
+    std::reverse(digits, end);
+#endif
+    const auto len = static_cast<size_t>(end - buffer);
+    if (len < vMinDigits) {
+        vOut.append(vMinDigits - len, '0');
+    }
+    vOut.append(buffer, end);
+}
+
+// write the whole buffer, one syscall if the kernel take it all
+inline bool writeAll(const int vFd, const std::string& vContent) {
+    size_t offset = 0;
+    while (offset < vContent.size()) {
+#ifdef WINDOWS_OS
+        const auto count = _write(vFd, vContent.data() + offset, static_cast<unsigned int>(vContent.size() - offset));
+#else
+        const auto count = ::write(vFd, vContent.data() + offset, vContent.size() - offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (count <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+// read a whole file in vOut, whose capacity is reused.
+// vExpectedSize > 0 stop the read if the file size is not this one
+inline bool readFile(const std::string& vFilePathName, std::string& vOut, const size_t vExpectedSize = 0) {
+    vOut.clear();
+#ifdef WINDOWS_OS
+    std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const auto size = static_cast<size_t>(file.tellg());
+    if (vExpectedSize > 0 && size != vExpectedSize) {
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    reserveRoom(vOut, size);
+    vOut.resize(size);
+    if (size > 0) {
+        file.read(&vOut[0], static_cast<std::streamsize>(size));
+    }
+    return file.good();
+#else
+    const int fd = open(vFilePathName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (vExpectedSize > 0 && static_cast<size_t>(st.st_size) != vExpectedSize)) {
+        close(fd);
+        return false;
+    }
+    reserveRoom(vOut, static_cast<size_t>(st.st_size));
+    vOut.resize(static_cast<size_t>(st.st_size));
+    size_t offset = 0;
+    while (offset < vOut.size()) {
+        const auto count = ::read(fd, &vOut[offset], vOut.size() - offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        offset += static_cast<size_t>(count);
+    }
+    close(fd);
+    vOut.resize(offset);
+    return offset == static_cast<size_t>(st.st_size);
+#endif
+}
+
+// one table lookup then one compare
+inline Key findKey(const char* vStr, const size_t vLen) {
+    static constexpr KeyTable table = makeKeyTable();
+    const auto key = table.slots[keyHash(vStr, vLen)];
+    const char* name = keyNames[static_cast<size_t>(key)];
+    if (key != Key::Unknown && keyLen(name) == vLen && std::memcmp(name, vStr, vLen) == 0) {
+        return key;
+    }
+    return Key::Unknown;
+}
+
+}  // namespace buildinc
+
+class MultiBuildInc;
 
 class BuildInc {
+    friend class MultiBuildInc;
+
+public:
+    enum class OutputFormat { Header = 0, Json, CMake, Env, Python, Count };
+    struct Output {
+        OutputFormat format = OutputFormat::Header;
+        std::string filePathName;
+    };
+
 private:
+    // a line of the header not generated by BuildInc, kept in the original order
+    struct ExtraLine {
+        std::string raw;  // the line as read with its end ('\n', '\r\n' or none at the end of the file), written back verbatim if not modified
+        std::string project;  // project of the field
+        std::string key;  // not empty for a user field '#define [PROJECT]_[KEY] [VALUE]'
+        std::string value;  // c value of the field, quotes included
+        bool modified = false;
+    };
     bool m_lastWriteStatus = false;
+    std::vector<Output> m_outputs;  // written in addition of the header
+    std::array<std::string, static_cast<size_t>(OutputFormat::Count)> m_buffers;  // reused between writes
+    std::string m_fileBuffer;  // reused for the comparisons
+    std::string m_scratch;  // reused for the intermediate texts
+    std::string m_infos;  // reused for printInfos
+    std::string m_figFontText;  // text of the current figfont label
+    std::string m_figFontLabel;
     std::string m_buildFileHeader;
     std::string m_project;
     std::string m_label;
+    std::vector<std::string> m_readFiles;  // every file read, for the depfile
+    std::vector<ExtraLine> m_extraLines;
     int32_t m_majorNumber = 0;
     int32_t m_minorNumber = 0;
-    int32_t m_buildNumber = 0;
+    int64_t m_buildNumber = 0;
+    bool m_timeBasedBuildNumber = false;
+    bool m_shared = false;  // the parsed file contains many projects
+    bool m_sync = false;  // flush the written files on the disk
+    bool m_reproducible = false;  // normalized paths
+    bool m_marker = false;  // compile a marker in the binaries, for --inspect
 #ifdef EZ_FIG_FONT
     class FigFontGenerator {
         friend class BuildInc;
     private:
         ez::FigFont m_generator;
+        ez::FigFontCache m_cache;
+        std::string m_pendingFile;  // loaded at the first label not found in the cache
+        uint64_t m_digest = 0;
+        bool m_cached = false;  // the labels are searched in the cache
         bool m_useLabel = true;  // will use the label or not for the FigFont label
         bool m_useBuildNumber = false;  // will use the buildNumber or not for the FigFont label
     public:
-        bool isValid() { return m_generator.isValid(); }
+        bool isValid() { return m_generator.isValid() || !m_pendingFile.empty(); }
         FigFontGenerator& useLabel(const bool vFlag) {
             m_useLabel = vFlag;
             return *this;
@@ -78,95 +580,197 @@ private:
 #endif  // EZ_FIG_FONT
 
 public:
-    BuildInc(const std::string& vBuildFileHeader) {
+    // vReadFile at false will not read the current file (time based build number by ex)
+    BuildInc(const std::string& vBuildFileHeader, const bool vReadFile = true) {
         m_buildFileHeader = vBuildFileHeader;
-        read();
+        if (vReadFile) {
+            read();
+        }
     }
     BuildInc& read() {
-        std::string content;
-        std::ifstream docFile(m_buildFileHeader, std::ios::in);
-        if (docFile.is_open()) {
-            std::stringstream strStream;
-            strStream << docFile.rdbuf();
-             content =  strStream.str();
-            docFile.close();
-        } 
-        if (!content.empty()) {
-            size_t startLine = 0;
-            size_t endLine = content.find('\n', startLine);
-            std::string line;
-            std::string project, key, value;
-            while (endLine != std::string::npos) {
-                line = content.substr(startLine, endLine - startLine);
-                if (m_parseDefine(line, project, key, value)) {
-                    m_project = project;  // overwrote each time but its the same for each
-                    if (key == "Label") {
-                        m_label = value;
-                    } else if (key == "MajorNumber") {
-                        m_majorNumber = m_toNumber(value);
-                    } else if (key == "MinorNumber") {
-                        m_minorNumber = m_toNumber(value);
-                    } else if (key == "BuildNumber") {
-                        m_buildNumber = m_toNumber(value);
-                    }
+        {
+            EZ_STATS_SCOPE(Read);
+            if (buildinc::readFile(m_buildFileHeader, m_fileBuffer)) {
+                addReadFile(m_buildFileHeader);
+                EZ_STATS_ADD(BytesRead, m_fileBuffer.size());
+                EZ_STATS_ADD(FilesRead, 1);
+            } else {
+                m_fileBuffer.clear();
+            }
+        }
+        return parse(m_fileBuffer);
+    }
+    // parse the content of a build id file.
+    // the generated lines are parsed, the user fields and the other lines are kept in order
+    BuildInc& parse(const std::string& vContent) {
+        EZ_STATS_SCOPE(Parse);
+        m_extraLines.clear();
+        m_shared = false;
+        bool inFigFontLabel = false;  // the ascii art of the label take many lines (raw string of the old headers)
+        bool inContinuation = false;  // the ascii art of the label, one string per line ended by '\\'
+        bool inMarker = false;  // the marker variable take many lines
+        m_marker = false;
+        size_t startLine = 0;
+        std::string line;
+        std::string project, key, value;
+        while (startLine < vContent.size()) {
+            size_t endLine = vContent.find('\n', startLine);
+            if (endLine == std::string::npos) {
+                endLine = vContent.size();
+            }
+            line = vContent.substr(startLine, endLine - startLine);
+            const size_t rawStart = startLine;
+            startLine = endLine + 1;
+            const size_t rawSize = std::min(startLine, vContent.size()) - rawStart;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (inFigFontLabel) {
+                inFigFontLabel = (line.find(")\"") == std::string::npos);
+                continue;
+            }
+            if (inContinuation) {
+                inContinuation = (!line.empty() && line.back() == '\\');
+                continue;
+            }
+            if (inMarker) {
+                inMarker = (line != "#endif");
+                continue;
+            }
+            if (buildinc::parseDefine(line, project, key, value)) {
+                switch (buildinc::findKey(key.c_str(), key.size())) {
+                    case buildinc::Key::Label: m_label = m_unquote(value); break;
+                    case buildinc::Key::MajorNumber: m_majorNumber = m_toNumber(value); break;
+                    case buildinc::Key::MinorNumber: m_minorNumber = m_toNumber(value); break;
+                    case buildinc::Key::BuildNumber: m_buildNumber = m_toNumber64(value); break;
+                    case buildinc::Key::BuildId:
+                    case buildinc::Key::BuildIdNum: break;  // computed
+                    case buildinc::Key::FigFontLabel: {  // regenerated
+                        const auto pos = line.find("R\"(");
+                        inFigFontLabel = (pos != std::string::npos && line.find(")\"", pos + 3) == std::string::npos);
+                        inContinuation = (!line.empty() && line.back() == '\\');
+                    } break;
+                    case buildinc::Key::Marker: {  // regenerated, and kept
+                        m_marker = true;
+                        inMarker = true;
+                    } break;
+                    default: {
+                        ExtraLine extra;
+                        extra.raw.assign(vContent, rawStart, rawSize);
+                        extra.project = project;
+                        extra.key = key;
+                        extra.value = value;
+                        m_extraLines.push_back(extra);
+                    } continue;
+                }
+                if (!m_project.empty() && m_project != project) {
+                    m_shared = true;
+                }
+                m_project = project;  // overwrote each time but its the same for each, else see MultiBuildInc
+                continue;
+            }
+            if (line == "#pragma once" || (line.empty() && m_extraLines.empty())) {
+                continue;  // generated
+            }
+            ExtraLine extra;
+            extra.raw.assign(vContent, rawStart, rawSize);
+            m_extraLines.push_back(extra);
+        }
+        if (!m_project.empty()) {  // the defines of the other projects are just kept
+            for (auto& extra : m_extraLines) {
+                if (extra.project != m_project) {
+                    extra.key.clear();
                 }
-                startLine = endLine+1;
-                endLine = content.find('\n', startLine);
             }
         }
         return *this;
     }
     std::string getBuildIdInt() {
-        std::stringstream ss;
-        ss << std::setfill('0') << std::setw(2) << m_majorNumber << std::setfill('0') << std::setw(2) << m_minorNumber << m_buildNumber;
-        return ss.str();
+        std::string ret;
+        m_appendBuildIdInt(ret, false);
+        return ret;
     }
     std::string getBuildIdStr() {
-        std::stringstream ss;
-        ss << m_majorNumber << "." << m_minorNumber << "." << m_buildNumber;
-        return ss.str();
+        std::string ret;
+        m_appendBuildIdStr(ret);
+        return ret;
     }
     std::string getInfos() {
-        std::stringstream project, build_id, file, infos;
-        std::string project_str, build_id_str, file_str;
-        build_id << "Build Id : " << getBuildIdStr() << " / " << getBuildIdInt();
-        build_id_str = build_id.str();
-        size_t row_len = build_id_str.size();
-        if (m_lastWriteStatus) {
-            file << "In file : " << m_buildFileHeader;
-        } else {
-            file << "failed to write to : " << m_buildFileHeader;
-        }
-        file_str = file.str();
-        if (row_len < file_str.size()) {
-            row_len = file_str.size();
-        }
-        if (!m_project.empty()) {
-            project << "Project : " << m_project;
-            project_str = project.str();
-            if (row_len < project_str.size()) {
-                row_len = project_str.size();
-            }
-        }
-        auto spliter = std::string(row_len + 6, '-');  // +6 for '-- ' and ' --'
-        infos << spliter << std::endl;
+        std::string ret;
+        appendInfos(ret);
+        return ret;
+    }
+    // the framed summary of the build id
+    void appendInfos(std::string& vOut) {
+        static const char projectTitle[] = "Project : ";
+        static const char fileTitle[] = "In file : ";
+        static const char failedTitle[] = "failed to write to : ";
+        m_scratch.assign("Build Id : ");
+        m_appendBuildIdStr(m_scratch);
+        m_scratch += " / ";
+        m_appendBuildIdInt(m_scratch, false);
+        const char* file_title = m_lastWriteStatus ? fileTitle : failedTitle;
+        const size_t file_len = std::strlen(file_title) + m_buildFileHeader.size();
+        const size_t project_len = m_project.empty() ? 0U : (sizeof(projectTitle) - 1U) + m_project.size();
+        const size_t row_len = (std::max)((std::max)(m_scratch.size(), file_len), project_len);
+        vOut.append(row_len + 6, '-');  // +6 for '-- ' and ' --'
+        vOut += '\n';
         if (!m_project.empty()) {
-            infos << "-- " << project_str << std::string(row_len - project_str.size(), ' ') << " --" << std::endl;
+            vOut += "-- ";
+            vOut += projectTitle;
+            vOut += m_project;
+            m_appendRowEnd(vOut, row_len - project_len);
         }
-        infos << "-- " << build_id_str << std::string(row_len - build_id_str.size(), ' ') << " --" << std::endl;
-        infos << "-- " << file_str << std::string(row_len - file_str.size(), ' ') << " --" << std::endl;
-        infos << spliter << std::endl;
-        return infos.str();
+        vOut += "-- ";
+        vOut += m_scratch;
+        m_appendRowEnd(vOut, row_len - m_scratch.size());
+        vOut += "-- ";
+        vOut += file_title;
+        vOut += m_buildFileHeader;
+        m_appendRowEnd(vOut, row_len - file_len);
+        vOut.append(row_len + 6, '-');
+        vOut += '\n';
     }
+    // the infos are written in one syscall, so the lines of concurrent builds are not mixed
     BuildInc& printInfos() {
-        std::cout << getInfos();
+        m_infos.clear();
+        appendInfos(m_infos);
+        std::cout.flush();  // after what was printed before
+        std::fflush(stdout);
+#ifdef WINDOWS_OS
+        buildinc::writeAll(_fileno(stdout), m_infos);
+#else
+        buildinc::writeAll(STDOUT_FILENO, m_infos);
+#endif
+        return *this;
+    }
+    bool getLastWriteStatus() { return m_lastWriteStatus; }
+    const std::string& getFilePathName() { return m_buildFileHeader; }
+    // flush the written files on the disk before to replace the old ones
+    BuildInc& setSync(const bool vFlag) {
+        m_sync = vFlag;
+        return *this;
+    }
+    // the paths of the depfile are normalized ('/' separators, no './' or '//')
+    // so the same tree gives the same bytes on every host
+    BuildInc& setReproducible(const bool vFlag) {
+        m_reproducible = vFlag;
+        return *this;
+    }
+    // add to the header a marker variable compiled in the binaries,
+    // the build id of a binary can then be found by BuildInspect
+    BuildInc& setMarker(const bool vFlag) {
+        m_marker = vFlag;
         return *this;
     }
+    bool hasMarker() { return m_marker; }
+    // the file parsed contains many projects, it must be updated with MultiBuildInc
+    bool isShared() { return m_shared; }
     const std::string& getProject() { return m_project; }
     const std::string& getLabel() { return m_label; }
     int32_t getMajor() { return m_majorNumber; }
     int32_t getMinor() { return m_minorNumber; }
-    int32_t getBuildNumber() { return m_buildNumber; }
+    int64_t getBuildNumber() { return m_buildNumber; }
     BuildInc& setProject(const std::string& vProject) {
         m_project = vProject;
         return *this;
@@ -183,76 +787,666 @@ public:
         m_minorNumber = vMinorNumber;
         return *this;
     }
-    BuildInc& setBuildNumber(const int32_t vBuildNumber) {
+    BuildInc& setBuildNumber(const int64_t vBuildNumber) {
         m_buildNumber = vBuildNumber;
+        m_timeBasedBuildNumber = false;
         return *this;
     }
     BuildInc& incBuildNumber() {
         ++m_buildNumber;
+        m_timeBasedBuildNumber = false;
         return *this;
     }
+    BuildInc& setTimeBasedBuildNumber(TimeBuildId& vGenerator) {
+        m_buildNumber = vGenerator.next();
+        m_timeBasedBuildNumber = true;
+        return *this;
+    }
+    // user field '#define [PROJECT]_[KEY] [VALUE]', the value is a c value written as is ('"beta"', '42', etc..)
+    // a new field is added after the fields following the generated defines, so never after the foreign lines
+    // (in a #if, after a line without end, ..). an existing field keep its place
+    BuildInc& setField(const std::string& vKey, const std::string& vValue) {
+        if (!buildinc::isIdentifier(vKey) || buildinc::findKey(vKey.c_str(), vKey.size()) != buildinc::Key::Unknown || vValue.find('\n') != std::string::npos) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Invalid user field %s", vKey.c_str());
+#endif  // EZ_TOOLS_LOG
+            return *this;
+        }
+        auto* extra = m_findField(vKey);
+        if (extra == nullptr) {
+            auto pos = m_extraLines.begin();
+            while (pos != m_extraLines.end() && !pos->key.empty()) {
+                ++pos;
+            }
+            extra = &*m_extraLines.insert(pos, ExtraLine());
+            extra->key = vKey;
+        }
+        if (extra->value != vValue || extra->raw.empty()) {
+            extra->value = vValue;
+            extra->modified = true;
+        }
+        return *this;
+    }
+    // same as setField but the text is quoted and escaped
+    BuildInc& setFieldString(const std::string& vKey, const std::string& vText) {
+        return setField(vKey, "\"" + m_escape(vText, "\"\\") + "\"");
+    }
+    bool getField(const std::string& vKey, std::string& vOutValue) {
+        const auto* extra = m_findField(vKey);
+        if (extra == nullptr) {
+            return false;
+        }
+        vOutValue = extra->value;
+        return true;
+    }
+    BuildInc& removeField(const std::string& vKey) {
+        m_extraLines.erase(  //
+            std::remove_if(m_extraLines.begin(), m_extraLines.end(), [&vKey](const ExtraLine& vLine) { return vLine.key == vKey; }),
+            m_extraLines.end());
+        return *this;
+    }
+    // the user fields in the file order, as (key, value)
+    std::vector<std::pair<std::string, std::string>> getFields() {
+        std::vector<std::pair<std::string, std::string>> ret;
+        for (const auto& extra : m_extraLines) {
+            if (!extra.key.empty()) {
+                ret.emplace_back(extra.key, extra.value);
+            }
+        }
+        return ret;
+    }
 #ifdef EZ_FIG_FONT
+    // keep the rendered labels in a directory, a label found there skip the load of the font and its render.
+    // to set before setFigFontFile, an empty directory disable it
+    BuildInc& setLabelCache(const std::string& vDir, const uint64_t vMaxSize = 0) {
+        m_figFontGenerator.m_cache.setDirectory(vDir).setMaxSize(vMaxSize);
+        return *this;
+    }
     FigFontGenerator& setFigFontFile(const std::string& vFigFontFile) {
-        m_figFontGenerator.m_generator.load(vFigFontFile);
-        return m_figFontGenerator;
+        EZ_STATS_SCOPE(FigFont);
+        auto& generator = m_figFontGenerator;
+        m_figFontLabel.clear();  // the label must be rendered again with the new font
+        generator.m_pendingFile.clear();
+        std::string source;
+        // a builtin is rendered faster than a cache entry is read
+        generator.m_cached = generator.m_cache.isEnabled() && !FigFont::isBuiltin(vFigFontFile) &&  //
+            FigFont::getDigest(vFigFontFile, generator.m_digest, source);
+        if (generator.m_cached) {
+            generator.m_generator.load({});  // the previous font is released
+            generator.m_pendingFile = vFigFontFile;
+        } else {
+            generator.m_generator.load(vFigFontFile);
+            source = generator.m_generator.getSourceFile();
+        }
+        if (generator.isValid() && !FigFont::isBuiltin(vFigFontFile)) {  // a builtin is not a file
+            addReadFile(vFigFontFile);
+            if (!source.empty() && source != vFigFontFile) {
+                addReadFile(source);  // the .flf of a .bff, it is checked at each load
+            }
+        }
+        return generator;
     }
 #endif  // EZ_FIG_FONT
+    // register a file read for the build id (the figfont, the shards, etc..)
+    BuildInc& addReadFile(const std::string& vFilePathName) {
+        if (std::find(m_readFiles.begin(), m_readFiles.end(), vFilePathName) == m_readFiles.end()) {
+            m_readFiles.push_back(vFilePathName);
+        }
+        return *this;
+    }
+    const std::vector<std::string>& getReadFiles() { return m_readFiles; }
+    // write a gcc style depfile '<header>: <read files...>' for make/ninja.
+    // the header is read too but is the target, make would drop it as a circular dependency
+    bool writeDepFile(const std::string& vDepFile) {
+        EZ_STATS_SPAN("BuildInc", "depfile");
+        std::string content = m_escapeDepPath(m_buildFileHeader) + ":";
+        for (const auto& file : m_readFiles) {
+            if (file != m_buildFileHeader) {
+                content += " \\\n  " + m_escapeDepPath(file);
+            }
+        }
+        content += "\n";
+        if (m_isSameContent(vDepFile, content)) {
+            return true;  // the mtime is kept, make will not see a change
+        }
+        return ez::file::replace(vDepFile, content, m_sync);
+    }
+    // add a file to write at each write() in addition of the header
+    BuildInc& addOutput(const OutputFormat vFormat, const std::string& vFilePathName) {
+        m_outputs.push_back(Output{vFormat, vFilePathName});
+        return *this;
+    }
+    // write the header and the added outputs.
+    // once warmed up, a write of the same files makes no heap allocation (if the figfont label is unchanged)
     BuildInc& write() {
-        m_lastWriteStatus = false;
-        std::stringstream content;
-        content << "#pragma once" << std::endl;
-        content << std::endl;
-        content << "#define " << m_project << "_Label \"" << m_label << "\"" << std::endl;
-        content << "#define " << m_project << "_BuildNumber " << m_buildNumber << std::endl;
-        content << "#define " << m_project << "_MinorNumber " << m_minorNumber << std::endl;
-        content << "#define " << m_project << "_MajorNumber " << m_majorNumber << std::endl;
-        content << "#define " << m_project << "_BuildId \"" << getBuildIdStr() << "\"" << std::endl;
-        content << "#define " << m_project << "_BuildIdNum " << getBuildIdInt() << std::endl;
+        m_lastWriteStatus = true;
+        m_renderFigFontLabel();
+        m_writeOutput(OutputFormat::Header, m_buildFileHeader);
+        m_writeOutputs();
+        return *this;
+    }
+    // render one format from the current state, without writing it
+    BuildInc& render(const OutputFormat vFormat, std::string& vOut) {
+        m_renderFigFontLabel();
+        m_render(vFormat, vOut);
+        return *this;
+    }
+    // render the defines of the project only, for a header shared by many projects
+    BuildInc& renderHeaderBlock(std::string& vOut) {
+        m_renderFigFontLabel();
+        m_renderHeaderBlock(vOut);
+        return *this;
+    }
+    // render all the outputs from the current state then write them in one pass.
+    // a file is only rewritten if its content changed
+    BuildInc& write(const std::vector<Output>& vOutputs) {
+        m_lastWriteStatus = true;
+        m_renderFigFontLabel();
+        for (const auto& output : vOutputs) {
+            m_writeOutput(output.format, output.filePathName);
+        }
+        return *this;
+    }
+
+private:
+    // the added outputs, the label is already rendered
+    void m_writeOutputs() {
+        for (const auto& output : m_outputs) {
+            m_writeOutput(output.format, output.filePathName);
+        }
+    }
+    void m_writeOutput(const OutputFormat vFormat, const std::string& vFilePathName) {
+        auto& buffer = m_buffers.at(static_cast<size_t>(vFormat));
+        {
+            EZ_STATS_SCOPE(Render);
+            buffer.clear();  // keep the capacity for the next write
+            m_render(vFormat, buffer);
+            buildinc::reserveRoom(buffer, buffer.size());
+        }
+        EZ_STATS_SCOPE(Write);
+        if (!m_isSameContent(vFilePathName, buffer)) {
+            if (!ez::file::replace(vFilePathName, buffer, m_sync)) {
+                m_lastWriteStatus = false;
+            }
+        }
+    }
+    // the label is only rendered again if its text changed
+    void m_renderFigFontLabel() {
 #ifdef EZ_FIG_FONT
         if (m_figFontGenerator.isValid()) {
-            std::stringstream version;
+            EZ_STATS_SCOPE(Render);
+            m_scratch.clear();
             if (m_figFontGenerator.m_useLabel) {
-                version << m_label << " ";
+                m_scratch += m_label;
+                m_scratch += ' ';
             }
-            version << "v" << m_majorNumber << "." << m_minorNumber;
+            m_scratch += 'v';
+            buildinc::appendNumber(m_scratch, m_majorNumber);
+            m_scratch += '.';
+            buildinc::appendNumber(m_scratch, m_minorNumber);
             if (m_figFontGenerator.m_useBuildNumber) {
-                version << "." << m_buildNumber;
+                m_scratch += '.';
+                buildinc::appendNumber(m_scratch, m_buildNumber);
             }
-            content << "#define " << m_project << "_FigFontLabel u8R\"(" << m_figFontGenerator.m_generator.printString(version.str()) << ")\"" << std::endl;
+            if (m_figFontLabel.empty() || m_scratch != m_figFontText) {
+                auto& generator = m_figFontGenerator;
+                m_figFontText = m_scratch;
+                m_figFontLabel.clear();  // keep its capacity
+                if (generator.m_cached && generator.m_cache.load(generator.m_digest, m_figFontText, m_figFontLabel)) {
+                    return;
+                }
+                if (!generator.m_pendingFile.empty()) {
+                    EZ_STATS_SCOPE(FigFont);
+                    generator.m_generator.load(generator.m_pendingFile);
+                    generator.m_pendingFile.clear();
+                }
+                generator.m_generator.appendString(m_figFontLabel, m_figFontText);
+                if (m_figFontLabel.capacity() < m_figFontLabel.size() + m_figFontLabel.size() / 4) {
+                    m_figFontLabel.reserve(m_figFontLabel.size() * 2);  // room for the next digits of the build number
+                }
+                if (generator.m_cached && generator.m_generator.isValid()) {
+                    generator.m_cache.store(generator.m_digest, m_figFontText, m_figFontLabel);
+                }
+            }
+            return;
         }
 #endif  // EZ_FIG_FONT
-        std::ofstream configFileWriter(m_buildFileHeader, std::ios::out);
-        if (!configFileWriter.bad()) {
-            configFileWriter << content.str();
-            configFileWriter.close();
-            m_lastWriteStatus = true;
+        m_figFontLabel.clear();
+    }
+    static void m_appendRowEnd(std::string& vOut, const size_t vPadding) {
+        vOut.append(vPadding, ' ');
+        vOut += " --\n";
+    }
+    // 'major.minor.build'
+    void m_appendBuildIdStr(std::string& vOut) {
+        buildinc::appendNumber(vOut, m_majorNumber);
+        vOut += '.';
+        buildinc::appendNumber(vOut, m_minorNumber);
+        vOut += '.';
+        buildinc::appendNumber(vOut, m_buildNumber);
+    }
+    // 'MMmmbuild', vNoLeadingZeros for the languages where 0 prefix an octal number or is an error (json, python)
+    void m_appendBuildIdInt(std::string& vOut, const bool vNoLeadingZeros) {
+        if (m_timeBasedBuildNumber) {
+            // the time based build number is already sortable, and cant be prefixed without overflow
+            buildinc::appendNumber(vOut, m_buildNumber);
+        } else if (!vNoLeadingZeros) {
+            buildinc::appendNumber(vOut, m_majorNumber, 2);
+            buildinc::appendNumber(vOut, m_minorNumber, 2);
+            buildinc::appendNumber(vOut, m_buildNumber);
+        } else if (m_majorNumber != 0) {
+            buildinc::appendNumber(vOut, m_majorNumber);
+            buildinc::appendNumber(vOut, m_minorNumber, 2);
+            buildinc::appendNumber(vOut, m_buildNumber);
+        } else if (m_minorNumber != 0) {
+            buildinc::appendNumber(vOut, m_minorNumber);
+            buildinc::appendNumber(vOut, m_buildNumber);
+        } else {
+            buildinc::appendNumber(vOut, m_buildNumber);
         }
-        return *this;
     }
-
-private:
-    // will parse a line '#define [PROJECT]_[KEY] [VALUE]'
-    // return true is succeed, false if the format is not recognized
-    bool m_parseDefine(const std::string& vRowContent, std::string& vOutProject, std::string& vOutKey, std::string& vOutValue) {
-        if (!vRowContent.empty()) {
-            size_t def_pos = vRowContent.find("#define ");
-            if (def_pos != std::string::npos) {
-                def_pos += 8;  // offset for '#define '
-                size_t underScore_pos = vRowContent.find('_', def_pos);
-                if (underScore_pos != std::string::npos) {
-                    vOutProject = vRowContent.substr(def_pos, underScore_pos - def_pos);
-                    ++underScore_pos;  // offset for '_'
-                    size_t space_pos = vRowContent.find(' ', underScore_pos);
-                    if (space_pos != std::string::npos) {
-                        vOutKey = vRowContent.substr(underScore_pos, space_pos - underScore_pos);
-                        ++space_pos;  // offset for ' '
-                        vOutValue = m_trim(vRowContent.substr(space_pos));
-                        return true;
-                    }
+    void m_render(const OutputFormat vFormat, std::string& vOut) {
+        switch (vFormat) {
+            case OutputFormat::Header: m_renderHeader(vOut); break;
+            case OutputFormat::Json: m_renderJson(vOut); break;
+            case OutputFormat::CMake: m_renderCMake(vOut); break;
+            case OutputFormat::Env: m_renderEnv(vOut); break;
+            case OutputFormat::Python: m_renderPython(vOut); break;
+            default: break;
+        }
+    }
+    void m_renderHeader(std::string& vOut) {
+        vOut += "#pragma once\n\n";
+        m_renderHeaderBlock(vOut);
+    }
+    // the renderers only append to vOut, without temporary strings
+    void m_appendDefine(std::string& vOut, const char* vKey) {
+        vOut += "#define ";
+        vOut += m_project;
+        vOut += '_';
+        vOut += vKey;
+        vOut += ' ';
+    }
+    // the defines of the project, without the header guard
+    void m_renderHeaderBlock(std::string& vOut) {
+        m_appendDefine(vOut, "Label");
+        vOut += '"';
+        m_appendEscaped(vOut, m_label, "\"\\");
+        vOut += "\"\n";
+        m_appendDefine(vOut, "BuildNumber");
+        buildinc::appendNumber(vOut, m_buildNumber);
+        vOut += '\n';
+        m_appendDefine(vOut, "MinorNumber");
+        buildinc::appendNumber(vOut, m_minorNumber);
+        vOut += '\n';
+        m_appendDefine(vOut, "MajorNumber");
+        buildinc::appendNumber(vOut, m_majorNumber);
+        vOut += '\n';
+        m_appendDefine(vOut, "BuildId");
+        vOut += '"';
+        m_appendBuildIdStr(vOut);
+        vOut += "\"\n";
+        m_appendDefine(vOut, "BuildIdNum");
+        m_appendBuildIdInt(vOut, false);
+        vOut += '\n';
+        if (!m_figFontLabel.empty()) {
+            m_renderFigFontDefine(vOut);
+        }
+        if (m_marker) {
+            m_renderMarker(vOut);
+        }
+        for (const auto& extra : m_extraLines) {
+            if (extra.key.empty() || (!extra.modified && extra.project == m_project)) {
+                vOut += extra.raw;  // byte for byte, its end of line included
+            } else {
+                m_appendDefine(vOut, extra.key.c_str());
+                vOut += extra.value;
+                vOut += '\n';
+            }
+        }
+    }
+    // a raw string cant take many lines in a define, so one escaped string per row, the define is continued by '\\'
+    void m_renderFigFontDefine(std::string& vOut) {
+        m_appendDefine(vOut, "FigFontLabel");
+        size_t start = 0;
+        while (start < m_figFontLabel.size()) {
+            size_t end = m_figFontLabel.find('\n', start);
+            const bool hasNewLine = (end != std::string::npos);
+            if (!hasNewLine) {
+                end = m_figFontLabel.size();
+            }
+            vOut += "\\\n    u8\"";
+            m_appendEscaped(vOut, m_figFontLabel.data() + start, end - start, "\"\\");
+            vOut += hasNewLine ? "\\n\"" : "\"";
+            start = end + 1;
+        }
+        vOut += '\n';
+    }
+    // 'used' keep the variable even if no code read it
+    void m_renderMarker(std::string& vOut) {
+        m_appendDefine(vOut, "Marker");
+        vOut += "\"BUILDINC\\nProject=";
+        vOut += m_project;
+        vOut += "\\nLabel=";
+        m_appendEscaped(vOut, m_label, "\"\\");
+        vOut += "\\nBuildId=";
+        m_appendBuildIdStr(vOut);
+        vOut += "\\nBuildIdNum=";
+        m_appendBuildIdInt(vOut, false);
+        vOut += "\\n\"\n";
+        vOut += "#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__))\n";
+        m_appendMarkerData(vOut, "__attribute__((used, section(\".buildinc\"))) ");
+        vOut += "#elif defined(__GNUC__) || defined(__clang__)\n";
+        m_appendMarkerData(vOut, "__attribute__((used)) ");
+        vOut += "#else\n";
+        m_appendMarkerData(vOut, "");
+        vOut += "#endif\n";
+    }
+    void m_appendMarkerData(std::string& vOut, const char* vAttributes) {
+        vOut += vAttributes;
+        vOut += "static const char ";
+        vOut += m_project;
+        vOut += "_MarkerData[] = ";
+        vOut += m_project;
+        vOut += "_Marker;\n";
+    }
+    void m_renderJson(std::string& vOut) {
+        vOut += "{\n    \"Project\": \"";
+        m_appendJsonEscaped(vOut, m_project);
+        vOut += "\",\n    \"Label\": \"";
+        m_appendJsonEscaped(vOut, m_label);
+        vOut += "\",\n    \"BuildNumber\": ";
+        buildinc::appendNumber(vOut, m_buildNumber);
+        vOut += ",\n    \"MinorNumber\": ";
+        buildinc::appendNumber(vOut, m_minorNumber);
+        vOut += ",\n    \"MajorNumber\": ";
+        buildinc::appendNumber(vOut, m_majorNumber);
+        vOut += ",\n    \"BuildId\": \"";
+        m_appendBuildIdStr(vOut);
+        vOut += "\",\n    \"BuildIdNum\": ";
+        m_appendBuildIdInt(vOut, true);
+        if (!m_figFontLabel.empty()) {
+            vOut += ",\n    \"FigFontLabel\": \"";
+            m_appendJsonEscaped(vOut, m_figFontLabel);
+            vOut += '"';
+        }
+        for (const auto& extra : m_extraLines) {
+            if (!extra.key.empty()) {
+                vOut += ",\n    \"";
+                vOut += extra.key;
+                vOut += "\": ";
+                if (m_isInteger(extra.value)) {
+                    buildinc::appendNumber(vOut, m_toNumber64(extra.value));
+                } else {
+                    vOut += '"';
+                    m_appendJsonEscaped(vOut, m_unquote(extra.value));
+                    vOut += '"';
                 }
             }
         }
-        return false;
+        vOut += "\n}\n";
+    }
+    void m_appendCMakeSet(std::string& vOut, const char* vKey) {
+        vOut += "set(";
+        vOut += m_project;
+        vOut += '_';
+        vOut += vKey;
+        vOut += ' ';
+    }
+    void m_renderCMake(std::string& vOut) {
+        m_appendCMakeSet(vOut, "Label");
+        vOut += '"';
+        m_appendEscaped(vOut, m_label, "\"\\$");
+        vOut += "\")\n";
+        m_appendCMakeSet(vOut, "BuildNumber");
+        buildinc::appendNumber(vOut, m_buildNumber);
+        vOut += ")\n";
+        m_appendCMakeSet(vOut, "MinorNumber");
+        buildinc::appendNumber(vOut, m_minorNumber);
+        vOut += ")\n";
+        m_appendCMakeSet(vOut, "MajorNumber");
+        buildinc::appendNumber(vOut, m_majorNumber);
+        vOut += ")\n";
+        m_appendCMakeSet(vOut, "BuildId");
+        vOut += '"';
+        m_appendBuildIdStr(vOut);
+        vOut += "\")\n";
+        m_appendCMakeSet(vOut, "BuildIdNum");
+        m_appendBuildIdInt(vOut, false);
+        vOut += ")\n";
+        if (!m_figFontLabel.empty()) {
+            m_appendCMakeSet(vOut, "FigFontLabel");
+            vOut += '"';
+            m_appendEscaped(vOut, m_figFontLabel, "\"\\$");
+            vOut += "\")\n";
+        }
+        for (const auto& extra : m_extraLines) {
+            if (!extra.key.empty()) {
+                m_appendCMakeSet(vOut, extra.key.c_str());
+                vOut += '"';
+                m_appendEscaped(vOut, m_unquote(extra.value), "\"\\$");
+                vOut += "\")\n";
+            }
+        }
+    }
+    void m_appendAssign(std::string& vOut, const char* vKey, const char* vAssign) {
+        vOut += m_project;
+        vOut += '_';
+        vOut += vKey;
+        vOut += vAssign;
+    }
+    // single quoted, a quote is written '\''
+    static void m_appendShellQuoted(std::string& vOut, const std::string& vStr) {
+        vOut += '\'';
+        for (const auto c : vStr) {
+            if (c == '\'') {
+                vOut += "'\\''";
+            } else {
+                vOut += c;
+            }
+        }
+        vOut += "'\n";
+    }
+    void m_renderEnv(std::string& vOut) {
+        m_appendAssign(vOut, "Label", "=");
+        m_appendShellQuoted(vOut, m_label);
+        m_appendAssign(vOut, "BuildNumber", "=");
+        buildinc::appendNumber(vOut, m_buildNumber);
+        vOut += '\n';
+        m_appendAssign(vOut, "MinorNumber", "=");
+        buildinc::appendNumber(vOut, m_minorNumber);
+        vOut += '\n';
+        m_appendAssign(vOut, "MajorNumber", "=");
+        buildinc::appendNumber(vOut, m_majorNumber);
+        vOut += '\n';
+        m_appendAssign(vOut, "BuildId", "=");
+        m_appendBuildIdStr(vOut);
+        vOut += '\n';
+        m_appendAssign(vOut, "BuildIdNum", "=");
+        m_appendBuildIdInt(vOut, false);
+        vOut += '\n';
+        if (!m_figFontLabel.empty()) {
+            m_appendAssign(vOut, "FigFontLabel", "=");
+            m_appendShellQuoted(vOut, m_figFontLabel);
+        }
+        for (const auto& extra : m_extraLines) {
+            if (!extra.key.empty()) {
+                m_appendAssign(vOut, extra.key.c_str(), "=");
+                m_appendShellQuoted(vOut, m_unquote(extra.value));
+            }
+        }
+    }
+    void m_renderPython(std::string& vOut) {
+        m_appendAssign(vOut, "Label", " = \"");
+        m_appendEscaped(vOut, m_label, "\"\\");
+        vOut += "\"\n";
+        m_appendAssign(vOut, "BuildNumber", " = ");
+        buildinc::appendNumber(vOut, m_buildNumber);
+        vOut += '\n';
+        m_appendAssign(vOut, "MinorNumber", " = ");
+        buildinc::appendNumber(vOut, m_minorNumber);
+        vOut += '\n';
+        m_appendAssign(vOut, "MajorNumber", " = ");
+        buildinc::appendNumber(vOut, m_majorNumber);
+        vOut += '\n';
+        m_appendAssign(vOut, "BuildId", " = \"");
+        m_appendBuildIdStr(vOut);
+        vOut += "\"\n";
+        m_appendAssign(vOut, "BuildIdNum", " = ");
+        m_appendBuildIdInt(vOut, true);  // leading zeros are a syntax error in python 3
+        vOut += '\n';
+        if (!m_figFontLabel.empty()) {
+            m_appendAssign(vOut, "FigFontLabel", " = \"");
+            m_appendEscaped(vOut, m_figFontLabel, "\"\\");
+            vOut += "\"\n";
+        }
+        for (const auto& extra : m_extraLines) {
+            if (!extra.key.empty()) {
+                m_appendAssign(vOut, extra.key.c_str(), " = ");
+                if (m_isInteger(extra.value)) {
+                    buildinc::appendNumber(vOut, m_toNumber64(extra.value));
+                    vOut += '\n';
+                } else {
+                    vOut += '"';
+                    m_appendEscaped(vOut, m_unquote(extra.value), "\"\\");
+                    vOut += "\"\n";
+                }
+            }
+        }
+    }
+    // escape the chars of vChars with '\' and the new lines, returns and tabs with '\n', '\r' and '\t'
+    static void m_appendEscaped(std::string& vOut, const std::string& vStr, const char* vChars) {
+        m_appendEscaped(vOut, vStr.data(), vStr.size(), vChars);
+    }
+    static void m_appendEscaped(std::string& vOut, const char* vStr, const size_t vLen, const char* vChars) {
+        for (size_t i = 0; i < vLen; ++i) {
+            const char c = vStr[i];
+            if (c == '\n') {
+                vOut += "\\n";
+            } else if (c == '\r') {
+                vOut += "\\r";
+            } else if (c == '\t') {
+                vOut += "\\t";
+            } else {
+                if (std::strchr(vChars, c) != nullptr) {
+                    vOut += '\\';
+                }
+                vOut += c;
+            }
+        }
+    }
+    // json : the quote, the backslash and all the control chars, \u00XX when there is no short form
+    static void m_appendJsonEscaped(std::string& vOut, const std::string& vStr) {
+        static const char hexDigits[] = "0123456789abcdef";
+        for (const auto c : vStr) {
+            const auto u = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                vOut += '\\';
+                vOut += c;
+            } else if (c == '\n') {
+                vOut += "\\n";
+            } else if (c == '\r') {
+                vOut += "\\r";
+            } else if (c == '\t') {
+                vOut += "\\t";
+            } else if (u < 0x20U) {
+                vOut += "\\u00";
+                vOut += hexDigits[u >> 4];
+                vOut += hexDigits[u & 0xFU];
+            } else {
+                vOut += c;
+            }
+        }
+    }
+    static std::string m_escape(const std::string& vStr, const char* vChars) {
+        std::string ret;
+        ret.reserve(vStr.size());
+        m_appendEscaped(ret, vStr, vChars);
+        return ret;
+    }
+    // the file is read in a reused buffer
+    bool m_isSameContent(const std::string& vFilePathName, const std::string& vContent) {
+        if (!buildinc::readFile(vFilePathName, m_fileBuffer, vContent.size())) {
+            return false;
+        }
+        EZ_STATS_ADD(BytesRead, m_fileBuffer.size());
+        EZ_STATS_ADD(FilesRead, 1);
+        return m_fileBuffer == vContent;
+    }
+    // escape the chars meaningful for make and ninja in a depfile
+    std::string m_escapeDepPath(const std::string& vPath) {
+        std::string ret;
+        ret.reserve(vPath.size());
+        for (const auto c : m_reproducible ? m_normalizePath(vPath) : vPath) {
+            if (c == ' ' || c == '#') {
+                ret += '\\';
+            } else if (c == '$') {
+                ret += '$';
+            }
+            ret += c;
+        }
+        return ret;
+    }
+    static std::string m_normalizePath(const std::string& vPath) {
+        std::string ret;
+        ret.reserve(vPath.size());
+        for (size_t i = 0; i < vPath.size(); ++i) {
+            const char c = (vPath[i] == '\\') ? '/' : vPath[i];
+            if (c == '/' && !ret.empty() && ret.back() == '/' && ret.size() > 1) {
+                continue;  // '//', but not the unc prefix
+            }
+            if (c == '/' && ret.size() >= 2 && ret[ret.size() - 1] == '.' && ret[ret.size() - 2] == '/') {
+                ret.pop_back();  // '/./'
+                continue;
+            }
+            ret += c;
+        }
+        while (ret.size() > 2 && ret.compare(0, 2, "./") == 0) {
+            ret.erase(0, 2);
+        }
+        return ret;
+    }
+    ExtraLine* m_findField(const std::string& vKey) {
+        for (auto& extra : m_extraLines) {
+            if (extra.key == vKey) {
+                return &extra;
+            }
+        }
+        return nullptr;
+    }
+    static bool m_isInteger(const std::string& vValue) {
+        size_t start = (!vValue.empty() && vValue[0] == '-') ? 1 : 0;
+        if (vValue.size() <= start || vValue.size() - start > 18) {  // 18 digits always fit in int64
+            return false;
+        }
+        for (size_t i = start; i < vValue.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(vValue[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+    // the text of a c string literal value, else the value as is.
+    // the returned text is valid until the next call
+    const std::string& m_unquote(const std::string& vValue) {
+        if (vValue.size() < 2 || vValue.front() != '"' || vValue.back() != '"') {
+            return vValue;
+        }
+        m_scratch.clear();
+        for (size_t i = 1; i + 1 < vValue.size(); ++i) {
+            if (vValue[i] == '\\' && i + 2 < vValue.size()) {
+                ++i;
+                switch (vValue[i]) {
+                    case 'n': m_scratch += '\n'; break;
+                    case 'r': m_scratch += '\r'; break;
+                    case 't': m_scratch += '\t'; break;
+                    default: m_scratch += vValue[i]; break;
+                }
+            } else {
+                m_scratch += vValue[i];
+            }
+        }
+        return m_scratch;
     }
     int32_t m_toNumber(const std::string& vNum) {
         int32_t ret = 0; // 0 is the default value
@@ -262,13 +1456,180 @@ private:
         }
         return ret;
     }
-    // will remove quotes
-    std::string m_trim(const std::string& vValue) {
-        std::string ret;
-        for (auto& c : vValue) {
-            if (c != '\"') {
-                ret += c;
+    int64_t m_toNumber64(const std::string& vNum) {
+        int64_t ret = 0;  // 0 is the default value
+        try {
+            ret = std::stoll(vNum);
+        } catch (...) {
+        }
+        return ret;
+    }
+};
+
+/* Header of one or many projects
+ one block of defines per project, the block of a project start at its first generated define
+ and end before the first generated define of another project.
+ the file is read and written once under a lock, the blocks not asked are copied byte for byte,
+ so a project never replace or take the numbers of another one
+*/
+class MultiBuildInc {
+private:
+    struct Block {
+        std::string project;  // empty for the lines before the first project
+        std::string content;  // the lines of the block as read
+        std::unique_ptr<BuildInc> builder;  // only for the blocks to update
+    };
+    FileLock m_lock;
+    std::string m_filePathName;
+    std::string m_content;  // as read
+    std::vector<Block> m_blocks;
+    bool m_lastWriteStatus = false;
+    bool m_sync = false;
+
+public:
+    // lock the file until the destruction, then read it
+    explicit MultiBuildInc(const std::string& vFilePathName) : m_filePathName(vFilePathName) {
+        bool locked = false;
+        {
+            EZ_STATS_SPAN("BuildInc", "lock");
+            locked = m_lock.lock(m_filePathName);
+        }
+        if (!locked) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Failed to lock %s", m_filePathName.c_str());
+#endif  // EZ_TOOLS_LOG
+        }
+        {
+            EZ_STATS_SCOPE(Read);
+            if (buildinc::readFile(m_filePathName, m_content)) {
+                EZ_STATS_ADD(BytesRead, m_content.size());
+                EZ_STATS_ADD(FilesRead, 1);
+            }
+        }
+        EZ_STATS_SCOPE(Parse);
+        m_split();
+    }
+    // the content was read by the caller, under its own lock or for a scan. no lock is taken
+    MultiBuildInc(const std::string& vFilePathName, const std::string& vContent) : m_filePathName(vFilePathName), m_content(vContent) {
+        EZ_STATS_SCOPE(Parse);
+        m_split();
+    }
+    bool isLocked() const { return m_lock.isLocked(); }
+    // release the lock before the destruction, for a process staying resident after its write
+    MultiBuildInc& unlock() {
+        m_lock.unlock();
+        return *this;
+    }
+    const std::string& getContent() const { return m_content; }
+    MultiBuildInc& setSync(const bool vFlag) {
+        m_sync = vFlag;
+        return *this;
+    }
+    bool getLastWriteStatus() { return m_lastWriteStatus; }
+    const std::string& getFilePathName() { return m_filePathName; }
+    // the projects of the file, in the file order
+    std::vector<std::string> getProjects() const {
+        std::vector<std::string> ret;
+        for (const auto& block : m_blocks) {
+            if (!block.project.empty()) {
+                ret.push_back(block.project);
+            }
+        }
+        return ret;
+    }
+    // the builder of a project, parsed from its block, or added at the end of the file.
+    // only the blocks asked here are rendered again by write()
+    BuildInc& getProject(const std::string& vProject) {
+        auto it = std::find_if(m_blocks.begin(), m_blocks.end(), [&vProject](const Block& vBlock) { return vBlock.project == vProject; });
+        if (it == m_blocks.end()) {
+            m_blocks.push_back(Block());
+            it = m_blocks.end() - 1;
+            it->project = vProject;
+        }
+        if (it->builder == nullptr) {
+            it->builder.reset(new BuildInc(m_filePathName, false));
+            it->builder->parse(it->content.substr(0, m_getBodySize(it->content)));
+            it->builder->setProject(vProject);
+            if (!m_content.empty()) {
+                it->builder->addReadFile(m_filePathName);
+            }
+        }
+        return *it->builder;
+    }
+    // the file with the asked blocks rendered and the others copied
+    MultiBuildInc& render(std::string& vOut) {
+        EZ_STATS_SCOPE(Render);
+        vOut.reserve(m_content.size() + 256);
+        for (const auto& block : m_blocks) {
+            if (block.builder == nullptr) {
+                vOut += block.content;
+                continue;
             }
+            if (block.content.empty() && !vOut.empty() &&  //
+                (vOut.size() < 2 || vOut[vOut.size() - 1] != '\n' || vOut[vOut.size() - 2] != '\n')) {
+                vOut += '\n';  // a blank line before a new project
+            }
+            block.builder->renderHeaderBlock(vOut);
+            vOut += block.content.substr(m_getBodySize(block.content));  // the blank lines after the block
+        }
+        return *this;
+    }
+    // replace the file if its content changed, then write the outputs added to the builders (json, cmake, ..)
+    bool write() {
+        std::string content;
+        render(content);
+        {
+            EZ_STATS_SCOPE(Write);
+            m_lastWriteStatus = true;
+            if (content != m_content) {
+                m_lastWriteStatus = ez::file::replace(m_filePathName, content, m_sync);
+                if (m_lastWriteStatus) {
+                    m_content = content;
+                }
+            }
+        }
+        bool ret = m_lastWriteStatus;
+        for (auto& block : m_blocks) {
+            if (block.builder != nullptr) {
+                block.builder->m_lastWriteStatus = m_lastWriteStatus;
+                block.builder->m_writeOutputs();
+                ret &= block.builder->m_lastWriteStatus;
+            }
+        }
+        return ret;
+    }
+
+private:
+    void m_split() {
+        m_blocks.clear();
+        m_blocks.push_back(Block());  // the lines before the first project
+        if (m_content.empty()) {
+            m_blocks.back().content = "#pragma once\n\n";
+        }
+        std::string line, project, key, value;
+        size_t startLine = 0;
+        while (startLine < m_content.size()) {
+            size_t endLine = m_content.find('\n', startLine);
+            endLine = (endLine == std::string::npos) ? m_content.size() : endLine + 1;
+            line = m_content.substr(startLine, endLine - startLine);
+            while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+                line.pop_back();
+            }
+            if (buildinc::parseDefine(line, project, key, value) &&  //
+                buildinc::findKey(key.c_str(), key.size()) != buildinc::Key::Unknown &&  //
+                project != m_blocks.back().project) {
+                m_blocks.push_back(Block());
+                m_blocks.back().project = project;
+            }
+            m_blocks.back().content.append(m_content, startLine, endLine - startLine);
+            startLine = endLine;
+        }
+    }
+    // size of the block without its trailing blank lines
+    static size_t m_getBodySize(const std::string& vContent) {
+        size_t ret = vContent.size();
+        while (ret >= 2 && vContent[ret - 1] == '\n' && vContent[ret - 2] == '\n') {
+            --ret;
         }
         return ret;
     }
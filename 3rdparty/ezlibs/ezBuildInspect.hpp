@@ -0,0 +1,208 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezBuildInspect is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// find the BuildInc markers compiled in a binary (BuildInc::setMarker)
+// the file is mapped, the '.buildinc' section of an elf file is read first,
+// else the whole file is scanned
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include "ezMappedFile.hpp"
+#include "ezBuildInc.hpp"
+
+namespace ez {
+
+class BuildInspect {
+public:
+    struct Marker {
+        std::vector<std::pair<std::string, std::string>> fields;  // in the marker order (Project, Label, BuildId, BuildIdNum)
+        std::string getField(const std::string& vKey) const {
+            for (const auto& field : fields) {
+                if (field.first == vKey) {
+                    return field.second;
+                }
+            }
+            return {};
+        }
+    };
+
+private:
+    std::vector<Marker> m_markers;
+    bool m_fromSection = false;
+
+public:
+    // find the markers of a binary, false if the file cant be read or no marker was found
+    bool inspect(const std::string& vFilePathName) {
+        m_markers.clear();
+        m_fromSection = false;
+        MappedFile file;
+        if (!file.open(vFilePathName, true)) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Failed to map %s", vFilePathName.c_str());
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+        size_t offset = 0;
+        size_t size = 0;
+        if (m_findElfSection(file.getData(), file.getSize(), buildinc::markerSection, offset, size)) {
+            m_scan(file.getData() + offset, size);
+            m_fromSection = !m_markers.empty();
+        }
+        if (m_markers.empty()) {  // not elf, or a marker not in its section (msvc, mach-o, ..)
+            m_scan(file.getData(), file.getSize());
+        }
+        return !m_markers.empty();
+    }
+    const std::vector<Marker>& getMarkers() const { return m_markers; }
+    // the markers was found in the '.buildinc' section, without scan of the whole file
+    bool isFromSection() const { return m_fromSection; }
+    // 'Key : Value' lines, a blank line between the markers
+    std::string getText() const {
+        std::string ret;
+        for (const auto& marker : m_markers) {
+            if (!ret.empty()) {
+                ret += '\n';
+            }
+            for (const auto& field : marker.fields) {
+                ret += field.first + " : " + field.second + "\n";
+            }
+        }
+        return ret;
+    }
+
+private:
+    // each translation unit including the header has its copy of the marker, the copies are merged
+    void m_scan(const uint8_t* vData, const size_t vSize) {
+        static constexpr size_t tagLen = sizeof(buildinc::markerTag) - 1U;
+        const uint8_t* ptr = vData;
+        const uint8_t* const end = vData + vSize;
+        while (static_cast<size_t>(end - ptr) >= tagLen) {
+            const auto* found = m_find(ptr, static_cast<size_t>(end - ptr), buildinc::markerTag, tagLen);
+            if (found == nullptr) {
+                break;
+            }
+            const auto* last = static_cast<const uint8_t*>(std::memchr(found, '\0', static_cast<size_t>(end - found)));
+            if (last == nullptr) {
+                last = end;
+            }
+            Marker marker;
+            if (m_parseMarker(reinterpret_cast<const char*>(found + tagLen), reinterpret_cast<const char*>(last), marker) &&  //
+                std::find_if(m_markers.begin(), m_markers.end(), [&marker](const Marker& vOther) { return vOther.fields == marker.fields; }) == m_markers.end()) {
+                m_markers.push_back(marker);
+            }
+            ptr = found + tagLen;
+        }
+    }
+    // memmem of the libc if any, else memchr (vectorized by the libc) then memcmp
+    static const uint8_t* m_find(const uint8_t* vData, const size_t vSize, const char* vNeedle, const size_t vNeedleLen) {
+#if defined(__GLIBC__) || defined(__APPLE__) || defined(__FreeBSD__)
+        return static_cast<const uint8_t*>(memmem(vData, vSize, vNeedle, vNeedleLen));
+#else
+        const uint8_t* ptr = vData;
+        const uint8_t* const end = vData + vSize;
+        while (static_cast<size_t>(end - ptr) >= vNeedleLen) {
+            ptr = static_cast<const uint8_t*>(std::memchr(ptr, vNeedle[0], static_cast<size_t>(end - ptr) - vNeedleLen + 1U));
+            if (ptr == nullptr) {
+                return nullptr;
+            }
+            if (std::memcmp(ptr, vNeedle, vNeedleLen) == 0) {
+                return ptr;
+            }
+            ++ptr;
+        }
+        return nullptr;
+#endif
+    }
+    // 'Key=Value\n' lines, the first must be the project
+    static bool m_parseMarker(const char* vStart, const char* vEnd, Marker& vOutMarker) {
+        const char* line = vStart;
+        while (line < vEnd) {
+            const char* eol = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(vEnd - line)));
+            if (eol == nullptr) {
+                return false;  // truncated
+            }
+            const char* eq = static_cast<const char*>(std::memchr(line, '=', static_cast<size_t>(eol - line)));
+            if (eq == nullptr || eq == line) {
+                return false;
+            }
+            vOutMarker.fields.emplace_back(std::string(line, eq), std::string(eq + 1, eol));
+            line = eol + 1;
+        }
+        return !vOutMarker.fields.empty() && vOutMarker.fields.front().first == "Project";
+    }
+    template <typename T>
+    static T m_read(const uint8_t* vData) {
+        T ret;
+        std::memcpy(&ret, vData, sizeof(T));
+        return ret;
+    }
+    // section headers of a little endian elf32 or elf64 file
+    static bool m_findElfSection(const uint8_t* vData, const size_t vSize, const char* vName, size_t& vOutOffset, size_t& vOutSize) {
+        if (vSize < 64 || std::memcmp(vData, "\x7f" "ELF", 4) != 0 || vData[5] != 1) {
+            return false;
+        }
+        const bool is64 = (vData[4] == 2);
+        const uint64_t shOff = is64 ? m_read<uint64_t>(vData + 0x28) : m_read<uint32_t>(vData + 0x20);
+        const uint16_t shEntSize = m_read<uint16_t>(vData + (is64 ? 0x3A : 0x2E));
+        const uint16_t shNum = m_read<uint16_t>(vData + (is64 ? 0x3C : 0x30));
+        const uint16_t shStrNdx = m_read<uint16_t>(vData + (is64 ? 0x3E : 0x32));
+        if (shOff == 0 || shStrNdx >= shNum || shEntSize < (is64 ? 0x40 : 0x28) || shOff > vSize || (vSize - shOff) / shEntSize < shNum) {
+            return false;
+        }
+        const auto getSection = [&](const size_t vIdx, uint32_t& vOutName, uint64_t& vOutOffset, uint64_t& vOutSize) {
+            const uint8_t* sh = vData + shOff + vIdx * shEntSize;
+            vOutName = m_read<uint32_t>(sh);
+            vOutOffset = is64 ? m_read<uint64_t>(sh + 0x18) : m_read<uint32_t>(sh + 0x10);
+            vOutSize = is64 ? m_read<uint64_t>(sh + 0x20) : m_read<uint32_t>(sh + 0x14);
+            return vOutOffset <= vSize && vOutSize <= vSize - vOutOffset;
+        };
+        uint32_t name = 0;
+        uint64_t namesOffset = 0, namesSize = 0;
+        if (!getSection(shStrNdx, name, namesOffset, namesSize)) {
+            return false;
+        }
+        const size_t nameLen = std::strlen(vName);
+        for (size_t i = 0; i < shNum; ++i) {
+            uint64_t offset = 0, size = 0;
+            if (getSection(i, name, offset, size) && name + nameLen < namesSize &&  //
+                std::memcmp(vData + namesOffset + name, vName, nameLen + 1U) == 0) {
+                vOutOffset = static_cast<size_t>(offset);
+                vOutSize = static_cast<size_t>(size);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace ez
@@ -0,0 +1,515 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezBuildLease is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+#include "ezOS.hpp"
+
+#ifdef WINDOWS_OS
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#include <io.h>
+#include <process.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include "ezLog.hpp"
+#include "ezFile.hpp"
+#include "ezFileLock.hpp"
+
+namespace ez {
+namespace lease {
+
+/* Range lease protocol (one request per connection, text lines)
+
+client -> coordinator : LEASE <project> <count> <node> <floor>
+coordinator -> client : OK <begin> <end>        // numbers in [begin, end) are owned by the node
+client -> coordinator : RELEASE <project> <node> <begin> <end>
+coordinator -> client : OK                      // the range is recorded as unused, never reissued
+
+<floor> is the highest build number already known by the node (its header),
+so a project can move under a coordinator without going back in time.
+
+Coordinator state file : one '<project> <next>' per line, rewritten and flushed on the disk before each reply
+Coordinator log file : 'LEASE|UNUSED <project> <node> <begin> <end>' appended per event
+
+Node lease file : '<project> <begin> <end> <next>', rewritten before each number is used,
+locked by the node ('<file>.lock') so the processes of a node never use the same number
+*/
+
+#ifdef WINDOWS_OS
+typedef SOCKET SocketHandle;
+static constexpr SocketHandle InvalidSocket = INVALID_SOCKET;
+#else
+typedef int SocketHandle;
+static constexpr SocketHandle InvalidSocket = -1;
+#endif
+
+namespace internal {
+
+inline bool initNetwork() {
+#ifdef WINDOWS_OS
+    static bool s_init = false;
+    if (!s_init) {
+        WSADATA wsaData;
+        s_init = (WSAStartup(MAKEWORD(2, 2), &wsaData) == 0);
+    }
+    return s_init;
+#else
+    return true;
+#endif
+}
+
+inline void closeSocket(SocketHandle vSocket) {
+    if (vSocket != InvalidSocket) {
+#ifdef WINDOWS_OS
+        closesocket(vSocket);
+#else
+        close(vSocket);
+#endif
+    }
+}
+
+inline bool sendAll(SocketHandle vSocket, const std::string& vData) {
+    size_t offset = 0;
+    while (offset < vData.size()) {
+        const auto ret = send(vSocket, vData.data() + offset, static_cast<int>(vData.size() - offset), 0);
+        if (ret <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(ret);
+    }
+    return true;
+}
+
+// read until '\n', the '\n' is not returned
+inline bool recvLine(SocketHandle vSocket, std::string& vOutLine) {
+    static constexpr size_t maxLineSize = 1024U;
+    vOutLine.clear();
+    char c = 0;
+    while (vOutLine.size() < maxLineSize) {
+        const auto ret = recv(vSocket, &c, 1, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        if (c == '\n') {
+            return true;
+        }
+        if (c != '\r') {
+            vOutLine += c;
+        }
+    }
+    return false;
+}
+
+// split 'host:port' or 'port'
+inline bool splitAddress(const std::string& vAddress, std::string& vOutHost, std::string& vOutPort) {
+    const auto pos = vAddress.find_last_of(':');
+    if (pos == std::string::npos) {
+        vOutHost.clear();
+        vOutPort = vAddress;
+    } else {
+        vOutHost = vAddress.substr(0, pos);
+        vOutPort = vAddress.substr(pos + 1);
+    }
+    return !vOutPort.empty();
+}
+
+// the sockets are not inherited by the processes started meanwhile (they would keep the port busy)
+inline void setCloseOnExec(SocketHandle vSocket) {
+#ifdef WINDOWS_OS
+    SetHandleInformation(reinterpret_cast<HANDLE>(vSocket), HANDLE_FLAG_INHERIT, 0);
+#else
+    fcntl(vSocket, F_SETFD, fcntl(vSocket, F_GETFD) | FD_CLOEXEC);
+#endif
+}
+
+// the socket give up a read or a write after this delay, so a silent peer can't block the other side
+inline void setTimeout(SocketHandle vSocket, const int32_t vTimeoutMs) {
+#ifdef WINDOWS_OS
+    const DWORD timeout = static_cast<DWORD>(vTimeoutMs);
+#else
+    timeval timeout{};
+    timeout.tv_sec = vTimeoutMs / 1000;
+    timeout.tv_usec = (vTimeoutMs % 1000) * 1000;
+#endif
+    setsockopt(vSocket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+    setsockopt(vSocket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+inline bool isValidToken(const std::string& vToken) {
+    return !vToken.empty() && vToken.find_first_of(" \t\r\n") == std::string::npos;
+}
+
+}  // namespace internal
+
+inline std::string getHostName() {
+    char buffer[256] = {};
+    if (internal::initNetwork() && gethostname(buffer, sizeof(buffer) - 1) == 0 && internal::isValidToken(buffer)) {
+        return buffer;
+    }
+    return "node";
+}
+
+class Coordinator {
+private:
+    std::mutex m_mutex;  // one thread per client, they share the state
+    std::string m_stateFile;
+    std::string m_logFile;
+    std::map<std::string, int64_t> m_nextNumbers;  // project, next number to lease
+    SocketHandle m_socket = InvalidSocket;
+    std::atomic<bool> m_running{false};
+    std::atomic<int32_t> m_clients{0};  // clients in service
+    int64_t m_maxLeaseSize = 1000000;
+    int32_t m_timeoutMs = 5000;  // a client silent this long is dropped
+
+public:
+    Coordinator(const std::string& vStateFile) : m_stateFile(vStateFile), m_logFile(vStateFile + ".log") { m_loadState(); }
+    ~Coordinator() { internal::closeSocket(m_socket); }
+    Coordinator& setMaxLeaseSize(const int64_t vMaxLeaseSize) {
+        m_maxLeaseSize = vMaxLeaseSize;
+        return *this;
+    }
+    Coordinator& setTimeout(const int32_t vTimeoutMs) {
+        m_timeoutMs = vTimeoutMs;
+        return *this;
+    }
+    // the port listened, the one given by the system for the port 0
+    int32_t getPort() const {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        if (m_socket == InvalidSocket || getsockname(m_socket, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            return 0;
+        }
+        return ntohs(addr.sin_port);
+    }
+    // vAddress can be 'port' or 'host:port'
+    bool listen(const std::string& vAddress) {
+        std::string host, port;
+        if (!internal::initNetwork() || !internal::splitAddress(vAddress, host, port)) {
+            return false;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res) != 0 || res == nullptr) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Failed to resolve %s", vAddress.c_str());
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+        m_socket = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (m_socket != InvalidSocket) {
+            internal::setCloseOnExec(m_socket);
+            int reuse = 1;
+            setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+            if (bind(m_socket, res->ai_addr, static_cast<int>(res->ai_addrlen)) != 0 || ::listen(m_socket, SOMAXCONN) != 0) {
+                internal::closeSocket(m_socket);
+                m_socket = InvalidSocket;
+            }
+        }
+        freeaddrinfo(res);
+        if (m_socket == InvalidSocket) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Failed to listen on %s", vAddress.c_str());
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+        m_running = true;  // here, so a stop() before run() is not lost
+        return true;
+    }
+    // serve requests until stop(), one request per connection.
+    // each client is served by its own thread with a timeout, so a slow or silent client never block the others
+    bool run() {
+        if (m_socket == InvalidSocket) {
+            return false;
+        }
+        while (m_running) {
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(m_socket, &fds);
+            timeval timeout{0, 100000};  // stop() is checked each 100ms
+            if (select(static_cast<int>(m_socket) + 1, &fds, nullptr, nullptr, &timeout) <= 0) {
+                continue;
+            }
+            const SocketHandle client = accept(m_socket, nullptr, nullptr);
+            if (client == InvalidSocket) {
+                continue;
+            }
+            internal::setCloseOnExec(client);
+            internal::setTimeout(client, m_timeoutMs);
+            ++m_clients;
+            std::thread([this, client]() {
+                std::string request;
+                if (internal::recvLine(client, request)) {
+                    internal::sendAll(client, handleRequest(request) + "\n");
+                }
+                internal::closeSocket(client);
+                --m_clients;
+            }).detach();
+        }
+        while (m_clients > 0) {  // the threads use this
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+    // can be called from another thread, run() returns once the clients in service are served
+    void stop() { m_running = false; }
+    // process one protocol line and return the reply line
+    std::string handleRequest(const std::string& vRequest) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::istringstream iss(vRequest);
+        std::string cmd, project, node;
+        iss >> cmd;
+        if (cmd == "LEASE") {
+            int64_t count = 0, floor = 0;
+            if (iss >> project >> count >> node >> floor && internal::isValidToken(project) && count > 0 && count <= m_maxLeaseSize) {
+                auto& next = m_nextNumbers[project];
+                if (next <= floor) {
+                    next = floor + 1;
+                }
+                const int64_t begin = next;
+                const int64_t end = begin + count;
+                next = end;
+                // the range must be persisted before we give it, else a restart could give it again
+                if (m_saveState()) {
+                    m_log("LEASE", project, node, begin, end);
+                    return "OK " + std::to_string(begin) + " " + std::to_string(end);
+                }
+                next = begin;
+                return "ERR state";
+            }
+        } else if (cmd == "RELEASE") {
+            int64_t begin = 0, end = 0;
+            if (iss >> project >> node >> begin >> end && begin < end) {
+                // the numbers are never given again, we just keep a trace of the hole
+                m_log("UNUSED", project, node, begin, end);
+                return "OK";
+            }
+        }
+        return "ERR request";
+    }
+
+private:
+    void m_loadState() {
+        std::ifstream file(m_stateFile, std::ios::in);
+        std::string project;
+        int64_t next = 0;
+        while (file >> project >> next) {
+            m_nextNumbers[project] = next;
+        }
+    }
+    bool m_saveState() {
+        std::stringstream ss;
+        for (const auto& it : m_nextNumbers) {
+            ss << it.first << " " << it.second << "\n";
+        }
+        return ez::file::replace(m_stateFile, ss.str(), true);
+    }
+    void m_log(const char* vEvent, const std::string& vProject, const std::string& vNode, int64_t vBegin, int64_t vEnd) {
+        std::ofstream file(m_logFile, std::ios::out | std::ios::app);
+        file << vEvent << " " << vProject << " " << vNode << " " << vBegin << " " << vEnd << "\n";
+    }
+};
+
+class Node {
+private:
+    FileLock m_lock;  // on the lease file, for the life of the node
+    std::string m_coordinator;  // host:port
+    std::string m_leaseFile;
+    std::string m_nodeName;
+    std::string m_project;
+    int64_t m_begin = 0;
+    int64_t m_end = 0;
+    int64_t m_next = 0;
+    int32_t m_timeoutMs = 10000;
+    bool m_sync = false;
+
+public:
+    // lock the lease file until the destruction, then read it
+    Node(const std::string& vCoordinator, const std::string& vLeaseFile, const std::string& vNodeName)
+        : m_coordinator(vCoordinator), m_leaseFile(vLeaseFile), m_nodeName(vNodeName) {
+        if (!internal::isValidToken(m_nodeName)) {
+            m_nodeName = "node";
+        }
+        if (!m_lock.lock(m_leaseFile)) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Failed to lock %s", m_leaseFile.c_str());
+#endif  // EZ_TOOLS_LOG
+            return;
+        }
+        m_loadLease();
+    }
+    bool isLocked() const { return m_lock.isLocked(); }
+    // flush the lease file on the disk before a number is used
+    Node& setSync(const bool vFlag) {
+        m_sync = vFlag;
+        return *this;
+    }
+    Node& setTimeout(const int32_t vTimeoutMs) {
+        m_timeoutMs = vTimeoutMs;
+        return *this;
+    }
+    // give a new number for the project, above vFloor.
+    // the network is only used when the local lease is exhausted
+    bool allocate(const std::string& vProject, const int64_t vLeaseSize, const int64_t vFloor, int64_t& vOutNumber) {
+        if (!isLocked() || !internal::isValidToken(vProject) || vLeaseSize <= 0) {
+            return false;
+        }
+        if (m_project == vProject && m_next <= vFloor) {
+            m_next = std::min(vFloor + 1, m_end);  // the numbers passed by the header are skipped
+        }
+        if (m_project != vProject || m_next >= m_end) {
+            if (!m_requestLease(vProject, vLeaseSize, vFloor)) {
+                return false;
+            }
+        }
+        vOutNumber = m_next++;
+        // the lease is saved before the number is used, so a crash can only make a hole
+        if (!m_saveLease()) {
+            --m_next;
+            return false;
+        }
+        return true;
+    }
+    // give back the unused part of the lease to the coordinator
+    bool release() {
+        if (!isLocked()) {
+            return false;
+        }
+        if (m_project.empty() || m_next >= m_end) {
+            return true;
+        }
+        std::string reply;
+        const auto request = "RELEASE " + m_project + " " + m_nodeName + " " + std::to_string(m_next) + " " + std::to_string(m_end);
+        if (m_exchange(request, reply) && reply == "OK") {
+            m_end = m_next;
+            return m_saveLease();
+        }
+        return false;
+    }
+    int64_t getRemaining() const { return m_end - m_next; }
+
+private:
+    bool m_requestLease(const std::string& vProject, const int64_t vLeaseSize, const int64_t vFloor) {
+        // the rest of a lease of another project is recorded before to be forgotten
+        if (!m_project.empty() && m_project != vProject) {
+            release();
+        }
+        std::string reply;
+        const auto request = "LEASE " + vProject + " " + std::to_string(vLeaseSize) + " " + m_nodeName + " " + std::to_string(vFloor);
+        if (m_exchange(request, reply)) {
+            std::istringstream iss(reply);
+            std::string status;
+            int64_t begin = 0, end = 0;
+            if (iss >> status >> begin >> end && status == "OK" && begin < end) {
+                m_project = vProject;
+                m_begin = begin;
+                m_end = end;
+                m_next = begin;
+                return true;
+            }
+        }
+#ifdef EZ_TOOLS_LOG
+        LogVarError("Failed to get a lease from %s", m_coordinator.c_str());
+#endif  // EZ_TOOLS_LOG
+        return false;
+    }
+    bool m_exchange(const std::string& vRequest, std::string& vOutReply) {
+        std::string host, port;
+        if (!internal::initNetwork() || !internal::splitAddress(m_coordinator, host, port)) {
+            return false;
+        }
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host.empty() ? "127.0.0.1" : host.c_str(), port.c_str(), &hints, &res) != 0 || res == nullptr) {
+            return false;
+        }
+        bool ret = false;
+        const SocketHandle sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+        if (sock != InvalidSocket) {
+            internal::setCloseOnExec(sock);
+            internal::setTimeout(sock, m_timeoutMs);
+            if (connect(sock, res->ai_addr, static_cast<int>(res->ai_addrlen)) == 0) {
+                ret = internal::sendAll(sock, vRequest + "\n") && internal::recvLine(sock, vOutReply);
+            }
+            internal::closeSocket(sock);
+        }
+        freeaddrinfo(res);
+        return ret;
+    }
+    void m_loadLease() {
+        std::ifstream file(m_leaseFile, std::ios::in);
+        std::string project;
+        int64_t begin = 0, end = 0, next = 0;
+        if (file >> project >> begin >> end >> next && begin <= next && next <= end) {
+            m_project = project;
+            m_begin = begin;
+            m_end = end;
+            m_next = next;
+        }
+    }
+    bool m_saveLease() {
+        std::stringstream ss;
+        ss << m_project << " " << m_begin << " " << m_end << " " << m_next << "\n";
+        return ez::file::replace(m_leaseFile, ss.str(), m_sync);
+    }
+};
+
+}  // namespace lease
+}  // namespace ez
@@ -0,0 +1,405 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezBuildScan is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// find and parse in parallel all the BuildInc headers of a directory tree
+
+#include "ezOS.hpp"
+
+#ifdef LINUX_OS
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#else
+#include <filesystem>
+#endif
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+#include "ezBatchIO.hpp"
+#include "ezThreadPool.hpp"
+#include "ezBuildInc.hpp"
+
+namespace ez {
+
+class BuildScan {
+public:
+    struct Entry {
+        std::string filePathName;
+        std::string project;
+        std::string label;
+        int32_t majorNumber = 0;
+        int32_t minorNumber = 0;
+        int64_t buildNumber = 0;
+        std::string buildId;
+    };
+    enum class Bump { None = 0, Major, Minor, Build };
+
+private:
+    static constexpr size_t bumpChunkSize = 256U;  // files locked and updated at once by bump
+    std::vector<Entry> m_entries;
+    size_t m_threadCount = 0;  // 0 : all the cores
+    size_t m_filesCount = 0;  // files seen during the walk
+    size_t m_writtenCount = 0;  // files rewritten by the last bump
+    bool m_useIoUring = true;
+    bool m_usedIoUring = false;
+    std::string m_labelCacheDir;  // the figfont labels of the bump, empty if disabled
+    uint64_t m_labelCacheMaxSize = 0;
+    struct WorkerState {
+        std::vector<Entry> entries;
+        std::string content;  // reused between the files
+        size_t filesCount = 0;
+    };
+
+public:
+    BuildScan& setThreadCount(const size_t vThreadCount) {
+        m_threadCount = vThreadCount;
+        return *this;
+    }
+    // walk the tree and parse every BuildInc header found.
+    // each directory and each header file is a task of the work stealing pool
+    BuildScan& scan(const std::string& vRoot) {
+        m_entries.clear();
+        m_filesCount = 0;
+        ThreadPool pool(m_threadCount);
+        std::vector<WorkerState> states(pool.getThreadCount());
+        std::function<void(const std::string&)> visitDir = [&pool, &states, &visitDir](const std::string& vDir) {
+            auto& state = states[static_cast<size_t>(ThreadPool::getWorkerIndex())];
+            std::vector<std::string> dirs, files;
+            m_listDirectory(vDir, dirs, files);
+            state.filesCount += files.size();
+            for (auto& dir : dirs) {
+                pool.submit([&visitDir, dir]() { visitDir(dir); });
+            }
+            for (auto& file : files) {
+                pool.submit([&states, file]() {
+                    auto& fileState = states[static_cast<size_t>(ThreadPool::getWorkerIndex())];
+                    m_parseFile(file, fileState.content, fileState.entries);
+                });
+            }
+        };
+        pool.submit([&visitDir, vRoot]() { visitDir(vRoot); });
+        pool.wait();
+        for (auto& state : states) {
+            m_filesCount += state.filesCount;
+            for (auto& entry : state.entries) {
+                m_entries.push_back(std::move(entry));
+            }
+        }
+        // the projects of a file stay in the file order
+        std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return a.filePathName < b.filePathName; });
+        return *this;
+    }
+    const std::vector<Entry>& getEntries() const { return m_entries; }
+    size_t getFilesCount() const { return m_filesCount; }
+    BuildScan& setUseIoUring(const bool vFlag) {
+        m_useIoUring = vFlag;
+        return *this;
+    }
+    // the figfont labels rendered by bump are kept in this directory, see BuildInc::setLabelCache
+    BuildScan& setLabelCache(const std::string& vDir, const uint64_t vMaxSize = 0) {
+        m_labelCacheDir = vDir;
+        m_labelCacheMaxSize = vMaxSize;
+        return *this;
+    }
+    // change the version of all the projects of the files found and rewrite the files.
+    // the files are locked like BuildInc does, by chunks : each chunk is read in one batch, updated in parallel,
+    // then its changed files are written in one batch. the figfont label is only kept if a figfont file is given
+    bool bump(const Bump vBump, const std::string& vFigFontFile = {}) {
+        bool ret = true;
+        std::vector<std::string> files;  // one per file, the entries are sorted by file
+        for (const auto& entry : m_entries) {
+            if (files.empty() || files.back() != entry.filePathName) {
+                files.push_back(entry.filePathName);
+            }
+        }
+        std::vector<std::vector<Entry>> fileEntries(files.size());
+        BatchIO io(m_useIoUring);
+        ThreadPool pool(m_threadCount);
+        m_writtenCount = 0;
+        m_usedIoUring = false;
+        for (size_t first = 0; first < files.size(); first += bumpChunkSize) {
+            const size_t count = (std::min)(static_cast<size_t>(bumpChunkSize), files.size() - first);
+            const std::vector<std::string> chunk(files.begin() + first, files.begin() + first + count);
+            std::vector<std::unique_ptr<FileLock>> locks;  // in the path order, as every bump
+            for (const auto& file : chunk) {
+                locks.emplace_back(new FileLock());
+                if (!locks.back()->lock(file)) {
+                    ret = false;
+                }
+            }
+            std::vector<std::string> contents, rendered(count);
+            std::vector<bool> status;
+            std::vector<uint8_t> changed(count, 0);
+            auto updateFile = [&](const size_t i) {
+                MultiBuildInc multi(chunk[i], contents[i]);
+                for (const auto& project : multi.getProjects()) {
+                    auto& builder = multi.getProject(project);
+                    switch (vBump) {
+                        case Bump::Major: builder.setMajor(builder.getMajor() + 1).setMinor(0); break;
+                        case Bump::Minor: builder.setMinor(builder.getMinor() + 1); break;
+                        case Bump::Build: builder.incBuildNumber(); break;
+                        default: break;
+                    }
+#ifdef EZ_FIG_FONT
+                    if (!vFigFontFile.empty()) {
+                        builder.setLabelCache(m_labelCacheDir, m_labelCacheMaxSize).setFigFontFile(vFigFontFile);
+                    }
+#else
+                    (void)vFigFontFile;
+#endif  // EZ_FIG_FONT
+                    Entry entry;
+                    m_fillEntry(builder, entry);
+                    entry.filePathName = chunk[i];
+                    fileEntries[first + i].push_back(std::move(entry));
+                }
+                multi.render(rendered[i]);
+                changed[i] = (rendered[i] != contents[i]) ? 1 : 0;
+            };
+            // each file is updated by the pool as soon as its read completes, the others are still read meanwhile.
+            // the cost per file is uneven (a figfont to load or not), so one task per file
+            io.readFiles(chunk, contents, status, [&](const size_t i, const bool vOk) {
+                if (vOk && locks[i]->isLocked()) {
+                    pool.submit([&updateFile, i]() { updateFile(i); });
+                }
+            });
+            pool.wait();
+            std::vector<std::string> filesToWrite;
+            std::vector<const std::string*> contentsToWrite;
+            for (size_t i = 0; i < count; ++i) {
+                if (!status[i] || !locks[i]->isLocked()) {
+                    ret = false;
+                } else if (changed[i] != 0) {
+                    filesToWrite.push_back(chunk[i]);
+                    contentsToWrite.push_back(&rendered[i]);
+                }
+            }
+            io.writeFiles(filesToWrite, contentsToWrite, status);
+            for (const auto st : status) {
+                ret &= st;
+            }
+            m_writtenCount += filesToWrite.size();
+            m_usedIoUring |= io.isIoUringUsed();
+        }
+        // the entries of the files not bumped are kept
+        std::vector<Entry> entries;
+        size_t entryIdx = 0;
+        for (size_t i = 0; i < files.size(); ++i) {
+            const size_t begin = entryIdx;
+            while (entryIdx < m_entries.size() && m_entries[entryIdx].filePathName == files[i]) {
+                ++entryIdx;
+            }
+            if (fileEntries[i].empty()) {
+                entries.insert(entries.end(), std::make_move_iterator(m_entries.begin() + begin), std::make_move_iterator(m_entries.begin() + entryIdx));
+            } else {
+                entries.insert(entries.end(), std::make_move_iterator(fileEntries[i].begin()), std::make_move_iterator(fileEntries[i].end()));
+            }
+        }
+        m_entries = std::move(entries);
+        return ret;
+    }
+    size_t getWrittenCount() const { return m_writtenCount; }
+    bool isIoUringUsed() const { return m_usedIoUring; }
+    std::string getTable() const {
+        size_t cols[4] = {7, 5, 7, 4};  // 'Project', 'Label', 'BuildId', 'File'
+        for (const auto& entry : m_entries) {
+            cols[0] = std::max(cols[0], entry.project.size());
+            cols[1] = std::max(cols[1], entry.label.size());
+            cols[2] = std::max(cols[2], entry.buildId.size());
+        }
+        std::string ret;
+        m_addRow(ret, cols, "Project", "Label", "BuildId", "File");
+        for (const auto& entry : m_entries) {
+            m_addRow(ret, cols, entry.project, entry.label, entry.buildId, entry.filePathName);
+        }
+        return ret;
+    }
+    std::string getJson() const {
+        std::string ret = "[";
+        size_t idx = 0;
+        for (const auto& entry : m_entries) {
+            ret += (idx++ > 0) ? ",\n" : "\n";
+            ret += "    {\"File\": \"" + m_escapeJson(entry.filePathName) + "\", ";
+            ret += "\"Project\": \"" + m_escapeJson(entry.project) + "\", ";
+            ret += "\"Label\": \"" + m_escapeJson(entry.label) + "\", ";
+            ret += "\"MajorNumber\": " + std::to_string(entry.majorNumber) + ", ";
+            ret += "\"MinorNumber\": " + std::to_string(entry.minorNumber) + ", ";
+            ret += "\"BuildNumber\": " + std::to_string(entry.buildNumber) + ", ";
+            ret += "\"BuildId\": \"" + entry.buildId + "\"}";
+        }
+        ret += "\n]\n";
+        return ret;
+    }
+
+private:
+    static bool m_isHeaderFile(const char* vName, const size_t vLen) {
+        static const char* exts[] = {".h", ".hpp", ".hxx", ".hh"};
+        for (const auto* ext : exts) {
+            const size_t extLen = std::char_traits<char>::length(ext);
+            if (vLen > extLen && std::char_traits<char>::compare(vName + vLen - extLen, ext, extLen) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool m_isSkippedDir(const char* vName) {
+        return (std::strcmp(vName, ".") == 0 || std::strcmp(vName, "..") == 0 || std::strcmp(vName, ".git") == 0);
+    }
+
+#ifdef LINUX_OS
+    struct LinuxDirent64 {
+        ino64_t d_ino;
+        off64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[1];
+    };
+    // getdents64 read many entries per syscall and give the type without a stat
+    static void m_listDirectory(const std::string& vDir, std::vector<std::string>& vOutDirs, std::vector<std::string>& vOutFiles) {
+        const int fd = open(vDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        alignas(LinuxDirent64) char buffer[32768];
+        while (true) {
+            const long count = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+            if (count <= 0) {
+                break;
+            }
+            for (long offset = 0; offset < count;) {
+                const auto* ent = reinterpret_cast<const LinuxDirent64*>(buffer + offset);
+                offset += ent->d_reclen;
+                unsigned char type = ent->d_type;
+                if (type == DT_UNKNOWN) {  // some filesystems dont fill the type
+                    struct stat st;
+                    if (fstatat(fd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                        continue;
+                    }
+                    type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISREG(st.st_mode) ? DT_REG : DT_LNK);
+                }
+                if (type == DT_DIR) {
+                    if (!m_isSkippedDir(ent->d_name)) {
+                        vOutDirs.push_back(vDir + "/" + ent->d_name);
+                    }
+                } else if (type == DT_REG) {
+                    if (m_isHeaderFile(ent->d_name, std::strlen(ent->d_name))) {
+                        vOutFiles.push_back(vDir + "/" + ent->d_name);
+                    }
+                }
+            }
+        }
+        close(fd);
+    }
+#else
+    static void m_listDirectory(const std::string& vDir, std::vector<std::string>& vOutDirs, std::vector<std::string>& vOutFiles) {
+        std::error_code ec;
+        for (const auto& ent : std::filesystem::directory_iterator(vDir, ec)) {
+            const auto name = ent.path().filename().string();
+            if (ent.is_symlink(ec)) {
+                continue;
+            }
+            if (ent.is_directory(ec)) {
+                if (!m_isSkippedDir(name.c_str())) {
+                    vOutDirs.push_back(ent.path().string());
+                }
+            } else if (ent.is_regular_file(ec)) {
+                if (m_isHeaderFile(name.c_str(), name.size())) {
+                    vOutFiles.push_back(ent.path().string());
+                }
+            }
+        }
+    }
+#endif
+
+    // the defines are at the start of the file, so only the start is read for the detection
+    static bool m_parseFile(const std::string& vFilePathName, std::string& vContent, std::vector<Entry>& vOutEntries) {
+        static constexpr size_t probeSize = 4096U;
+        std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        vContent.resize(probeSize);
+        file.read(&vContent[0], probeSize);
+        vContent.resize(static_cast<size_t>(file.gcount()));
+        if (vContent.find("_BuildNumber ") == std::string::npos || vContent.find("_BuildId ") == std::string::npos) {
+            return false;
+        }
+        if (vContent.size() == probeSize) {
+            vContent.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        // one entry per project of the file
+        MultiBuildInc multi(vFilePathName, vContent);
+        const auto projects = multi.getProjects();
+        for (const auto& project : projects) {
+            Entry entry;
+            m_fillEntry(multi.getProject(project), entry);
+            entry.filePathName = vFilePathName;
+            vOutEntries.push_back(std::move(entry));
+        }
+        return !projects.empty();
+    }
+
+    static void m_fillEntry(BuildInc& vBuilder, Entry& vOutEntry) {
+        vOutEntry.project = vBuilder.getProject();
+        vOutEntry.label = vBuilder.getLabel();
+        vOutEntry.majorNumber = vBuilder.getMajor();
+        vOutEntry.minorNumber = vBuilder.getMinor();
+        vOutEntry.buildNumber = vBuilder.getBuildNumber();
+        vOutEntry.buildId = vBuilder.getBuildIdStr();
+    }
+
+    static void m_addRow(std::string& vOut, const size_t* vCols, const std::string& vProject, const std::string& vLabel, const std::string& vBuildId, const std::string& vFile) {
+        vOut += vProject + std::string(vCols[0] - vProject.size() + 2, ' ');
+        vOut += vLabel + std::string(vCols[1] - vLabel.size() + 2, ' ');
+        vOut += vBuildId + std::string(vCols[2] - vBuildId.size() + 2, ' ');
+        vOut += vFile + "\n";
+    }
+
+    static std::string m_escapeJson(const std::string& vStr) {
+        std::string ret;
+        for (const auto c : vStr) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+            }
+            ret += c;
+        }
+        return ret;
+    }
+};
+
+}  // namespace ez
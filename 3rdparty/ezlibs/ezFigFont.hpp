@@ -27,24 +27,120 @@ SOFTWARE.
 // ezFigFont is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
 
 #include <array>
+#include <cctype>
 #include <string>
 #include <vector>
+#include <utility>
+#include <cstdio>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <fstream>
 #include <iostream>
-#include <unordered_map>
+#include <algorithm>
+#include <sys/stat.h>
 
 #include "ezLog.hpp"
+#include "ezFile.hpp"
+#include "ezMappedFile.hpp"
 
 #ifndef EZ_FIG_FONT
 #define EZ_FIG_FONT
 #endif  // EZ_FIG_FONT
 
+#ifndef EZ_STATS_SPAN  // include ezStats.hpp before this include for the trace spans
+#define EZ_STATS_SPAN(category, name)
+#endif  // EZ_STATS_SPAN
+
 namespace ez {
 
+namespace figfont {
+
+// the blanks at the begin and at the end of a row, for compute the overlap of two glyphs without scan their rows
+struct RowEdges {
+    uint16_t lead;  // the row length if the row is blank
+    uint16_t trail;
+    uint16_t hardblanks;  // only the rows with hardblanks are scanned at render
+    uint16_t reserved;
+};
+static_assert(sizeof(RowEdges) == 8, "the RowEdges must not have padding");
+
+// a font compiled in the binary, same tables as a .bff
+struct Builtin {
+    const char* name;  // loaded by 'builtin:<name>'
+    int32_t height;
+    int32_t baseline;
+    int32_t maxLength;
+    int32_t oldLayout;
+    int32_t fullLayout;
+    int32_t printDirection;
+    int32_t codetagCount;
+    char hardblank;
+    uint32_t glyphCount;
+    const int32_t* codes;
+    const uint32_t* rowOffsets;
+    const RowEdges* rowEdges;
+    const char* rowData;
+};
+
+// in ezFigFontBuiltins.hpp, nullptr if the name is unknown
+inline const Builtin* findBuiltin(const std::string& vName);
+
+}  // namespace figfont
+
+/* Binary FigFont (.bff), a compiled .flf mapped at load without parsing :
+ [BffHeader][source path, padded to 4 bytes][codes : int32 x glyphCount, in the font order]
+ [row offsets : uint32 x (glyphCount * height + 1)][row edges : RowEdges x (glyphCount * height)][row data]
+ the row r of the glyph g is rowData[rowOffsets[g * height + r], rowOffsets[g * height + r + 1]), with its hardblanks
+ the source .flf is checked at load (mtime and size, then hash) and the cache is rebuilt if it changed.
+ the numbers are in the native endianness
+*/
 class FigFont {
+public:
+    static constexpr uint32_t bffVersion = 2;  // 2 : the hardblanks and the first space of the rows are kept, the row edges
+    static constexpr uint32_t renderVersion = 1;  // to increment when a same font give another render, in the digests
+
 private:
+    struct BffHeader {
+        char magic[4];  // 'EZFF'
+        uint32_t version;
+        int32_t height;
+        int32_t baseline;
+        int32_t maxLength;
+        int32_t oldLayout;
+        int32_t fullLayout;
+        int32_t printDirection;
+        int32_t codetagCount;
+        uint32_t hardblank;
+        uint32_t glyphCount;
+        uint32_t rowDataSize;
+        uint32_t sourcePathSize;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceMtime;  // nanoseconds
+        uint64_t sourceHash;  // FNV-1a of the .flf
+    };
+    static_assert(sizeof(BffHeader) == 80, "the BffHeader must not have padding");
+    typedef figfont::RowEdges RowEdges;
+    // the layout bits of the full layout
+    enum SmushMode : int32_t {
+        SmushEqual = 1,
+        SmushLowLine = 2,
+        SmushHierarchy = 4,
+        SmushPair = 8,
+        SmushBigX = 16,
+        SmushHardblank = 32,
+        SmushKern = 64,
+        SmushSmush = 128
+    };
+    struct Source {
+        std::string path;  // the .flf
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+
 	bool m_isValid{false};
     struct Header {
         uint8_t endChar{};
@@ -55,45 +151,175 @@ private:
         int32_t oldLayout{}; // Old Layout
         int32_t commentLines{};  // Comments line count just after header line
         int32_t printDirection{};  // printing direction
-        int32_t fullLayout{};  // Full Layout
+        int32_t fullLayout{-1};  // Full Layout, -1 if not given
         int32_t codetagCount{};  // codeTagCount (optional)
         std::vector<std::string> commentBlock;
     } m_header;
-    struct Glyph {
-        std::string desc;
-        std::vector<std::string> rows;
+    // the glyphs, in the owned buffers for a .flf, in the mapping for a .bff
+    const int32_t* m_codes = nullptr;
+    const uint32_t* m_rowOffsets = nullptr;
+    const char* m_rowData = nullptr;
+    const RowEdges* m_rowEdges = nullptr;
+    uint32_t m_glyphCount = 0;
+    int32_t m_smushMode = 0;
+    std::vector<int32_t> m_ownCodes;
+    std::vector<uint32_t> m_ownRowOffsets;
+    std::vector<char> m_ownRowData;
+    std::vector<RowEdges> m_ownRowEdges;
+    static constexpr uint32_t noGlyph = UINT32_MAX;
+    static constexpr int32_t maxUnicode = 0x110000;
+    std::array<uint32_t, 256> m_dense{};  // glyph of the codes below 256
+    std::vector<uint16_t> m_pageIndex;  // code >> 8 : page in m_pages + 1, 0 if no glyph
+    std::vector<uint32_t> m_pages;  // pages of 256 glyph indexes
+    typedef std::pair<int32_t, uint32_t> CodeGlyph;
+    std::vector<CodeGlyph> m_others;  // code, glyph of the codes out of the tables, sorted by code
+    MappedFile m_mapped;
+    Source m_source;
+    // reused by the renders
+    struct LayoutGlyph {
+        uint32_t glyph;
+        uint32_t smush;  // the columns overlapping the previous glyphs
     };
-    std::unordered_map<size_t, Glyph> m_glyphs;
-	
+    std::vector<LayoutGlyph> m_layout;
+    struct RowState {
+        uint32_t len;
+        uint32_t trail;  // the row length if the row is blank
+        char last;  // the last char not blank
+    };
+    std::vector<RowState> m_rowStates;
+
 public:
     FigFont() = default;
-    FigFont(const std::string& vFilePathName) : m_isValid(m_load(vFilePathName)) {}
+    FigFont(const std::string& vFilePathName) { load(vFilePathName); }  // the members must be constructed before m_load
     ~FigFont() = default;
     bool isValid() { return m_isValid; }
+    // a .bff file is mapped, a 'builtin:<name>' use the tables of the binary, else the file is parsed as a .flf
     FigFont& load(const std::string& vFilePathName) {
         m_isValid = m_load(vFilePathName);
         return *this;
 	}
     std::string printString(const std::string& vPattern) {
-        return m_printString(vPattern);
+        std::string ret;
+        m_appendString(ret, vPattern);
+        return ret;
+    }
+    // render at the end of vOut, no allocation if vOut has the capacity
+    void appendString(std::string& vOut, const std::string& vPattern) {
+        m_appendString(vOut, vPattern);
+    }
+    // write the loaded font as a .bff, it will be rebuilt at load if the source .flf change.
+    // a .hpp or .h get the tables of the font in c++, for add it to the builtins
+    bool compile(const std::string& vFilePathName) {
+        if (!m_isValid) {
+            return false;
+        }
+        if (m_hasExtension(vFilePathName, ".hpp") || m_hasExtension(vFilePathName, ".h")) {
+            return m_writeTables(vFilePathName);
+        }
+        return m_writeBff(vFilePathName);
+    }
+    // 'builtin:<name>', a font compiled in the binary, loaded without io and without parsing
+    static bool isBuiltin(const std::string& vFilePathName) { return vFilePathName.compare(0, 8, "builtin:") == 0; }
+    // the digest of a .flf or a .bff and of the renderer, without loading the font : a same digest give a same render.
+    // a .bff give the hash of its .flf, read again only if its size or its mtime changed. vOutSourceFile is the .flf of a .bff
+    static bool getDigest(const std::string& vFilePathName, uint64_t& vOutDigest, std::string& vOutSourceFile) {
+        vOutSourceFile.clear();
+        uint64_t hash = 0;
+        if (isBuiltin(vFilePathName) || !(m_isBffFile(vFilePathName) ? m_getBffHash(vFilePathName, hash, vOutSourceFile) : m_getFileHash(vFilePathName, hash))) {
+            return false;
+        }
+        const uint32_t version = renderVersion;
+        vOutDigest = m_getHash(&version, sizeof(version), hash);
+        return true;
     }
+    // the .flf of the font, the file loaded or the source of the .bff
+    const std::string& getSourceFile() { return m_source.path; }
+    bool isMapped() { return m_mapped.getData() != nullptr; }
 	
 private:
+    static bool m_hasExtension(const std::string& vFilePathName, const std::string& vExt) {
+        return vFilePathName.size() > vExt.size() && vFilePathName.compare(vFilePathName.size() - vExt.size(), vExt.size(), vExt) == 0;
+    }
+    static bool m_isBffFile(const std::string& vFilePathName) { return m_hasExtension(vFilePathName, ".bff"); }
+
 	bool m_load(const std::string& vFilePathName) {
+        EZ_STATS_SPAN("FigFont", "load");
+        m_reset();
         if (vFilePathName.empty()) {
             return false;
         }
-        std::ifstream file(vFilePathName);
-        if (!file.is_open()) {
+        if (isBuiltin(vFilePathName)) {
+            return m_loadBuiltin(vFilePathName.substr(8));
+        }
+        if (m_isBffFile(vFilePathName)) {
+            return m_loadBff(vFilePathName);
+        }
+        return m_loadFlf(vFilePathName);
+    }
+
+    // the tables are used in place, like a mapped .bff
+    bool m_loadBuiltin(const std::string& vName) {
+        const auto* font = figfont::findBuiltin(vName);
+        if (font == nullptr) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("No builtin FigFont named %s", vName.c_str());
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+        m_header.height = font->height;
+        m_header.baseline = font->baseline;
+        m_header.maxLength = font->maxLength;
+        m_header.oldLayout = font->oldLayout;
+        m_header.fullLayout = font->fullLayout;
+        m_header.printDirection = font->printDirection;
+        m_header.codetagCount = font->codetagCount;
+        m_header.hardblank = static_cast<uint8_t>(font->hardblank);
+        m_header.commentBlock.clear();
+        m_codes = font->codes;
+        m_rowOffsets = font->rowOffsets;
+        m_rowEdges = font->rowEdges;
+        m_rowData = font->rowData;
+        m_glyphCount = font->glyphCount;
+        m_buildIndex();
+        return true;
+    }
+
+    bool m_loadFlf(const std::string& vFilePathName) {
+        std::string content;
+        if (!m_readFile(vFilePathName, content)) {
 #ifdef EZ_TOOLS_LOG
             LogVarError("Failed to open the file %s", vFilePathName.c_str());
 #endif // EZ_TOOLS_LOG
             return false;
         }
+        m_source.path = vFilePathName;
+        m_getFileInfos(vFilePathName, m_source.size, m_source.mtime);
+        m_source.hash = m_getHash(content);
+        return m_parseFlf(content);
+    }
+
+    void m_reset() {
+        m_mapped.close();
+        m_codes = nullptr;
+        m_rowOffsets = nullptr;
+        m_rowData = nullptr;
+        m_rowEdges = nullptr;
+        m_glyphCount = 0;
+        m_smushMode = 0;
+        m_ownCodes.clear();
+        m_ownRowOffsets.clear();
+        m_ownRowData.clear();
+        m_ownRowEdges.clear();
+        m_buildIndex();  // no glyph, so no stale index after a failed load
+        m_source = Source();
+    }
 
-        std::string header;
-        std::getline(file, header);
-        std::istringstream headerStream(header);
+    bool m_parseFlf(const std::string& vContent) {
+        size_t pos = 0;  // the lines are read in place
+        const char* line = nullptr;
+        size_t lineLen = 0;
+        m_nextLine(vContent, pos, line, lineLen);
+        std::istringstream headerStream(std::string(line, lineLen));
         std::string magicNumber;
         headerStream >> magicNumber;
         if (magicNumber.substr(0, 5) != "flf2a") {
@@ -114,114 +340,745 @@ private:
           Max_Length      Old_Layout*
         */
         m_header.hardblank = magicNumber[5];
-        headerStream >>  //
-            m_header.height >>  //
-            m_header.baseline >>  //
-            m_header.oldLayout >>  //
-            m_header.maxLength >>  //
-            m_header.commentLines >>  //
-            m_header.printDirection >>  //
-            m_header.fullLayout >>  //
-            m_header.codetagCount;
-
-        std::string line;
+        // the last three are optional
+        std::array<int32_t, 8> params{0, 0, 0, 0, 0, 0, -1, 0};
+        for (auto& param : params) {
+            if (!(headerStream >> param)) {
+                break;
+            }
+        }
+        m_header.height = params[0];
+        m_header.baseline = params[1];
+        m_header.maxLength = params[2];
+        m_header.oldLayout = params[3];
+        m_header.commentLines = params[4];
+        m_header.printDirection = params[5];
+        m_header.fullLayout = params[6];
+        m_header.codetagCount = params[7];
+
+        m_header.commentBlock.clear();
         m_header.commentBlock.reserve(m_header.commentLines);
-        for (int i = 0; i < m_header.commentLines; ++i) {
-            std::getline(file, line);
-            m_header.commentBlock.push_back(line);
-        }
-        size_t idx = 0;
-        static constexpr size_t baseChar = 32;
-        static constexpr size_t required_chars_count = 127 - baseChar;
-        static constexpr size_t additionnal_chars_count = 7;
-        std::array<size_t, additionnal_chars_count> additionnal_chars{196, 214, 220, 228, 246, 252, 223};
-        size_t cChar = baseChar;
-        while (file) {
-            std::vector<std::string> asciiArt;
-            if (idx < required_chars_count) {
-                cChar = idx + baseChar;
-                if (!m_parseChar(file, cChar)) {
-                    // return false;
+        for (int i = 0; i < m_header.commentLines && m_nextLine(vContent, pos, line, lineLen); ++i) {
+            m_header.commentBlock.emplace_back(line, lineLen);
+        }
+        if (m_header.height <= 0) {
+            return false;
+        }
+        // the required chars, then the deutsch chars, then the code tagged chars
+        static constexpr int32_t baseChar = 32;
+        static constexpr int32_t required_chars_count = 127 - baseChar;
+        static constexpr std::array<int32_t, 7> additionnal_chars{196, 214, 220, 228, 246, 252, 223};
+        const size_t expectedGlyphs = required_chars_count + additionnal_chars.size() + static_cast<size_t>(std::max(m_header.codetagCount, 0));
+        m_ownCodes.reserve(expectedGlyphs);
+        m_ownRowOffsets.reserve(expectedGlyphs * static_cast<size_t>(m_header.height) + 1U);
+        m_ownRowData.resize(vContent.size());  // the rows are smaller than the file, shrinked at the end
+        size_t dataSize = 0;
+        for (size_t idx = 0; pos < vContent.size(); ++idx) {
+            int32_t code = 0;
+            if (idx < static_cast<size_t>(required_chars_count)) {
+                code = static_cast<int32_t>(idx) + baseChar;
+            } else if (idx - required_chars_count < additionnal_chars.size()) {
+                code = additionnal_chars[idx - required_chars_count];
+            } else if (!m_nextLine(vContent, pos, line, lineLen) || !m_parseCodeTag(line, lineLen, code)) {
+                continue;  // not a code tag line
+            }
+            m_ownCodes.push_back(code);
+            for (int32_t r = 0; r < m_header.height; ++r) {
+                m_ownRowOffsets.push_back(static_cast<uint32_t>(dataSize));
+                if (m_nextLine(vContent, pos, line, lineLen)) {
+                    dataSize = m_appendRow(line, lineLen, dataSize);
                 }
-            } else if (idx - required_chars_count < additionnal_chars_count) {
-                cChar = additionnal_chars.at(idx - required_chars_count);
-                if (!m_parseChar(file, cChar)) {
-                    // return false;
+            }
+        }
+        m_ownRowOffsets.push_back(static_cast<uint32_t>(dataSize));
+        m_ownRowData.resize(dataSize);
+        // the file size was reserved for the rows, and the codetag count of the header may be missing
+        m_ownRowData.shrink_to_fit();
+        m_ownRowOffsets.shrink_to_fit();
+        m_ownCodes.shrink_to_fit();
+        m_ownRowEdges.resize(m_ownRowOffsets.size() - 1U);
+        for (size_t row = 0; row < m_ownRowEdges.size(); ++row) {
+            const char* begin = m_ownRowData.data() + m_ownRowOffsets[row];
+            const char* end = m_ownRowData.data() + m_ownRowOffsets[row + 1U];
+            const char* first = begin;
+            while (first != end && *first == ' ') {
+                ++first;
+            }
+            const char* last = end;
+            while (last != first && *(last - 1) == ' ') {
+                --last;
+            }
+            m_ownRowEdges[row].lead = static_cast<uint16_t>(std::min<size_t>(static_cast<size_t>(first - begin), UINT16_MAX));
+            m_ownRowEdges[row].trail = static_cast<uint16_t>(std::min<size_t>(static_cast<size_t>(end - last), UINT16_MAX));
+            m_ownRowEdges[row].hardblanks = static_cast<uint16_t>(std::min<size_t>(std::count(begin, end, static_cast<char>(m_header.hardblank)), UINT16_MAX));
+            m_ownRowEdges[row].reserved = 0;
+        }
+        m_rowEdges = m_ownRowEdges.data();
+        m_codes = m_ownCodes.data();
+        m_rowOffsets = m_ownRowOffsets.data();
+        m_rowData = m_ownRowData.data();
+        m_glyphCount = static_cast<uint32_t>(m_ownCodes.size());
+        m_buildIndex();
+        return true;
+	}
+
+    // like figlet : the full layout if given, else the old layout
+    int32_t m_getSmushMode() const {
+        if (m_header.fullLayout >= 0) {
+            return m_header.fullLayout;
+        }
+        if (m_header.oldLayout == 0) {
+            return SmushKern;
+        }
+        if (m_header.oldLayout < 0) {
+            return 0;  // full width
+        }
+        return (m_header.oldLayout & 31) | SmushSmush;
+    }
+
+    // the next line without its end of line ('\n' or '\r\n'), false at the end of the content
+    static bool m_nextLine(const std::string& vContent, size_t& vInOutPos, const char*& vOutLine, size_t& vOutLen) {
+        if (vInOutPos >= vContent.size()) {
+            vOutLine = vContent.data() + vContent.size();
+            vOutLen = 0;
+            return false;
+        }
+        size_t end = vContent.find('\n', vInOutPos);
+        const size_t next = (end == std::string::npos) ? vContent.size() : end + 1U;
+        if (end == std::string::npos) {
+            end = vContent.size();
+        }
+        if (end > vInOutPos && vContent[end - 1U] == '\r') {  // a font saved with CRLF gives the same glyphs
+            --end;
+        }
+        vOutLine = vContent.data() + vInOutPos;
+        vOutLen = end - vInOutPos;
+        vInOutPos = next;
+        return true;
+    }
+
+    // 'code description', the code is decimal, octal (0...) or hexadecimal (0x...), maybe negative
+    static bool m_parseCodeTag(const char* vLine, const size_t vLen, int32_t& vOutCode) {
+        const std::string tag(vLine, std::find(vLine, vLine + vLen, ' '));
+        if (tag.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        const long long code = std::strtoll(tag.c_str(), &end, 0);
+        if (end == tag.c_str() || *end != '\0' || code < INT32_MIN || code > INT32_MAX) {
+            return false;
+        }
+        vOutCode = static_cast<int32_t>(code);
+        return true;
+    }
+
+    // the end marks are removed, the hardblanks are kept for the smushing and are spaces in the output.
+    // return the new size of the row data
+    size_t m_appendRow(const char* vLine, size_t vLen, const size_t vDataSize) {
+        while (vLen > 0 && (vLine[vLen - 1U] == ' ' || vLine[vLen - 1U] == '\t')) {
+            --vLen;
+        }
+        if (vLen > 0) {
+            const char endMark = vLine[vLen - 1U];  // '@' most of the time
+            while (vLen > 0 && vLine[vLen - 1U] == endMark) {
+                --vLen;
+            }
+        }
+        std::memcpy(m_ownRowData.data() + vDataSize, vLine, vLen);
+        return vDataSize + vLen;
+    }
+
+    // dense table for the codes below 256 (ascii and deutsch chars), two levels page table for the unicode code tags,
+    // a binary search for the others (negative codes). the glyphs stay in the font order,
+    // so a code defined twice keep the last definition
+    void m_buildIndex() {
+        m_smushMode = m_getSmushMode();
+        m_dense.fill(noGlyph);
+        m_pageIndex.clear();
+        m_pages.clear();
+        m_others.clear();
+        for (uint32_t g = 0; g < m_glyphCount; ++g) {
+            const int32_t code = m_codes[g];
+            if (code >= 0 && code < 256) {
+                m_dense[static_cast<size_t>(code)] = g;
+            } else if (code >= 256 && code < maxUnicode) {
+                const size_t page = static_cast<size_t>(code) >> 8U;
+                if (page >= m_pageIndex.size()) {
+                    m_pageIndex.resize(page + 1U, 0);
                 }
+                if (m_pageIndex[page] == 0) {
+                    m_pages.resize(m_pages.size() + 256U, noGlyph);
+                    m_pageIndex[page] = static_cast<uint16_t>(m_pages.size() / 256U);  // 0 is no page
+                }
+                m_pages[(m_pageIndex[page] - 1U) * 256U + (static_cast<size_t>(code) & 255U)] = g;
             } else {
-                if (!m_parseChar(file, 0)) {
-                    // return false;
+                m_others.emplace_back(code, g);
+            }
+        }
+        std::stable_sort(m_others.begin(), m_others.end(), [](const CodeGlyph& a, const CodeGlyph& b) { return a.first < b.first; });
+    }
+
+    uint32_t m_findGlyph(const int32_t vCode) const {
+        if (vCode >= 0 && vCode < 256) {
+            return m_dense[static_cast<size_t>(vCode)];
+        }
+        if (vCode >= 256 && vCode < maxUnicode) {
+            const size_t page = static_cast<size_t>(vCode) >> 8U;
+            if (page < m_pageIndex.size() && m_pageIndex[page] != 0) {
+                return m_pages[(m_pageIndex[page] - 1U) * 256U + (static_cast<size_t>(vCode) & 255U)];
+            }
+            return noGlyph;
+        }
+        auto it = std::upper_bound(m_others.begin(), m_others.end(), vCode, [](const int32_t c, const CodeGlyph& a) { return c < a.first; });
+        return (it != m_others.begin() && (--it)->first == vCode) ? it->second : noGlyph;
+    }
+
+    static size_t m_getPadding(const size_t vSize) { return (4U - (vSize & 3U)) & 3U; }
+
+    bool m_loadBff(const std::string& vFilePathName) {
+        if (!m_mapped.open(vFilePathName) || !m_mapBff()) {
+            const auto source = m_source.path;  // a .bff of another version is rebuilt from its source
+            m_reset();
+            if (!source.empty() && m_loadFlf(source)) {
+                m_writeBff(vFilePathName);
+                return true;
+            }
+            m_reset();
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Not a valid binary FigFont file %s", vFilePathName.c_str());
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+        if (m_source.path.empty()) {
+            return true;  // no source, the cache is the font
+        }
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        if (!m_getFileInfos(m_source.path, size, mtime)) {
+            return true;  // the source is gone, the cache is kept
+        }
+        if (size == m_source.size && mtime == m_source.mtime) {
+            return true;
+        }
+        std::string content;
+        if (!m_readFile(m_source.path, content)) {
+            return true;
+        }
+        const auto hash = m_getHash(content);
+        if (hash != m_source.hash) {  // the font changed, the cache is rebuilt
+            auto source = m_source;
+            m_reset();
+            m_source = source;
+            m_source.hash = hash;
+            if (!m_parseFlf(content)) {
+                return false;
+            }
+        }
+        m_source.size = size;
+        m_source.mtime = mtime;
+        // for the next loads, the font loaded stay valid if the write fail
+        m_writeBff(vFilePathName);
+        return true;
+    }
+
+    // check the sizes and point the glyphs on the mapping, without copy
+    bool m_mapBff() {
+        const uint8_t* data = m_mapped.getData();
+        const uint64_t size = m_mapped.getSize();
+        BffHeader header;
+        if (size < sizeof(BffHeader)) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(BffHeader));
+        if (std::memcmp(header.magic, "EZFF", 4) != 0) {
+            return false;
+        }
+        if (sizeof(BffHeader) + static_cast<uint64_t>(header.sourcePathSize) <= size) {  // the path is at the same place in all the versions
+            m_source.path.assign(reinterpret_cast<const char*>(data + sizeof(BffHeader)), header.sourcePathSize);
+        }
+        if (header.version != bffVersion || header.height <= 0) {
+            return false;
+        }
+        const uint64_t codesOffset = sizeof(BffHeader) + header.sourcePathSize + m_getPadding(header.sourcePathSize);
+        const uint64_t rowCount = static_cast<uint64_t>(header.glyphCount) * static_cast<uint64_t>(header.height) + 1U;
+        const uint64_t offsetsOffset = codesOffset + static_cast<uint64_t>(header.glyphCount) * sizeof(int32_t);
+        const uint64_t edgesOffset = offsetsOffset + rowCount * sizeof(uint32_t);
+        const uint64_t dataOffset = edgesOffset + (rowCount - 1U) * sizeof(RowEdges);
+        if (dataOffset + header.rowDataSize != size) {
+            return false;
+        }
+        const auto* offsets = reinterpret_cast<const uint32_t*>(data + offsetsOffset);
+        for (uint64_t i = 0; i < rowCount; ++i) {  // a corrupted file must not read out of the mapping
+            if (offsets[i] > header.rowDataSize || (i > 0 && offsets[i] < offsets[i - 1])) {
+                return false;
+            }
+        }
+        m_header.height = header.height;
+        m_header.baseline = header.baseline;
+        m_header.maxLength = header.maxLength;
+        m_header.oldLayout = header.oldLayout;
+        m_header.fullLayout = header.fullLayout;
+        m_header.printDirection = header.printDirection;
+        m_header.codetagCount = header.codetagCount;
+        m_header.hardblank = static_cast<uint8_t>(header.hardblank);
+        m_header.commentBlock.clear();
+        m_codes = reinterpret_cast<const int32_t*>(data + codesOffset);
+        m_rowOffsets = offsets;
+        m_rowData = reinterpret_cast<const char*>(data + dataOffset);
+        m_rowEdges = reinterpret_cast<const RowEdges*>(data + edgesOffset);
+        m_glyphCount = header.glyphCount;
+        m_buildIndex();
+        m_source.size = header.sourceSize;
+        m_source.mtime = header.sourceMtime;
+        m_source.hash = header.sourceHash;
+        return true;
+    }
+
+    // written in a temporary file then renamed, so a concurrent load never see a partial file
+    bool m_writeBff(const std::string& vFilePathName) {
+        BffHeader header{};
+        std::memcpy(header.magic, "EZFF", 4);
+        header.version = bffVersion;
+        header.height = m_header.height;
+        header.baseline = m_header.baseline;
+        header.maxLength = m_header.maxLength;
+        header.oldLayout = m_header.oldLayout;
+        header.fullLayout = m_header.fullLayout;
+        header.printDirection = m_header.printDirection;
+        header.codetagCount = m_header.codetagCount;
+        header.hardblank = m_header.hardblank;
+        header.glyphCount = m_glyphCount;
+        const size_t rowCount = static_cast<size_t>(m_glyphCount) * static_cast<size_t>(m_header.height) + 1U;
+        header.rowDataSize = m_rowOffsets[rowCount - 1U];
+        header.sourcePathSize = static_cast<uint32_t>(m_source.path.size());
+        header.sourceSize = m_source.size;
+        header.sourceMtime = m_source.mtime;
+        header.sourceHash = m_source.hash;
+        std::string content;
+        content.reserve(sizeof(BffHeader) + m_source.path.size() + 3U + m_glyphCount * sizeof(int32_t) + rowCount * sizeof(uint32_t) +
+                        (rowCount - 1U) * sizeof(RowEdges) + header.rowDataSize);
+        content.append(reinterpret_cast<const char*>(&header), sizeof(BffHeader));
+        content += m_source.path;
+        content.append(m_getPadding(m_source.path.size()), '\0');
+        content.append(reinterpret_cast<const char*>(m_codes), m_glyphCount * sizeof(int32_t));
+        content.append(reinterpret_cast<const char*>(m_rowOffsets), rowCount * sizeof(uint32_t));
+        content.append(reinterpret_cast<const char*>(m_rowEdges), (rowCount - 1U) * sizeof(RowEdges));
+        content.append(m_rowData, header.rowDataSize);
+        return ez::file::replace(vFilePathName, content);
+    }
+
+    // the builtin function to paste in ezFigFontBuiltins.hpp, named from the file : standard.hpp give getBuiltinStandard()
+    bool m_writeTables(const std::string& vFilePathName) {
+        const auto slash = vFilePathName.find_last_of("/\\");
+        std::string name = vFilePathName.substr((slash == std::string::npos) ? 0U : slash + 1U);
+        name = name.substr(0, name.find('.'));
+        if (name.empty() || m_glyphCount == 0) {  // no empty arrays in c++
+            return false;
+        }
+        std::string funcName = name;
+        funcName[0] = static_cast<char>(std::toupper(static_cast<uint8_t>(funcName[0])));
+        const size_t height = static_cast<size_t>(m_header.height);
+        const size_t rowCount = static_cast<size_t>(m_glyphCount) * height;
+        std::string content;
+        const auto sourceSlash = m_source.path.find_last_of("/\\");
+        const auto sourceName = m_source.path.substr((sourceSlash == std::string::npos) ? 0U : sourceSlash + 1U);
+        content += "// the FigFont " + name + ", generated by 'BuildInc --compile-font " + sourceName + "," + name + ".hpp'\n";
+        content += "inline const Builtin& getBuiltin" + funcName + "() {\n";
+        content += "    static const int32_t codes[] = {";
+        for (uint32_t g = 0; g < m_glyphCount; ++g) {
+            content += ((g % 16U) == 0U) ? "\n        " : " ";
+            content += std::to_string(m_codes[g]) + ",";
+        }
+        content += "\n    };\n    static const uint32_t rowOffsets[] = {";
+        for (size_t r = 0; r <= rowCount; ++r) {
+            content += ((r % 16U) == 0U) ? "\n        " : " ";
+            content += std::to_string(m_rowOffsets[r]) + ",";
+        }
+        content += "\n    };\n    static const RowEdges rowEdges[] = {";
+        for (size_t r = 0; r < rowCount; ++r) {
+            content += ((r % 8U) == 0U) ? "\n        " : " ";
+            content += "{" + std::to_string(m_rowEdges[r].lead) + ", " + std::to_string(m_rowEdges[r].trail) + ", " +  //
+                std::to_string(m_rowEdges[r].hardblanks) + ", 0},";
+        }
+        content += "\n    };\n    static const char rowData[] =";
+        for (uint32_t g = 0; g < m_glyphCount; ++g) {  // one string per glyph
+            content += "\n        \"";
+            const size_t begin = m_rowOffsets[g * height];
+            const size_t end = m_rowOffsets[(g + 1U) * height];
+            for (size_t i = begin; i < end; ++i) {
+                const auto c = static_cast<uint8_t>(m_rowData[i]);
+                if (c == '\\' || c == '"' || c == '?') {  // '?' for the trigraphs
+                    content += '\\';
+                    content += static_cast<char>(c);
+                } else if (c < 32 || c > 126) {
+                    const char octal[5] = {'\\', static_cast<char>('0' + (c >> 6U)), static_cast<char>('0' + ((c >> 3U) & 7U)), static_cast<char>('0' + (c & 7U)), '\0'};
+                    content += octal;
+                } else {
+                    content += static_cast<char>(c);
                 }
             }
-            ++idx;
+            content += ((g + 1U) < m_glyphCount) ? "\"  // " : "\";  // ";
+            content += std::to_string(m_codes[g]);
         }
+        content += "\n";
+        content += "    static const Builtin font = {\"" + name + "\", " + std::to_string(m_header.height) + ", " + std::to_string(m_header.baseline) + ", " +
+            std::to_string(m_header.maxLength) + ", " + std::to_string(m_header.oldLayout) + ", " + std::to_string(m_header.fullLayout) + ", " +
+            std::to_string(m_header.printDirection) + ", " + std::to_string(m_header.codetagCount) + ", '" +
+            ((m_header.hardblank == '\\' || m_header.hardblank == '\'') ? "\\" : "") + static_cast<char>(m_header.hardblank) + "', " +
+            std::to_string(m_glyphCount) + ", codes, rowOffsets, rowEdges, rowData};\n";
+        content += "    return font;\n}\n";
+        std::ofstream file(vFilePathName, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        return file.good();
+    }
+
+    static bool m_readFile(const std::string& vFilePathName, std::string& vOut) {
+        std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        // one read of the whole file, not a char by char copy
+        file.seekg(0, std::ios::end);
+        const auto size = file.tellg();
+        if (size < 0) {
+            return false;
+        }
+        file.seekg(0, std::ios::beg);
+        vOut.resize(static_cast<size_t>(size));
+        return vOut.empty() || file.read(&vOut[0], static_cast<std::streamsize>(vOut.size())).good();
+    }
+
+    static bool m_getFileInfos(const std::string& vFilePathName, uint64_t& vOutSize, int64_t& vOutMtime) {
+#ifdef WINDOWS_OS
+        struct _stat64 st;
+        if (_stat64(vFilePathName.c_str(), &st) != 0) {
+            return false;
+        }
+        vOutMtime = static_cast<int64_t>(st.st_mtime) * 1000000000LL;
+#else
+        struct stat st;
+        if (stat(vFilePathName.c_str(), &st) != 0) {
+            return false;
+        }
+#ifdef __APPLE__
+        vOutMtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+        vOutMtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+#endif
+        vOutSize = static_cast<uint64_t>(st.st_size);
         return true;
-	}
+    }
+
+    static uint64_t m_getHash(const void* vData, const size_t vSize, uint64_t vHash = 14695981039346656037ULL) {
+        const auto* bytes = static_cast<const uint8_t*>(vData);
+        for (size_t i = 0; i < vSize; ++i) {  // FNV-1a
+            vHash = (vHash ^ bytes[i]) * 1099511628211ULL;
+        }
+        return vHash;
+    }
+    static uint64_t m_getHash(const std::string& vContent) { return m_getHash(vContent.data(), vContent.size()); }
 
-    bool m_parseChar(std::ifstream& vFile, const size_t vChar) {
-        std::string row;
-        size_t charCode = vChar;
-        Glyph glyph;
-        if (charCode < 32) {
-            std::getline(vFile, row);
-            size_t spacePos = row.find(' ');
-            if (spacePos != std::string::npos) {
-                const auto numStr = row.substr(0, spacePos);
-                const auto descStr = row.substr(spacePos + 1);
-                charCode = static_cast<size_t>(std::stoi(numStr));
+    static bool m_getFileHash(const std::string& vFilePathName, uint64_t& vOutHash) {
+        std::string content;
+        if (!m_readFile(vFilePathName, content)) {
+            return false;
+        }
+        vOutHash = m_getHash(content);
+        return true;
+    }
+
+    // only the header and the source path are read, the hash of the .flf is the one of the .bff if it is unchanged
+    static bool m_getBffHash(const std::string& vFilePathName, uint64_t& vOutHash, std::string& vOutSourceFile) {
+        std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+        BffHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(BffHeader)) || std::memcmp(header.magic, "EZFF", 4) != 0) {
+            return false;
+        }
+        vOutSourceFile.resize(header.sourcePathSize);
+        if (header.sourcePathSize > 4096U || (!vOutSourceFile.empty() && !file.read(&vOutSourceFile[0], header.sourcePathSize))) {
+            vOutSourceFile.clear();
+            return false;
+        }
+        if (vOutSourceFile.empty()) {
+            return m_getFileHash(vFilePathName, vOutHash);  // no source, the .bff is the font
+        }
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        if (!m_getFileInfos(vOutSourceFile, size, mtime)) {
+            vOutHash = header.sourceHash;  // the source is gone, the .bff is kept
+            return header.version == bffVersion;
+        }
+        if (size == header.sourceSize && mtime == header.sourceMtime) {
+            vOutHash = header.sourceHash;
+            return true;
+        }
+        return m_getFileHash(vOutSourceFile, vOutHash);
+    }
+
+    // the glyphs are placed like figlet : each glyph overlap the previous ones of the columns allowed by the layout,
+    // found from the row edges without scan the rows. then the output is sized once and the rows are copied in place
+    void m_appendString(std::string& vOut, const std::string& vPattern) {
+        EZ_STATS_SPAN("FigFont", "printString");
+        const size_t height = static_cast<size_t>(std::max(m_header.height, 0));
+        const bool overlap = (m_smushMode & (SmushKern | SmushSmush)) != 0;
+        m_layout.clear();
+        m_rowStates.assign(overlap ? height : 0U, RowState{0, 0, ' '});
+        size_t size = height;  // the '\n'
+        uint32_t prevWidth = 0;
+        for (size_t i = 0; i < vPattern.size();) {
+            const auto glyph = m_findGlyph(m_decodeUtf8(vPattern, i));
+            if (glyph == noGlyph) {
+                continue;
+            }
+            if (overlap) {
+                const uint32_t width = m_getRowLen(glyph * height);
+                const uint32_t smush = m_getSmushAmount(glyph, width, prevWidth);
+                m_placeGlyph(glyph, smush, width, prevWidth);
+                m_layout.push_back(LayoutGlyph{glyph, smush});
+                prevWidth = width;
+            } else {  // full width, the size of all the rows of a glyph is one difference since they are contiguous
+                size += m_rowOffsets[(glyph + 1U) * height] - m_rowOffsets[glyph * height];
+                m_layout.push_back(LayoutGlyph{glyph, 0U});
+            }
+        }
+        for (const auto& state : m_rowStates) {
+            size += state.len;
+        }
+        const size_t start = vOut.size();
+        vOut.resize(start + size);
+        char* out = &vOut[0] + start;
+        char* end = out;
+        const char hardblank = static_cast<char>(m_header.hardblank);
+        for (size_t r = 0; r < height; ++r) {
+            char* row = end;
+            bool hardblanks = false;
+            prevWidth = 0;
+            for (const auto& item : m_layout) {
+                const size_t idx = item.glyph * height + r;
+                const char* src = m_rowData + m_rowOffsets[idx];
+                const uint32_t len = m_getRowLen(idx);
+                const uint32_t width = m_getRowLen(item.glyph * height);
+                const uint32_t merged = std::min(item.smush, static_cast<uint32_t>(end - row));
+                const uint32_t skip = item.smush - merged;  // blank columns of the first glyph
+                char* dst = end - merged;
+                for (uint32_t k = 0; k < merged; ++k) {
+                    dst[k] = m_mergeChars(dst[k], (skip + k < len) ? src[skip + k] : ' ', width, prevWidth);
+                }
+                if (len > item.smush) {
+                    std::memcpy(end, src + item.smush, len - item.smush);
+                    end += len - item.smush;
+                }
+                hardblanks = hardblanks || (m_rowEdges[idx].hardblanks != 0);
+                prevWidth = width;
+            }
+            if (hardblanks) {  // kept until the row is done, a hardblank is not a blank for the next glyph
+                m_replaceHardblanks(row, end, hardblank);
+            }
+            if (std::find_if(row, end, [](const char c) { return c != ' '; }) == end) {  // remove empty rows
+                end = row;
             } else {
-                return false;
+                *end++ = '\n';
             }
         }
-        glyph.rows.reserve(m_header.height);
-        for (int i = 0; i < m_header.height; ++i) {
-            std::getline(vFile, row);
-            if (!row.empty()) {
-                while (row.back() == '@') {
-                    row.pop_back();
+        vOut.resize(start + static_cast<size_t>(end - out));
+    }
+
+    // 8 chars at a time : the bytes equal to the hardblank are found without branch in a 64 bits word
+    static void m_replaceHardblanks(char* vBegin, char* vEnd, const char vHardblank) {
+        static constexpr uint64_t ones = 0x0101010101010101ULL;
+        static constexpr uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+        const uint64_t hardblanks = ones * static_cast<uint8_t>(vHardblank);
+        const uint64_t spaces = ones * static_cast<uint8_t>(' ');
+        for (; vEnd - vBegin >= 8; vBegin += 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, vBegin, 8);
+            const uint64_t x = word ^ hardblanks;  // 0 where a hardblank is
+            const uint64_t zeros = ~(((x & low7) + low7) | x | low7);  // 0x80 where x is 0
+            const uint64_t mask = (zeros >> 7U) * 0xFFU;
+            word = (word & ~mask) | (spaces & mask);
+            std::memcpy(vBegin, &word, 8);
+        }
+        for (; vBegin != vEnd; ++vBegin) {
+            if (*vBegin == vHardblank) {
+                *vBegin = ' ';
+            }
+        }
+    }
+
+    uint32_t m_getRowLen(const size_t vRowIdx) const { return m_rowOffsets[vRowIdx + 1U] - m_rowOffsets[vRowIdx]; }
+
+    // the columns the glyph can overlap, the min on the rows of : the blanks between the rows,
+    // plus one if the two chars who touch can be smushed
+    uint32_t m_getSmushAmount(const uint32_t vGlyph, const uint32_t vWidth, const uint32_t vPrevWidth) const {
+        const size_t height = m_rowStates.size();
+        uint32_t amount = vWidth;
+        for (size_t r = 0; r < height && amount > 0; ++r) {
+            const auto& state = m_rowStates[r];
+            const size_t idx = vGlyph * height + r;
+            const uint32_t lead = std::min<uint32_t>(m_rowEdges[idx].lead, m_getRowLen(idx));
+            uint32_t amt = lead + state.len;
+            if (state.trail < state.len) {
+                amt = lead + state.trail;
+                if (lead < m_getRowLen(idx) && m_smushChars(state.last, m_rowData[m_rowOffsets[idx] + lead], vWidth, vPrevWidth) != '\0') {
+                    ++amt;
                 }
-                if (row.front() == ' ') {
-                    row = row.substr(1);
+            }
+            amount = std::min(amount, amt);
+        }
+        return amount;
+    }
+
+    // the rows after the glyph is placed, the last char not blank come from the glyph or from the row
+    void m_placeGlyph(const uint32_t vGlyph, const uint32_t vSmush, const uint32_t vWidth, const uint32_t vPrevWidth) {
+        const size_t height = m_rowStates.size();
+        for (size_t r = 0; r < height; ++r) {
+            auto& state = m_rowStates[r];
+            const size_t idx = vGlyph * height + r;
+            const char* src = m_rowData + m_rowOffsets[idx];
+            const uint32_t len = m_getRowLen(idx);
+            const uint32_t merged = std::min(vSmush, state.len);
+            const uint32_t skip = vSmush - merged;
+            const uint32_t newLen = state.len + ((len > vSmush) ? len - vSmush : 0U);
+            const bool blank = (m_rowEdges[idx].lead >= len);
+            const uint32_t last = blank ? 0U : len - 1U - std::min<uint32_t>(m_rowEdges[idx].trail, len - 1U);
+            if (!blank && last >= vSmush) {
+                state.trail = len - 1U - last;
+                state.last = src[last];
+            } else {
+                int64_t col = -1;
+                char c = ' ';
+                if (!blank && last >= skip) {
+                    col = static_cast<int64_t>(state.len - merged + last - skip);
+                    c = src[last];
                 }
-                for (auto& c : row) {
-                    if (c == static_cast<char>(m_header.hardblank)) {
-                        c = ' ';
+                if (state.trail < state.len) {
+                    const int64_t prevCol = static_cast<int64_t>(state.len - 1U - state.trail);
+                    if (prevCol > col) {
+                        col = prevCol;
+                        c = state.last;
+                    } else if (prevCol == col) {
+                        c = m_mergeChars(state.last, c, vWidth, vPrevWidth);
                     }
                 }
+                state.trail = (col < 0) ? newLen : static_cast<uint32_t>(newLen - 1 - col);
+                state.last = c;
             }
-            glyph.rows.push_back(row);
+            state.len = newLen;
+        }
+    }
+
+    char m_mergeChars(const char vLeft, const char vRight, const uint32_t vWidth, const uint32_t vPrevWidth) const {
+        const char c = m_smushChars(vLeft, vRight, vWidth, vPrevWidth);
+        return (c != '\0') ? c : vRight;
+    }
+
+    static int32_t m_getHierarchyClass(const char vC) {
+        switch (vC) {
+            case '|': return 1;
+            case '/':
+            case '\\': return 2;
+            case '[':
+            case ']': return 3;
+            case '{':
+            case '}': return 4;
+            case '(':
+            case ')': return 5;
+            case '<':
+            case '>': return 6;
+            default: return 0;
         }
-        m_glyphs[charCode] = glyph;
-        return true;
     }
 
-	std::string m_printString(const std::string& vPattern) {
-        std::stringstream ret;
-        std::vector<std::string> rows;
-        rows.resize(m_header.height);
-        size_t row_idx = 0;
-        for (auto& row : rows) {
-            for (const auto c : vPattern) {
-                row += m_getCharRow(c, row_idx);
+    // the char of two overlapping chars, '\0' if they can't be smushed. the six rules of figlet
+    char m_smushChars(const char vLeft, const char vRight, const uint32_t vWidth, const uint32_t vPrevWidth) const {
+        if (vLeft == ' ') {
+            return vRight;
+        }
+        if (vRight == ' ') {
+            return vLeft;
+        }
+        if (vPrevWidth < 2 || vWidth < 2 || (m_smushMode & SmushSmush) == 0) {
+            return '\0';  // kerning only
+        }
+        const char hardblank = static_cast<char>(m_header.hardblank);
+        if ((m_smushMode & 63) == 0) {  // universal smushing, the right char win
+            return (vRight == hardblank) ? vLeft : vRight;
+        }
+        if (vLeft == hardblank || vRight == hardblank) {
+            return ((m_smushMode & SmushHardblank) != 0 && vLeft == vRight) ? vLeft : '\0';
+        }
+        if ((m_smushMode & SmushEqual) != 0 && vLeft == vRight) {
+            return vLeft;
+        }
+        const int32_t leftClass = m_getHierarchyClass(vLeft);
+        const int32_t rightClass = m_getHierarchyClass(vRight);
+        if ((m_smushMode & SmushLowLine) != 0) {
+            if (vLeft == '_' && rightClass != 0) {
+                return vRight;
             }
-            ++row_idx;
-            // remove empty rows
-            if (row.find_first_not_of(" ") != std::string::npos) {
-                ret << row << std::endl;
+            if (vRight == '_' && leftClass != 0) {
+                return vLeft;
             }
         }
-        return ret.str();
-	}
+        if ((m_smushMode & SmushHierarchy) != 0 && leftClass != 0 && rightClass != 0 && leftClass != rightClass) {
+            return (leftClass > rightClass) ? vLeft : vRight;
+        }
+        if ((m_smushMode & SmushPair) != 0 && leftClass >= 3 && leftClass <= 5 && leftClass == rightClass && vLeft != vRight) {
+            return '|';
+        }
+        if ((m_smushMode & SmushBigX) != 0) {
+            if (vLeft == '/' && vRight == '\\') {
+                return '|';
+            }
+            if (vLeft == '\\' && vRight == '/') {
+                return 'Y';
+            }
+            if (vLeft == '>' && vRight == '<') {
+                return 'X';
+            }
+        }
+        return '\0';
+    }
 
-    std::string m_getCharRow(size_t vC, size_t vRowIdx) {
-        auto it = m_glyphs.find(vC);
-        if (it != m_glyphs.end()) {
-            if (vRowIdx < it->second.rows.size()) {
-                return it->second.rows.at(vRowIdx);
+    // the code point of the utf8 char at vInOutPos, a byte not valid in utf8 is taken as latin1
+    static int32_t m_decodeUtf8(const std::string& vStr, size_t& vInOutPos) {
+        const auto c = static_cast<uint8_t>(vStr[vInOutPos]);
+        size_t count = 0;
+        int32_t code = c;
+        if (c >= 0xF0 && c < 0xF5) {
+            count = 3;
+            code = c & 0x07;
+        } else if (c >= 0xE0) {
+            count = (c < 0xF0) ? 2 : 0;
+            code = c & 0x0F;
+        } else if (c >= 0xC2) {
+            count = 1;
+            code = c & 0x1F;
+        }
+        if (count == 0 || vInOutPos + count >= vStr.size()) {  // not a lead byte or truncated
+            ++vInOutPos;
+            return c;
+        }
+        for (size_t i = 1; i <= count; ++i) {
+            const auto next = static_cast<uint8_t>(vStr[vInOutPos + i]);
+            if ((next & 0xC0) != 0x80) {
+                ++vInOutPos;
+                return c;
             }
-        } 
-        return {};
+            code = (code << 6) | (next & 0x3F);
+        }
+        vInOutPos += count + 1U;
+        return code;
     }
 };
 
 }
+
+#ifndef EZ_FIG_FONT_NO_BUILTINS
+#include "ezFigFontBuiltins.hpp"
+#else
+inline const ez::figfont::Builtin* ez::figfont::findBuiltin(const std::string&) {
+    return nullptr;
+}
+#endif  // EZ_FIG_FONT_NO_BUILTINS
@@ -0,0 +1,427 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezFigFontBuiltins is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// the FigFonts compiled in the binary, loaded by 'builtin:<name>'.
+// included by ezFigFont.hpp, define EZ_FIG_FONT_NO_BUILTINS before it for not embed them.
+// a font is added by paste the function written by 'BuildInc --compile-font <font>.flf,<name>.hpp'
+
+namespace ez {
+namespace figfont {
+
+// the FigFont standard, generated by 'BuildInc --compile-font standard.flf,standard.hpp'
+inline const Builtin& getBuiltinStandard() {
+    static const int32_t codes[] = {
+        32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+        48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+        64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+        80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+        96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111,
+        112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 196,
+        214, 220, 228, 246, 252, 223,
+    };
+    static const uint32_t rowOffsets[] = {
+        0, 2, 4, 6, 8, 10, 12, 16, 20, 24, 28, 32, 36, 42, 48, 54,
+        60, 66, 72, 83, 94, 105, 116, 127, 138, 144, 150, 156, 162, 168, 174, 181,
+        188, 195, 202, 209, 216, 225, 234, 243, 252, 261, 270, 274, 278, 282, 286, 290,
+        294, 299, 304, 309, 314, 319, 324, 329, 334, 339, 344, 349, 354, 361, 368, 375,
+        382, 389, 396, 404, 412, 420, 428, 436, 444, 448, 452, 456, 460, 464, 468, 476,
+        484, 492, 500, 508, 516, 520, 524, 528, 532, 536, 540, 547, 554, 561, 568, 575,
+        582, 590, 598, 606, 614, 622, 630, 634, 638, 642, 646, 650, 654, 662, 670, 678,
+        686, 694, 702, 710, 718, 726, 734, 742, 750, 759, 768, 777, 786, 795, 804, 812,
+        820, 828, 836, 844, 852, 860, 868, 876, 884, 892, 900, 908, 916, 924, 932, 940,
+        948, 956, 964, 972, 980, 988, 996, 1004, 1012, 1020, 1028, 1036, 1044, 1048, 1052, 1056,
+        1060, 1064, 1068, 1072, 1076, 1080, 1084, 1088, 1092, 1097, 1102, 1107, 1112, 1117, 1122, 1130,
+        1138, 1146, 1154, 1162, 1170, 1175, 1180, 1185, 1190, 1195, 1200, 1206, 1212, 1218, 1224, 1230,
+        1236, 1246, 1256, 1266, 1276, 1286, 1296, 1306, 1316, 1326, 1336, 1346, 1356, 1364, 1372, 1380,
+        1388, 1396, 1404, 1412, 1420, 1428, 1436, 1444, 1452, 1460, 1468, 1476, 1484, 1492, 1500, 1508,
+        1516, 1524, 1532, 1540, 1548, 1556, 1564, 1572, 1580, 1588, 1596, 1604, 1612, 1620, 1628, 1636,
+        1644, 1652, 1660, 1668, 1676, 1684, 1692, 1698, 1704, 1710, 1716, 1722, 1728, 1736, 1744, 1752,
+        1760, 1768, 1776, 1783, 1790, 1797, 1804, 1811, 1818, 1826, 1834, 1842, 1850, 1858, 1866, 1875,
+        1884, 1893, 1902, 1911, 1920, 1928, 1936, 1944, 1952, 1960, 1968, 1976, 1984, 1992, 2000, 2008,
+        2016, 2024, 2032, 2040, 2048, 2056, 2064, 2072, 2080, 2088, 2096, 2104, 2112, 2120, 2128, 2136,
+        2144, 2152, 2160, 2168, 2176, 2184, 2192, 2200, 2208, 2216, 2224, 2232, 2240, 2248, 2256, 2264,
+        2272, 2280, 2288, 2296, 2304, 2314, 2324, 2334, 2344, 2354, 2364, 2377, 2390, 2403, 2416, 2429,
+        2442, 2449, 2456, 2463, 2470, 2477, 2484, 2492, 2500, 2508, 2516, 2524, 2532, 2539, 2546, 2553,
+        2560, 2567, 2574, 2579, 2584, 2589, 2594, 2599, 2604, 2611, 2618, 2625, 2632, 2639, 2646, 2651,
+        2656, 2661, 2666, 2671, 2676, 2681, 2686, 2691, 2696, 2701, 2706, 2714, 2722, 2730, 2738, 2746,
+        2754, 2758, 2762, 2766, 2770, 2774, 2778, 2786, 2794, 2802, 2810, 2818, 2826, 2834, 2842, 2850,
+        2858, 2866, 2874, 2881, 2888, 2895, 2902, 2909, 2916, 2924, 2932, 2940, 2948, 2956, 2964, 2971,
+        2978, 2985, 2992, 2999, 3006, 3012, 3018, 3024, 3030, 3036, 3042, 3050, 3058, 3066, 3074, 3082,
+        3090, 3098, 3106, 3114, 3122, 3130, 3138, 3142, 3146, 3150, 3154, 3158, 3162, 3168, 3174, 3180,
+        3186, 3192, 3198, 3205, 3212, 3219, 3226, 3233, 3240, 3244, 3248, 3252, 3256, 3260, 3264, 3276,
+        3288, 3300, 3312, 3324, 3336, 3344, 3352, 3360, 3368, 3376, 3384, 3392, 3400, 3408, 3416, 3424,
+        3432, 3440, 3448, 3456, 3464, 3472, 3480, 3488, 3496, 3504, 3512, 3520, 3528, 3535, 3542, 3549,
+        3556, 3563, 3570, 3576, 3582, 3588, 3594, 3600, 3606, 3612, 3618, 3624, 3630, 3636, 3642, 3650,
+        3658, 3666, 3674, 3682, 3690, 3698, 3706, 3714, 3722, 3730, 3738, 3749, 3760, 3771, 3782, 3793,
+        3804, 3811, 3818, 3825, 3832, 3839, 3846, 3854, 3862, 3870, 3878, 3886, 3894, 3900, 3906, 3912,
+        3918, 3924, 3930, 3936, 3942, 3948, 3954, 3960, 3966, 3970, 3974, 3978, 3982, 3986, 3990, 3996,
+        4002, 4008, 4014, 4020, 4026, 4032, 4038, 4044, 4050, 4056, 4062, 4070, 4078, 4086, 4094, 4102,
+        4110, 4118, 4126, 4134, 4142, 4150, 4158, 4166, 4174, 4182, 4190, 4198, 4206, 4214, 4222, 4230,
+        4238, 4246, 4254, 4262, 4270, 4278, 4286, 4294, 4302, 4310, 4318, 4326, 4334, 4342, 4350, 4357,
+        4364, 4371, 4378, 4385, 4392,
+    };
+    static const RowEdges rowEdges[] = {
+        {1, 0, 1, 0}, {1, 0, 1, 0}, {1, 0, 1, 0}, {1, 0, 1, 0}, {1, 0, 1, 0}, {1, 0, 1, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {4, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {4, 1, 1, 0},
+        {4, 1, 1, 0}, {6, 0, 0, 0}, {4, 3, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {3, 2, 0, 0}, {11, 0, 0, 0},
+        {3, 2, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0},
+        {3, 1, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {7, 0, 0, 0}, {3, 3, 0, 0}, {2, 2, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0},
+        {2, 0, 0, 0}, {9, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {2, 1, 1, 0}, {2, 1, 1, 0}, {4, 0, 0, 0},
+        {3, 0, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {1, 2, 0, 0}, {1, 1, 0, 0},
+        {2, 0, 0, 0}, {2, 0, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {7, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0},
+        {3, 2, 0, 0}, {7, 0, 0, 0}, {8, 0, 0, 0}, {4, 3, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {3, 2, 0, 0}, {8, 0, 0, 0},
+        {4, 0, 0, 0}, {4, 0, 0, 0}, {4, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {8, 0, 0, 0}, {8, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {4, 3, 1, 0}, {8, 0, 0, 0}, {4, 0, 0, 0}, {4, 0, 0, 0}, {4, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {4, 0, 0, 0}, {5, 0, 0, 0}, {4, 0, 0, 0}, {3, 1, 0, 0}, {2, 2, 0, 0}, {1, 3, 0, 0}, {7, 0, 0, 0},
+        {3, 2, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {4, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {3, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 1, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {8, 0, 0, 0},
+        {2, 3, 0, 0}, {1, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {4, 2, 0, 0}, {9, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0},
+        {1, 1, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {8, 0, 0, 0}, {3, 3, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0},
+        {2, 1, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {4, 1, 0, 0}, {3, 2, 0, 0}, {2, 3, 0, 0}, {8, 0, 0, 0},
+        {3, 2, 0, 0}, {2, 1, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0}, {3, 2, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {2, 0, 0, 0}, {4, 1, 0, 0}, {8, 0, 0, 0}, {4, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {4, 0, 0, 0}, {4, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0},
+        {3, 0, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {5, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {4, 3, 1, 0}, {8, 0, 0, 0}, {1, 2, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {2, 0, 0, 0},
+        {1, 1, 0, 0}, {5, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {3, 0, 0, 0}, {2, 1, 0, 0}, {2, 1, 0, 0}, {6, 0, 0, 0},
+        {4, 2, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {3, 1, 0, 0}, {5, 4, 0, 0}, {4, 3, 0, 0},
+        {3, 2, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {10, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 1, 0, 0}, {8, 0, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 4, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0},
+        {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 3, 0, 0}, {1, 2, 0, 0},
+        {1, 4, 0, 0}, {8, 0, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {2, 1, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {6, 0, 0, 0}, {6, 1, 0, 0}, {5, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0},
+        {2, 1, 0, 0}, {8, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {7, 0, 0, 0},
+        {2, 5, 0, 0}, {1, 4, 0, 0}, {1, 4, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {9, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {8, 0, 0, 0}, {3, 2, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0},
+        {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 4, 0, 0}, {8, 0, 0, 0}, {3, 2, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0},
+        {1, 0, 0, 0}, {8, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {8, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {3, 2, 0, 0}, {3, 2, 0, 0}, {3, 2, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {3, 2, 0, 0},
+        {4, 3, 0, 0}, {10, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {3, 2, 0, 0}, {4, 3, 0, 0}, {13, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {7, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0},
+        {2, 1, 0, 0}, {3, 2, 0, 0}, {3, 2, 0, 0}, {8, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {3, 1, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {7, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 4, 0, 0}, {1, 3, 0, 0}, {2, 2, 0, 0}, {3, 1, 0, 0}, {4, 0, 0, 0}, {7, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {2, 0, 0, 0}, {2, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {3, 1, 1, 0}, {3, 1, 1, 0},
+        {3, 1, 1, 0}, {5, 0, 0, 0}, {8, 0, 0, 0}, {8, 0, 0, 0}, {8, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {3, 0, 1, 0}, {3, 0, 1, 0}, {4, 0, 0, 0}, {8, 0, 0, 0}, {3, 1, 0, 0},
+        {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0}, {2, 5, 0, 0}, {1, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 1, 0, 0}, {8, 0, 0, 0}, {7, 0, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {7, 0, 0, 0},
+        {6, 1, 0, 0}, {3, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0}, {7, 0, 0, 0}, {3, 1, 0, 0},
+        {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {7, 0, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 2, 0, 0}, {6, 0, 0, 0}, {8, 0, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {2, 1, 0, 0},
+        {2, 5, 0, 0}, {1, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {4, 0, 0, 0}, {4, 1, 0, 0}, {3, 0, 0, 0}, {3, 0, 0, 0}, {3, 0, 0, 0},
+        {2, 0, 0, 0}, {1, 1, 0, 0}, {2, 4, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {7, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {4, 0, 0, 0}, {12, 0, 0, 0}, {2, 2, 0, 0},
+        {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {12, 0, 0, 0}, {8, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {8, 0, 0, 0}, {8, 0, 0, 0}, {3, 2, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0},
+        {8, 0, 0, 0}, {2, 2, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {1, 4, 0, 0}, {8, 0, 0, 0}, {3, 1, 0, 0},
+        {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {5, 0, 0, 0}, {7, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 3, 0, 0},
+        {1, 3, 0, 0}, {7, 0, 0, 0}, {6, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {6, 0, 0, 0},
+        {2, 3, 0, 0}, {1, 1, 0, 0}, {1, 0, 0, 0}, {1, 1, 0, 0}, {2, 0, 0, 0}, {6, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0}, {8, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0},
+        {3, 2, 0, 0}, {8, 0, 0, 0}, {11, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {3, 2, 0, 0}, {11, 0, 0, 0},
+        {7, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {7, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {2, 1, 0, 0}, {6, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0},
+        {1, 0, 0, 0}, {6, 0, 0, 0}, {4, 0, 0, 0}, {3, 0, 0, 0}, {2, 1, 0, 0}, {1, 2, 0, 0}, {2, 1, 0, 0}, {3, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 3, 0, 0}, {1, 2, 0, 0},
+        {2, 1, 0, 0}, {3, 0, 0, 0}, {2, 1, 0, 0}, {1, 2, 0, 0}, {2, 0, 0, 0}, {1, 1, 0, 0}, {3, 2, 1, 0}, {3, 2, 1, 0},
+        {3, 2, 1, 0}, {6, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {3, 2, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {8, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {1, 0, 0, 0},
+        {2, 0, 0, 0}, {8, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {1, 0, 0, 0}, {2, 1, 0, 0}, {8, 0, 0, 0},
+        {2, 1, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 0, 0}, {8, 0, 0, 0}, {3, 1, 0, 0}, {2, 0, 0, 0},
+        {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 0, 0, 0}, {1, 3, 0, 0},
+    };
+    static const char rowData[] =
+        " $ $ $ $ $ $"  // 32
+        "  _  | | | | |_| (_)    "  // 33
+        "  _ _  ( | )  V V     $     $       "  // 34
+        "    _  _     _| || |_  |_  __  _| |_  __  _|   |_||_|             "  // 35
+        "   _    | |  / __) \\__ \\ (   /  |_| "  // 36
+        "  _  __ (_)/ /   / /   / /_  /_/(_)       "  // 37
+        "   ___     ( _ )    / _ \\/\\ | (_>  <  \\___/\\/         "  // 38
+        "  _  ( ) |/   $   $     "  // 39
+        "   __  / / | |  | |  | |   \\_\\"  // 40
+        " __   \\ \\   | |  | |  | | /_/ "  // 41
+        "        __/\\__ \\    / /_  _\\   \\/         "  // 42
+        "            _     _| |_  |_   _|   |_|          "  // 43
+        "              _  ( ) |/ "  // 44
+        "                  _____  |_____|    $           "  // 45
+        "              _  (_)    "  // 46
+        "     __    / /   / /   / /   /_/          "  // 47
+        "   ___    / _ \\  | | | | | |_| |  \\___/         "  // 48
+        "  _  / | | | | | |_|    "  // 49
+        "  ____   |___ \\    __) |  / __/  |_____|        "  // 50
+        "  _____  |___ /    |_ \\   ___) | |____/         "  // 51
+        "  _  _    | || |   | || |_  |__   _|    |_|           "  // 52
+        "  ____   | ___|  |___ \\   ___) | |____/         "  // 53
+        "   __     / /_   | '_ \\  | (_) |  \\___/         "  // 54
+        "  _____  |___  |    / /    / /    /_/           "  // 55
+        "   ___    ( _ )   / _ \\  | (_) |  \\___/         "  // 56
+        "   ___    / _ \\  | (_) |  \\__, |    /_/         "  // 57
+        "      _  (_)  _  (_)    "  // 58
+        "      _  (_)  _  ( ) |/ "  // 59
+        "   __  / / / /  \\ \\   \\_\\     "  // 60
+        "          _____  |_____| |_____|    $           "  // 61
+        " __   \\ \\   \\ \\  / / /_/      "  // 62
+        "  ___  |__ \\   / /  |_|   (_)       "  // 63
+        "    ____     / __ \\   / / _` | | | (_| |  \\ \\__,_|   \\____/ "  // 64
+        "     _        / \\      / _ \\    / ___ \\  /_/   \\_\\          "  // 65
+        "  ____   | __ )  |  _ \\  | |_) | |____/         "  // 66
+        "   ____   / ___| | |     | |___   \\____|        "  // 67
+        "  ____   |  _ \\  | | | | | |_| | |____/         "  // 68
+        "  _____  | ____| |  _|   | |___  |_____|        "  // 69
+        "  _____  |  ___| | |_    |  _|   |_|            "  // 70
+        "   ____   / ___| | |  _  | |_| |  \\____|        "  // 71
+        "  _   _  | | | | | |_| | |  _  | |_| |_|        "  // 72
+        "  ___  |_ _|  | |   | |  |___|      "  // 73
+        "      _      | |  _  | | | |_| |  \\___/         "  // 74
+        "  _  __ | |/ / | ' /  | . \\  |_|\\_\\       "  // 75
+        "  _      | |     | |     | |___  |_____|        "  // 76
+        "  __  __  |  \\/  | | |\\/| | | |  | | |_|  |_|         "  // 77
+        "  _   _  | \\ | | |  \\| | | |\\  | |_| \\_|        "  // 78
+        "   ___    / _ \\  | | | | | |_| |  \\___/         "  // 79
+        "  ____   |  _ \\  | |_) | |  __/  |_|            "  // 80
+        "   ___    / _ \\  | | | | | |_| |  \\__\\_\\        "  // 81
+        "  ____   |  _ \\  | |_) | |  _ <  |_| \\_\\        "  // 82
+        "  ____   / ___|  \\___ \\   ___) | |____/         "  // 83
+        "  _____  |_   _|   | |     | |     |_|          "  // 84
+        "  _   _  | | | | | | | | | |_| |  \\___/         "  // 85
+        " __     __ \\ \\   / /  \\ \\ / /    \\ V /      \\_/             "  // 86
+        " __        __ \\ \\      / /  \\ \\ /\\ / /    \\ V  V /      \\_/\\_/                "  // 87
+        " __  __ \\ \\/ /  \\  /   /  \\  /_/\\_\\       "  // 88
+        " __   __ \\ \\ / /  \\ V /    | |     |_|          "  // 89
+        "  _____ |__  /   / /   / /_  /____|       "  // 90
+        "  __  | _| | |  | |  | |  |__|"  // 91
+        " __     \\ \\     \\ \\     \\ \\     \\_\\       "  // 92
+        "  __  |_ |  | |  | |  | | |__|"  // 93
+        "  /\\  |/\\|   $    $    $      "  // 94
+        "                                  _____  |_____|"  // 95
+        "  _  ( )  \\|   $   $    "  // 96
+        "           __ _   / _` | | (_| |  \\__,_|        "  // 97
+        "  _      | |__   | '_ \\  | |_) | |_.__/         "  // 98
+        "          ___   / __| | (__   \\___|       "  // 99
+        "      _    __| |  / _` | | (_| |  \\__,_|        "  // 100
+        "          ___   / _ \\ |  __/  \\___|       "  // 101
+        "   __   / _| | |_  |  _| |_|        "  // 102
+        "           __ _   / _` | | (_| |  \\__, |  |___/ "  // 103
+        "  _      | |__   | '_ \\  | | | | |_| |_|        "  // 104
+        "  _  (_) | | | | |_|    "  // 105
+        "    _    (_)   | |   | |  _/ | |__/ "  // 106
+        "  _     | | __ | |/ / |   <  |_|\\_\\       "  // 107
+        "  _  | | | | | | |_|    "  // 108
+        "              _ __ ___   | '_ ` _ \\  | | | | | | |_| |_| |_|            "  // 109
+        "          _ __   | '_ \\  | | | | |_| |_|        "  // 110
+        "           ___    / _ \\  | (_) |  \\___/         "  // 111
+        "          _ __   | '_ \\  | |_) | | .__/  |_|    "  // 112
+        "           __ _   / _` | | (_| |  \\__, |     |_|"  // 113
+        "         _ __  | '__| | |    |_|          "  // 114
+        "        ___  / __| \\__ \\ |___/      "  // 115
+        "  _    | |_  | __| | |_   \\__|      "  // 116
+        "          _   _  | | | | | |_| |  \\__,_|        "  // 117
+        "         __   __ \\ \\ / /  \\ V /    \\_/          "  // 118
+        "            __      __ \\ \\ /\\ / /  \\ V  V /    \\_/\\_/             "  // 119
+        "        __  __ \\ \\/ /  >  <  /_/\\_\\       "  // 120
+        "          _   _  | | | | | |_| |  \\__, |  |___/ "  // 121
+        "        ____ |_  /  / /  /___|      "  // 122
+        "    __   / /  | |  < <    | |    \\_\\"  // 123
+        "  _  | | | | | | | | |_|"  // 124
+        " __    \\ \\    | |    > >  | |  /_/  "  // 125
+        "  /\\/| |/\\/    $     $     $        "  // 126
+        "  _   _  (_)_(_)   /_\\    / _ \\  /_/ \\_\\        "  // 196
+        "  _   _  (_)_(_)  / _ \\  | |_| |  \\___/         "  // 214
+        "  _   _  (_) (_) | | | | | |_| |  \\___/         "  // 220
+        "  _   _  (_)_(_)  / _` | | (_| |  \\__,_|        "  // 228
+        "  _   _  (_)_(_)  / _ \\  | (_) |  \\___/         "  // 246
+        "  _   _  (_) (_) | | | | | |_| |  \\__,_|        "  // 252
+        "   ___   / _ \\ | |/ / | |\\ \\ | ||_/ |_|   ";  // 223
+    static const Builtin font = {"standard", 6, 5, 16, 15, 24463, 0, 0, '$', 102, codes, rowOffsets, rowEdges, rowData};
+    return font;
+}
+
+// the FigFont term, generated by 'BuildInc --compile-font term.flf,term.hpp'
+inline const Builtin& getBuiltinTerm() {
+    static const int32_t codes[] = {
+        32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+        48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+        64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+        80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+        96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111,
+        112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 196,
+        214, 220, 228, 246, 252, 223,
+    };
+    static const uint32_t rowOffsets[] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+        16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+        32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+        48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+        64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+        80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+        97, 99, 101, 103, 105, 107, 109,
+    };
+    static const RowEdges rowEdges[] = {
+        {0, 0, 1, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+        {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+    };
+    static const char rowData[] =
+        "$"  // 32
+        "!"  // 33
+        "\""  // 34
+        "#"  // 35
+        "$"  // 36
+        "%"  // 37
+        "&"  // 38
+        "'"  // 39
+        "("  // 40
+        ")"  // 41
+        "*"  // 42
+        "+"  // 43
+        ","  // 44
+        "-"  // 45
+        "."  // 46
+        "/"  // 47
+        "0"  // 48
+        "1"  // 49
+        "2"  // 50
+        "3"  // 51
+        "4"  // 52
+        "5"  // 53
+        "6"  // 54
+        "7"  // 55
+        "8"  // 56
+        "9"  // 57
+        ":"  // 58
+        ";"  // 59
+        "<"  // 60
+        "="  // 61
+        ">"  // 62
+        "\?"  // 63
+        "@"  // 64
+        "A"  // 65
+        "B"  // 66
+        "C"  // 67
+        "D"  // 68
+        "E"  // 69
+        "F"  // 70
+        "G"  // 71
+        "H"  // 72
+        "I"  // 73
+        "J"  // 74
+        "K"  // 75
+        "L"  // 76
+        "M"  // 77
+        "N"  // 78
+        "O"  // 79
+        "P"  // 80
+        "Q"  // 81
+        "R"  // 82
+        "S"  // 83
+        "T"  // 84
+        "U"  // 85
+        "V"  // 86
+        "W"  // 87
+        "X"  // 88
+        "Y"  // 89
+        "Z"  // 90
+        "["  // 91
+        "\\"  // 92
+        "]"  // 93
+        "^"  // 94
+        "_"  // 95
+        "`"  // 96
+        "a"  // 97
+        "b"  // 98
+        "c"  // 99
+        "d"  // 100
+        "e"  // 101
+        "f"  // 102
+        "g"  // 103
+        "h"  // 104
+        "i"  // 105
+        "j"  // 106
+        "k"  // 107
+        "l"  // 108
+        "m"  // 109
+        "n"  // 110
+        "o"  // 111
+        "p"  // 112
+        "q"  // 113
+        "r"  // 114
+        "s"  // 115
+        "t"  // 116
+        "u"  // 117
+        "v"  // 118
+        "w"  // 119
+        "x"  // 120
+        "y"  // 121
+        "z"  // 122
+        "{"  // 123
+        "|"  // 124
+        "}"  // 125
+        "~"  // 126
+        "\303\204"  // 196
+        "\303\226"  // 214
+        "\303\234"  // 220
+        "\303\244"  // 228
+        "\303\266"  // 246
+        "\303\274"  // 252
+        "\303\237";  // 223
+    static const Builtin font = {"term", 1, 1, 2, -1, 0, 0, 0, '$', 102, codes, rowOffsets, rowEdges, rowData};
+    return font;
+}
+
+inline const Builtin* findBuiltin(const std::string& vName) {
+    static const Builtin* const builtins[] = {&getBuiltinStandard(), &getBuiltinTerm()};
+    for (const auto* font : builtins) {
+        if (vName == font->name) {
+            return font;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace figfont
+}  // namespace ez
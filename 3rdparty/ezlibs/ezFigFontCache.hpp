@@ -0,0 +1,317 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezFigFontCache is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+/* Cache of the rendered FigFont labels, content addressed, kept between the runs :
+ one file per label '<dir>/<key>.lbl', the key is the hash of the font digest (FigFont::getDigest) and of the text.
+ [EntryHeader][text][label], the digest and the text are compared at the read, so a collision is only a miss.
+ a hit touch its file, the least recently used files are removed when the entries exceed the max size.
+ the temporary files older than an hour are removed too, they are let by a crash
+ the entries are written in a temporary file then renamed (ezFile), so the directory can be shared by many machines (CI)
+*/
+
+#include "ezOS.hpp"
+#include "ezFile.hpp"
+
+#ifdef WINDOWS_OS
+#include <direct.h>
+#include <sys/utime.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#endif
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <algorithm>
+
+#ifndef EZ_STATS_SCOPE  // include ezStats.hpp before this include for enable the stats
+#define EZ_STATS_SCOPE(phase)
+#define EZ_STATS_ADD(counter, value)
+#endif  // EZ_STATS_SCOPE
+
+namespace ez {
+
+class FigFontCache {
+public:
+    static constexpr uint64_t defaultMaxSize = 4U * 1024U * 1024U;
+
+private:
+    struct EntryHeader {
+        char magic[4];  // 'EZLC'
+        uint32_t version;
+        uint64_t digest;
+        uint32_t textSize;
+        uint32_t labelSize;
+    };
+    static_assert(sizeof(EntryHeader) == 24, "the EntryHeader must not have padding");
+    static constexpr uint32_t entryVersion = 1;
+    static constexpr int64_t staleTmpAge = 3600;  // in seconds, a temporary file older is let by a crash
+#ifdef WINDOWS_OS
+    static constexpr int64_t mtimePerSecond = 10000000LL;  // FILETIME, 100 ns
+#else
+    static constexpr int64_t mtimePerSecond = 1000000000LL;  // ns
+#endif
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        int64_t mtime;
+    };
+    std::string m_dir;  // empty if disabled
+    uint64_t m_maxSize = defaultMaxSize;
+    std::string m_path;  // reused
+    std::string m_buffer;  // reused
+
+public:
+    // the directory is created at the first store, empty disable the cache
+    FigFontCache& setDirectory(const std::string& vDir) {
+        m_dir = vDir;
+        while (m_dir.size() > 1 && (m_dir.back() == '/' || m_dir.back() == '\\')) {
+            m_dir.pop_back();
+        }
+        return *this;
+    }
+    // in bytes of entries, 0 for the default
+    FigFontCache& setMaxSize(const uint64_t vMaxSize) {
+        m_maxSize = vMaxSize;
+        if (m_maxSize == 0) {
+            m_maxSize = defaultMaxSize;
+        }
+        return *this;
+    }
+    bool isEnabled() const { return !m_dir.empty(); }
+    const std::string& getDirectory() const { return m_dir; }
+
+    // the cache of the user : %LOCALAPPDATA%/BuildInc/labels, $XDG_CACHE_HOME/buildinc/labels or ~/.cache/buildinc/labels
+    static std::string getDefaultDirectory() {
+#ifdef WINDOWS_OS
+        const char* base = std::getenv("LOCALAPPDATA");
+        return (base != nullptr && base[0] != '\0') ? std::string(base) + "/BuildInc/labels" : std::string();
+#else
+        const char* base = std::getenv("XDG_CACHE_HOME");
+        if (base != nullptr && base[0] != '\0') {
+            return std::string(base) + "/buildinc/labels";
+        }
+        base = std::getenv("HOME");
+        return (base != nullptr && base[0] != '\0') ? std::string(base) + "/.cache/buildinc/labels" : std::string();
+#endif
+    }
+
+    // append the label of the text rendered by the font of vDigest, false if not in the cache
+    bool load(const uint64_t vDigest, const std::string& vText, std::string& vOutLabel) {
+        if (!isEnabled()) {
+            return false;
+        }
+        m_setPath(vDigest, vText);
+        EntryHeader header;
+        std::ifstream file(m_path, std::ios::in | std::ios::binary);
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(EntryHeader)) || std::memcmp(header.magic, "EZLC", 4) != 0 ||  //
+            header.version != entryVersion || header.digest != vDigest || header.textSize != vText.size()) {
+            EZ_STATS_ADD(LabelCacheMisses, 1);
+            return false;
+        }
+        m_buffer.resize(static_cast<size_t>(header.textSize) + header.labelSize);
+        if ((!m_buffer.empty() && !file.read(&m_buffer[0], static_cast<std::streamsize>(m_buffer.size()))) ||  //
+            m_buffer.compare(0, header.textSize, vText) != 0) {
+            EZ_STATS_ADD(LabelCacheMisses, 1);
+            return false;
+        }
+        vOutLabel.append(m_buffer, header.textSize, header.labelSize);
+        m_touch(m_path);
+        EZ_STATS_ADD(LabelCacheHits, 1);
+        EZ_STATS_ADD(BytesRead, sizeof(EntryHeader) + m_buffer.size());
+        EZ_STATS_ADD(FilesRead, 1);
+        return true;
+    }
+
+    // the label of the text rendered by the font of vDigest, then the old entries are evicted if needed
+    bool store(const uint64_t vDigest, const std::string& vText, const std::string& vLabel) {
+        if (!isEnabled() || !m_makeDirectories(m_dir)) {
+            return false;
+        }
+        m_setPath(vDigest, vText);
+        EntryHeader header{};
+        std::memcpy(header.magic, "EZLC", 4);
+        header.version = entryVersion;
+        header.digest = vDigest;
+        header.textSize = static_cast<uint32_t>(vText.size());
+        header.labelSize = static_cast<uint32_t>(vLabel.size());
+        m_buffer.assign(reinterpret_cast<const char*>(&header), sizeof(EntryHeader));
+        m_buffer += vText;
+        m_buffer += vLabel;
+        if (!ez::file::replace(m_path, m_buffer)) {
+            return false;
+        }
+        evict();
+        return true;
+    }
+
+    // remove the temporary files let by a crash, then the least recently used entries until they fit in the max size.
+    // the concurrent evictions of a shared directory can remove the same files, the failures are ignored
+    void evict() {
+        if (!isEnabled()) {
+            return;
+        }
+        std::vector<Entry> entries, tmpFiles;
+        m_listEntries(entries, tmpFiles);
+        const int64_t staleTime = m_getNow() - staleTmpAge * mtimePerSecond;  // a store in progress is not stale
+        for (const auto& tmpFile : tmpFiles) {
+            if (tmpFile.mtime < staleTime) {
+                std::remove(tmpFile.path.c_str());
+            }
+        }
+        uint64_t total = 0;
+        for (const auto& entry : entries) {
+            total += entry.size;
+        }
+        if (total <= m_maxSize) {
+            return;
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+        const uint64_t target = m_maxSize - m_maxSize / 4U;  // a margin, so the next stores dont evict again
+        for (const auto& entry : entries) {
+            if (total <= target) {
+                break;
+            }
+            std::remove(entry.path.c_str());
+            total -= entry.size;
+        }
+    }
+
+private:
+    // '<dir>/<16 hex digits>.lbl'
+    void m_setPath(const uint64_t vDigest, const std::string& vText) {
+        uint64_t key = 14695981039346656037ULL;  // FNV-1a
+        for (size_t i = 0; i < sizeof(vDigest); ++i) {
+            key = (key ^ ((vDigest >> (i * 8U)) & 0xFFU)) * 1099511628211ULL;
+        }
+        for (const auto c : vText) {
+            key = (key ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+        }
+        static const char hex[] = "0123456789abcdef";
+        m_path.assign(m_dir);
+        m_path += '/';
+        for (int32_t shift = 60; shift >= 0; shift -= 4) {
+            m_path += hex[(key >> shift) & 0xFU];
+        }
+        m_path += ".lbl";
+    }
+
+    static bool m_isEntry(const char* vName) {
+        const size_t len = std::strlen(vName);
+        return len > 4 && std::strcmp(vName + len - 4, ".lbl") == 0;
+    }
+
+    // the entries, and the temporary files of the stores (ezFile)
+    void m_listEntries(std::vector<Entry>& vOutEntries, std::vector<Entry>& vOutTmpFiles) {
+#ifdef WINDOWS_OS
+        WIN32_FIND_DATAA data;
+        HANDLE handle = FindFirstFileA((m_dir + "\\*").c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        do {
+            const bool tmpFile = ez::file::isTempFile(data.cFileName);
+            if (tmpFile || m_isEntry(data.cFileName)) {
+                const uint64_t size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32U) | data.nFileSizeLow;
+                const int64_t mtime = static_cast<int64_t>((static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32U) | data.ftLastWriteTime.dwLowDateTime);
+                (tmpFile ? vOutTmpFiles : vOutEntries).push_back(Entry{m_dir + "/" + data.cFileName, size, mtime});
+            }
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+#else
+        DIR* dir = opendir(m_dir.c_str());
+        if (dir == nullptr) {
+            return;
+        }
+        while (const auto* ent = readdir(dir)) {
+            struct stat st;
+            const bool tmpFile = ez::file::isTempFile(ent->d_name);
+            if ((tmpFile || m_isEntry(ent->d_name)) && fstatat(dirfd(dir), ent->d_name, &st, 0) == 0) {
+#ifdef __APPLE__
+                const int64_t mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+                const int64_t mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+                (tmpFile ? vOutTmpFiles : vOutEntries).push_back(Entry{m_dir + "/" + ent->d_name, static_cast<uint64_t>(st.st_size), mtime});
+            }
+        }
+        closedir(dir);
+#endif
+    }
+
+    // now, in the unit of the mtimes of m_listEntries
+    static int64_t m_getNow() {
+#ifdef WINDOWS_OS
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        return static_cast<int64_t>((static_cast<uint64_t>(now.dwHighDateTime) << 32U) | now.dwLowDateTime);
+#else
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+#endif
+    }
+
+    // for the eviction, the mtime is the time of the last use
+    static void m_touch(const std::string& vFilePathName) {
+#ifdef WINDOWS_OS
+        _utime(vFilePathName.c_str(), nullptr);
+#else
+        utimensat(AT_FDCWD, vFilePathName.c_str(), nullptr, 0);
+#endif
+    }
+
+    // like 'mkdir -p'
+    static bool m_makeDirectories(const std::string& vDir) {
+        struct stat st;
+        if (stat(vDir.c_str(), &st) == 0) {
+            return true;
+        }
+        for (size_t pos = vDir.find_first_of("/\\", 1); pos != std::string::npos; pos = vDir.find_first_of("/\\", pos + 1)) {
+            m_makeDirectory(vDir.substr(0, pos));
+        }
+        return m_makeDirectory(vDir) || stat(vDir.c_str(), &st) == 0;
+    }
+    static bool m_makeDirectory(const std::string& vDir) {
+#ifdef WINDOWS_OS
+        return _mkdir(vDir.c_str()) == 0;
+#else
+        return mkdir(vDir.c_str(), 0777) == 0;
+#endif
+    }
+};
+
+}  // namespace ez
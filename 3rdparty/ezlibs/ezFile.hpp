@@ -0,0 +1,210 @@
+#pragma once
+
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezFile is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+/* Replace of a file by a temporary file renamed on it, so a reader never see a half written file.
+ the temporary file is '<file>.<host>.<pid>.<counter>.tmp' : unique between the threads, the processes
+ and the machines sharing a directory (network drive, CI cache). it is created with tempFileMode,
+ less the umask of the process. a crash can let it, see isTempFile for clean them
+*/
+
+#include "ezOS.hpp"
+
+#ifdef WINDOWS_OS
+#include <windows.h>
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+#ifndef EZ_STATS_SCOPE  // include ezStats.hpp before this include for enable the stats
+#define EZ_STATS_SCOPE(phase)
+#define EZ_STATS_ADD(counter, value)
+#endif  // EZ_STATS_SCOPE
+
+namespace ez {
+namespace file {
+
+static constexpr int tempFileMode = 0666;
+
+namespace internal {
+
+inline void appendNumber(std::string& vOut, uint64_t vNumber) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + (vNumber % 10U));
+        vNumber /= 10U;
+    } while (vNumber != 0U);
+    while (count != 0U) {
+        vOut += digits[--count];
+    }
+}
+
+// the host name of the machine, read once. only [A-Za-z0-9-] are kept, so it is a valid file name
+inline const std::string& getHostName() {
+    static const std::string s_hostName = []() {
+        char buffer[256] = {};
+#ifdef WINDOWS_OS
+        DWORD size = sizeof(buffer);
+        if (!GetComputerNameA(buffer, &size)) {
+            buffer[0] = '\0';
+        }
+#else
+        if (gethostname(buffer, sizeof(buffer) - 1) != 0) {
+            buffer[0] = '\0';
+        }
+#endif
+        std::string ret;
+        for (const char* c = buffer; *c != '\0'; ++c) {
+            const bool valid = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') || *c == '-';
+            ret += valid ? *c : '_';
+        }
+        return ret.empty() ? std::string("host") : ret;
+    }();
+    return s_hostName;
+}
+
+}  // namespace internal
+
+// '<file>.<host>.<pid>.<counter>.tmp' in vOut, its buffer is reused
+inline void getTempFileName(const std::string& vFilePathName, std::string& vOut) {
+    static std::atomic<uint64_t> s_counter{0};
+    const auto& host = internal::getHostName();
+    const size_t size = vFilePathName.size() + host.size() + 48U;  // 2 numbers of 20 digits and the dots
+    if (vOut.capacity() < size) {
+        vOut.reserve(size);
+    }
+    vOut.assign(vFilePathName);
+    vOut += '.';
+    vOut += host;
+    vOut += '.';
+#ifdef WINDOWS_OS
+    internal::appendNumber(vOut, static_cast<uint64_t>(_getpid()));
+#else
+    internal::appendNumber(vOut, static_cast<uint64_t>(getpid()));
+#endif
+    vOut += '.';
+    internal::appendNumber(vOut, s_counter++);
+    vOut += ".tmp";
+}
+
+// a temporary file of getTempFileName, by its name
+inline bool isTempFile(const char* vName) {
+    const size_t len = std::strlen(vName);
+    return len > 4 && std::strcmp(vName + len - 4, ".tmp") == 0;
+}
+
+// write vTmpFile then rename it on vFilePathName, vTmpFile is removed on a failure.
+// vSync flush the file and the rename on the disk before to return
+inline bool writeThenRename(const std::string& vTmpFile, const std::string& vFilePathName, const char* vData, const size_t vSize, const bool vSync = false) {
+#ifdef WINDOWS_OS
+    std::FILE* fp = std::fopen(vTmpFile.c_str(), "wb");
+    if (fp == nullptr) {
+        return false;
+    }
+    bool ret = (std::fwrite(vData, 1, vSize, fp) == vSize);
+    ret = (std::fflush(fp) == 0) && ret;
+    if (ret && vSync) {
+        EZ_STATS_SCOPE(Fsync);
+        ret = (_commit(_fileno(fp)) == 0);
+    }
+    ret = (std::fclose(fp) == 0) && ret;
+    bool renamed = false;
+    if (ret) {
+        renamed = ret = (MoveFileExA(vTmpFile.c_str(), vFilePathName.c_str(), MOVEFILE_REPLACE_EXISTING | (vSync ? MOVEFILE_WRITE_THROUGH : 0)) != 0);
+    }
+#else
+    const int fd = open(vTmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, tempFileMode);
+    if (fd < 0) {
+        return false;
+    }
+    bool ret = true;
+    size_t offset = 0;
+    while (ret && offset < vSize) {
+        const auto count = write(fd, vData + offset, vSize - offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        ret = (count > 0);
+        offset += (count > 0) ? static_cast<size_t>(count) : 0U;
+    }
+    if (ret && vSync) {
+        EZ_STATS_SCOPE(Fsync);
+        ret = (fsync(fd) == 0);
+    }
+    ret = (close(fd) == 0) && ret;
+    bool renamed = false;
+    if (ret) {
+        renamed = ret = (std::rename(vTmpFile.c_str(), vFilePathName.c_str()) == 0);
+    }
+    if (ret && vSync) {  // the rename is in the directory
+        EZ_STATS_SCOPE(Fsync);
+        const auto slash = vFilePathName.find_last_of('/');
+        const std::string dir = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : vFilePathName.substr(0, slash));
+        const int dirFd = open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+        ret = (dirFd >= 0) && (fsync(dirFd) == 0);
+        if (dirFd >= 0) {
+            close(dirFd);
+        }
+    }
+#endif
+    if (!ret) {
+        if (!renamed) {
+            std::remove(vTmpFile.c_str());
+        }
+        return false;
+    }
+    EZ_STATS_ADD(BytesWritten, vSize);
+    EZ_STATS_ADD(FilesWritten, 1);
+    return true;
+}
+
+// replace vFilePathName by vData, through a temporary file of getTempFileName
+inline bool replace(const std::string& vFilePathName, const char* vData, const size_t vSize, const bool vSync = false) {
+    thread_local std::string tmpFile;  // reused, no allocation per call
+    getTempFileName(vFilePathName, tmpFile);
+    return writeThenRename(tmpFile, vFilePathName, vData, vSize, vSync);
+}
+
+inline bool replace(const std::string& vFilePathName, const std::string& vContent, const bool vSync = false) {
+    return replace(vFilePathName, vContent.data(), vContent.size(), vSync);
+}
+
+}  // namespace file
+}  // namespace ez
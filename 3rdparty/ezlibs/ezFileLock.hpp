@@ -0,0 +1,171 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezFileLock is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// exclusive lock between processes, held until the destruction.
+// the files of BuildInc are replaced by a rename, so the lock is taken on a side file '<file>.lock'
+
+#include "ezOS.hpp"
+
+#ifdef WINDOWS_OS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
+
+#include <cerrno>
+#include <string>
+#include <cstdint>
+
+namespace ez {
+
+class FileLock {
+private:
+#ifdef WINDOWS_OS
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+#else
+    int m_fd = -1;
+#endif
+    int64_t m_byte = -1;  // the locked byte, -1 for the whole file
+    bool m_busy = false;
+
+public:
+    FileLock() = default;
+    // block until the lock of vFilePathName is taken
+    explicit FileLock(const std::string& vFilePathName) { lock(vFilePathName); }
+    ~FileLock() { unlock(); }
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    bool lock(const std::string& vFilePathName) { return m_lock(vFilePathName, true, -1); }
+    // take the lock only if free, false if another owner has it (see wasBusy)
+    bool tryLock(const std::string& vFilePathName) { return m_lock(vFilePathName, false, -1); }
+    // take only the byte vByte of the lock file if free,
+    // so one lock file holds many independent locks
+    bool tryLockByte(const std::string& vFilePathName, const int64_t vByte) { return m_lock(vFilePathName, false, vByte); }
+    // the last failed try was on a lock owned by another, not on an error
+    bool wasBusy() const { return m_busy; }
+    // the lock file is not removed, another process can wait on it
+    void unlock() {
+#ifdef WINDOWS_OS
+        if (m_handle != INVALID_HANDLE_VALUE) {
+            OVERLAPPED overlapped = {};
+            if (m_byte < 0) {
+                UnlockFileEx(m_handle, 0, MAXDWORD, MAXDWORD, &overlapped);
+            } else {
+                overlapped.Offset = static_cast<DWORD>(m_byte);
+                overlapped.OffsetHigh = static_cast<DWORD>(m_byte >> 32);
+                UnlockFileEx(m_handle, 0, 1, 0, &overlapped);
+            }
+            CloseHandle(m_handle);
+            m_handle = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (m_fd >= 0) {
+            if (m_byte < 0) {
+                flock(m_fd, LOCK_UN);
+            }  // the byte lock is released by the close
+            close(m_fd);
+            m_fd = -1;
+        }
+#endif
+        m_byte = -1;
+    }
+    bool isLocked() const {
+#ifdef WINDOWS_OS
+        return m_handle != INVALID_HANDLE_VALUE;
+#else
+        return m_fd >= 0;
+#endif
+    }
+
+private:
+    bool m_lock(const std::string& vFilePathName, const bool vWait, const int64_t vByte) {
+        unlock();
+        m_busy = false;
+        const std::string lockFile = vFilePathName + ".lock";
+#ifdef WINDOWS_OS
+        m_handle = CreateFileA(lockFile.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_handle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        OVERLAPPED overlapped = {};
+        DWORD flags = LOCKFILE_EXCLUSIVE_LOCK;
+        if (!vWait) {
+            flags |= LOCKFILE_FAIL_IMMEDIATELY;
+        }
+        BOOL locked = FALSE;
+        if (vByte < 0) {
+            locked = LockFileEx(m_handle, flags, 0, MAXDWORD, MAXDWORD, &overlapped);
+        } else {
+            overlapped.Offset = static_cast<DWORD>(vByte);
+            overlapped.OffsetHigh = static_cast<DWORD>(vByte >> 32);
+            locked = LockFileEx(m_handle, flags, 0, 1, 0, &overlapped);
+        }
+        if (!locked) {
+            m_busy = (GetLastError() == ERROR_LOCK_VIOLATION);
+            CloseHandle(m_handle);
+            m_handle = INVALID_HANDLE_VALUE;
+            return false;
+        }
+#else
+        m_fd = open(lockFile.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd < 0) {
+            return false;
+        }
+        int ret = 0;
+        if (vByte < 0) {
+            while ((ret = flock(m_fd, vWait ? LOCK_EX : (LOCK_EX | LOCK_NB))) != 0 && errno == EINTR) {
+            }
+        } else {
+            struct flock range = {};
+            range.l_type = F_WRLCK;
+            range.l_whence = SEEK_SET;
+            range.l_start = static_cast<off_t>(vByte);
+            range.l_len = 1;
+#ifdef F_OFD_SETLK
+            // owned by this open file, so two owners of a same process are exclusive too
+            ret = fcntl(m_fd, vWait ? F_OFD_SETLKW : F_OFD_SETLK, &range);
+#else
+            ret = fcntl(m_fd, vWait ? F_SETLKW : F_SETLK, &range);
+#endif
+        }
+        if (ret != 0) {
+            m_busy = (errno == EWOULDBLOCK || errno == EAGAIN || errno == EACCES);
+            close(m_fd);
+            m_fd = -1;
+            return false;
+        }
+#endif
+        m_byte = vByte;
+        return true;
+    }
+};
+
+}  // namespace ez
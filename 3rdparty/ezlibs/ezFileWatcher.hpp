@@ -0,0 +1,164 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezFileWatcher is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// block until some watched files changed (inotify, linux only)
+
+#include "ezOS.hpp"
+
+#ifdef LINUX_OS
+#include <poll.h>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <map>
+#include <set>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace ez {
+
+class FileWatcher {
+private:
+    int m_fd = -1;
+    std::map<int, std::string> m_dirs;  // watch descriptor, directory
+    std::set<std::string> m_files;  // watched files as 'dir/name'
+
+public:
+    FileWatcher() {
+#ifdef LINUX_OS
+        m_fd = inotify_init1(IN_CLOEXEC);
+#endif
+    }
+    ~FileWatcher() {
+#ifdef LINUX_OS
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+#endif
+    }
+    bool isValid() const { return m_fd >= 0; }
+    // the directory is watched, not the file,
+    // so the editors who replace the file by a rename are seen too
+    bool addFile(const std::string& vFilePathName) {
+#ifdef LINUX_OS
+        if (m_fd < 0 || vFilePathName.empty()) {
+            return false;
+        }
+        std::string dir = ".";
+        std::string name = vFilePathName;
+        const auto pos = vFilePathName.find_last_of('/');
+        if (pos != std::string::npos) {
+            dir = (pos == 0) ? "/" : vFilePathName.substr(0, pos);
+            name = vFilePathName.substr(pos + 1);
+        }
+        const int wd = inotify_add_watch(m_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+        if (wd < 0) {
+            return false;
+        }
+        m_dirs[wd] = dir;
+        m_files.insert(dir + "/" + name);
+        return true;
+#else
+        (void)vFilePathName;
+        return false;
+#endif
+    }
+    // block without cpu use until a watched file change,
+    // then wait until no event come during vDebounceMs for group the bursts.
+    // return false if the watch is not possible
+    bool wait(std::vector<std::string>& vOutChangedFiles, const int32_t vDebounceMs) {
+        vOutChangedFiles.clear();
+#ifdef LINUX_OS
+        if (m_fd < 0 || m_files.empty()) {
+            return false;
+        }
+        std::set<std::string> changed;
+        int32_t timeout = -1;  // infinite until the first relevant event
+        std::chrono::steady_clock::time_point quietEnd;  // end of the debounce delay
+        while (true) {
+            pollfd pfd{m_fd, POLLIN, 0};
+            const int ret = poll(&pfd, 1, timeout);
+            if (ret < 0) {
+                if (errno != EINTR) {
+                    return false;
+                }
+                // a signal handled by the process, the watch goes on with the rest of the debounce delay
+                if (timeout >= 0) {
+                    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(quietEnd - std::chrono::steady_clock::now()).count();
+                    timeout = static_cast<int32_t>(std::max<int64_t>(left, 0));
+                }
+                continue;
+            }
+            if (ret == 0) {
+                break;  // quiet during the debounce delay
+            }
+            m_readEvents(changed);
+            if (!changed.empty()) {
+                timeout = vDebounceMs;
+                quietEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(vDebounceMs);
+            }
+        }
+        vOutChangedFiles.assign(changed.begin(), changed.end());
+        return true;
+#else
+        (void)vDebounceMs;
+        return false;
+#endif
+    }
+
+private:
+#ifdef LINUX_OS
+    void m_readEvents(std::set<std::string>& vInOutChanged) {
+        alignas(inotify_event) char buffer[4096];
+        const auto len = read(m_fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < len;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            if (event->mask & IN_Q_OVERFLOW) {
+                // the queue was full and some events are lost, so all the files are reported as changed
+                vInOutChanged.insert(m_files.begin(), m_files.end());
+                continue;
+            }
+            const auto it = m_dirs.find(event->wd);
+            if (it != m_dirs.end() && event->len > 0) {
+                const auto file = it->second + "/" + event->name;
+                if (m_files.find(file) != m_files.end()) {
+                    vInOutChanged.insert(file);
+                }
+            }
+        }
+    }
+#endif
+};
+
+}  // namespace ez
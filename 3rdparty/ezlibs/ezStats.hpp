@@ -0,0 +1,449 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezStats is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+// per phase timings and counters of a process, emitted as one json line,
+// the allocations, total and per phase, if EZ_STATS_ALLOCATIONS is defined (the app must count them in its operator new/delete),
+// and the spans of the phases in the chrome trace event format (chrome://tracing, ui.perfetto.dev).
+// include it before ezBuildInc.hpp, ezFigFont.hpp and ezArgs.hpp for enable their stats
+
+#include "ezOS.hpp"
+
+#ifdef WINDOWS_OS
+#include <process.h>
+#else
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+
+#include "ezFileLock.hpp"
+
+#ifndef EZ_STATS
+#define EZ_STATS
+#endif  // EZ_STATS
+
+#define EZ_STATS_CONCAT_IMPL(a, b) a##b
+#define EZ_STATS_CONCAT(a, b) EZ_STATS_CONCAT_IMPL(a, b)
+// time the rest of the current scope in a phase
+#define EZ_STATS_SCOPE(phase) ez::Stats::Scope EZ_STATS_CONCAT(ezStatsScope, __LINE__)(ez::Stats::Phase::phase)
+// a span of the trace only, not a phase of the stats
+#define EZ_STATS_SPAN(category, name) ez::Stats::Scope EZ_STATS_CONCAT(ezStatsScope, __LINE__)(category, name)
+#define EZ_STATS_ADD(counter, value) ez::Stats::get().add(ez::Stats::Counter::counter, static_cast<int64_t>(value))
+
+namespace ez {
+
+class Stats {
+public:
+    typedef std::chrono::steady_clock Clock;
+    enum class Phase { Startup = 0, Args, Read, Parse, FigFont, Render, Write, Fsync, Count };
+    enum class Counter { BytesRead = 0, BytesWritten, FilesRead, FilesWritten, Allocations, AllocatedBytes, LabelCacheHits, LabelCacheMisses, Count };
+
+    class Scope {
+    private:
+        Phase m_phase = Phase::Count;  // Count for a span of the trace only
+        const char* m_category = nullptr;
+        const char* m_name = nullptr;
+        Clock::time_point m_start;
+        int64_t m_startUs = 0;
+        bool m_running = false;
+#ifdef EZ_STATS_ALLOCATIONS
+        Phase m_parentPhase = Phase::Count;
+#endif  // EZ_STATS_ALLOCATIONS
+
+    public:
+        explicit Scope(const Phase vPhase) : m_phase(vPhase), m_category(getPhaseCategory(vPhase)), m_name(getPhaseName(vPhase)) {
+            m_begin(get().isEnabled() || get().isTraceEnabled());
+        }
+        Scope(const char* vCategory, const char* vName) : m_category(vCategory), m_name(vName) {  //
+            m_begin(get().isTraceEnabled());
+        }
+        ~Scope() { stop(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        // end the phase before the end of the scope
+        void stop() {
+            if (m_running) {
+                m_running = false;
+#ifdef EZ_STATS_ALLOCATIONS
+                if (m_phase != Phase::Count) {
+                    m_currentPhase() = m_parentPhase;
+                }
+#endif  // EZ_STATS_ALLOCATIONS
+                const auto duration = Clock::now() - m_start;
+                if (m_phase != Phase::Count) {
+                    get().addTime(m_phase, duration);
+                }
+                get().addSpan(m_category, m_name, m_startUs, duration);
+            }
+        }
+
+    private:
+        void m_begin(const bool vEnabled) {
+            if (vEnabled) {
+#ifdef EZ_STATS_ALLOCATIONS
+                if (m_phase != Phase::Count) {  // the allocations are counted in the innermost phase
+                    m_parentPhase = m_currentPhase();
+                    m_currentPhase() = m_phase;
+                }
+#endif  // EZ_STATS_ALLOCATIONS
+                m_startUs = m_getWallUs();
+                m_start = Clock::now();
+                m_running = true;
+            }
+        }
+    };
+
+private:
+    struct Span {
+        const char* category;
+        const char* name;
+        int64_t startUs;  // wall clock, so the spans of many processes can be merged
+        int64_t durationNs;
+        int64_t threadId;
+    };
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_traceEnabled{false};
+    Clock::time_point m_origin;  // static initialization of the process
+    int64_t m_originUs = 0;
+    std::array<std::atomic<int64_t>, static_cast<size_t>(Phase::Count)> m_phaseNs{};
+    std::array<std::atomic<int64_t>, static_cast<size_t>(Phase::Count)> m_phaseCalls{};
+    std::array<std::atomic<int64_t>, static_cast<size_t>(Counter::Count)> m_counters{};
+#ifdef EZ_STATS_ALLOCATIONS
+    std::array<std::atomic<int64_t>, static_cast<size_t>(Phase::Count)> m_phaseAllocations{};
+    std::array<std::atomic<int64_t>, static_cast<size_t>(Phase::Count)> m_phaseAllocatedBytes{};
+    std::atomic<int64_t> m_frees{0};
+#endif  // EZ_STATS_ALLOCATIONS
+    std::mutex m_spansMutex;
+    std::vector<Span> m_spans;
+    std::string m_processName = "BuildInc";
+
+public:
+    static Stats& get() {
+        static Stats stats;
+        return stats;
+    }
+    static const char* getPhaseName(const Phase vPhase) {
+        static const char* names[] = {"startup", "args", "read", "parse", "figfont", "render", "write", "fsync"};
+        return names[static_cast<size_t>(vPhase)];
+    }
+    // the lib doing the phase, for the trace
+    static const char* getPhaseCategory(const Phase vPhase) {
+        switch (vPhase) {
+            case Phase::Args: return "Args";
+            case Phase::FigFont: return "FigFont";
+            default: return "BuildInc";
+        }
+    }
+    static const char* getCounterName(const Counter vCounter) {
+        static const char* names[] = {"bytesRead", "bytesWritten", "filesRead", "filesWritten", "allocations", "allocatedBytes", "labelCacheHits", "labelCacheMisses"};
+        return names[static_cast<size_t>(vCounter)];
+    }
+    // the allocations are counted even if disabled, so the count of the startup is right.
+    // called by the global operator new of the app
+    static void countAllocation(const size_t vSize) {
+        auto& stats = get();
+        stats.m_counters[static_cast<size_t>(Counter::Allocations)].fetch_add(1, std::memory_order_relaxed);
+        stats.m_counters[static_cast<size_t>(Counter::AllocatedBytes)].fetch_add(static_cast<int64_t>(vSize), std::memory_order_relaxed);
+#ifdef EZ_STATS_ALLOCATIONS
+        const auto phase = static_cast<size_t>(m_currentPhase());
+        if (phase < static_cast<size_t>(Phase::Count)) {
+            stats.m_phaseAllocations[phase].fetch_add(1, std::memory_order_relaxed);
+            stats.m_phaseAllocatedBytes[phase].fetch_add(static_cast<int64_t>(vSize), std::memory_order_relaxed);
+        }
+#endif  // EZ_STATS_ALLOCATIONS
+    }
+#ifdef EZ_STATS_ALLOCATIONS
+    // called by the global operator delete of the app
+    static void countFree() { get().m_frees.fetch_add(1, std::memory_order_relaxed); }
+    int64_t getPhaseAllocations(const Phase vPhase) const { return m_phaseAllocations[static_cast<size_t>(vPhase)].load(); }
+#endif  // EZ_STATS_ALLOCATIONS
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    bool isTraceEnabled() const { return m_traceEnabled.load(std::memory_order_relaxed); }
+    // the startup phase is the time from the static initialization to the enabling
+    Stats& setEnabled(const bool vFlag) {
+        if (vFlag && !isEnabled()) {
+            addTime(Phase::Startup, Clock::now() - m_origin);
+        }
+        m_enabled = vFlag;
+        return *this;
+    }
+    Stats& setTraceEnabled(const bool vFlag) {
+        if (vFlag && !isTraceEnabled()) {
+            m_traceEnabled = true;
+            addSpan(getPhaseCategory(Phase::Startup), getPhaseName(Phase::Startup), m_originUs, Clock::now() - m_origin);
+        }
+        m_traceEnabled = vFlag;
+        return *this;
+    }
+    // name of the process in the trace
+    Stats& setProcessName(const std::string& vName) {
+        m_processName = vName;
+        return *this;
+    }
+    void addTime(const Phase vPhase, const Clock::duration vDuration) {
+        const auto idx = static_cast<size_t>(vPhase);
+        m_phaseNs[idx].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(vDuration).count(), std::memory_order_relaxed);
+        m_phaseCalls[idx].fetch_add(1, std::memory_order_relaxed);
+    }
+    void addSpan(const char* vCategory, const char* vName, const int64_t vStartUs, const Clock::duration vDuration) {
+        if (isTraceEnabled()) {
+            const auto durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(vDuration).count();
+            std::lock_guard<std::mutex> lock(m_spansMutex);
+            m_spans.push_back(Span{vCategory, vName, vStartUs, durationNs, m_getThreadId()});
+        }
+    }
+    void add(const Counter vCounter, const int64_t vValue) {
+        if (isEnabled()) {
+            m_counters[static_cast<size_t>(vCounter)].fetch_add(vValue, std::memory_order_relaxed);
+        }
+    }
+    int64_t getPhaseNs(const Phase vPhase) const { return m_phaseNs[static_cast<size_t>(vPhase)].load(); }
+    int64_t getCounter(const Counter vCounter) const { return m_counters[static_cast<size_t>(vCounter)].load(); }
+
+    // one json object on one line, so many runs can be appended in a json lines file
+    std::string getJson() const {
+        const auto totalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_origin).count();
+        const auto timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string ret;
+        ret.reserve(512);
+        ret += "{\"pid\":" + std::to_string(m_getProcessId());
+        ret += ",\"timeMs\":" + std::to_string(timeMs);
+        ret += ",\"totalNs\":" + std::to_string(totalNs);
+        ret += ",\"phases\":{";
+        for (size_t i = 0; i < static_cast<size_t>(Phase::Count); ++i) {
+            ret += (i > 0) ? "," : "";
+            ret += "\"" + std::string(getPhaseName(static_cast<Phase>(i))) + "\":{\"ns\":" + std::to_string(m_phaseNs[i].load()) +  //
+                ",\"calls\":" + std::to_string(m_phaseCalls[i].load());
+#ifdef EZ_STATS_ALLOCATIONS
+            ret += ",\"allocations\":" + std::to_string(m_phaseAllocations[i].load()) +  //
+                ",\"allocatedBytes\":" + std::to_string(m_phaseAllocatedBytes[i].load());
+#endif  // EZ_STATS_ALLOCATIONS
+            ret += "}";
+        }
+        ret += "}";
+        for (size_t i = 0; i < static_cast<size_t>(Counter::Count); ++i) {
+#ifndef EZ_STATS_ALLOCATIONS
+            if (i == static_cast<size_t>(Counter::Allocations) || i == static_cast<size_t>(Counter::AllocatedBytes)) {
+                continue;  // not counted without the operator new of the app
+            }
+#endif  // EZ_STATS_ALLOCATIONS
+            ret += ",\"" + std::string(getCounterName(static_cast<Counter>(i))) + "\":" + std::to_string(m_counters[i].load());
+        }
+#ifdef EZ_STATS_ALLOCATIONS
+        ret += ",\"frees\":" + std::to_string(m_frees.load());
+#endif  // EZ_STATS_ALLOCATIONS
+        ret += "}\n";
+        return ret;
+    }
+    // append the json line to a file shared by many processes.
+    // the line is written by one call under a lock, so the lines are never interleaved
+    bool appendTo(const std::string& vFilePathName) const {
+        return m_appendLocked(vFilePathName, getJson(), {});
+    }
+
+    // the trace events of the process, one object per line, each line ended by a ','
+    std::string getTraceEvents() {
+        const auto pid = std::to_string(m_getProcessId());
+        std::string ret;
+        ret += "{\"name\":\"process_name\",\"ph\":\"M\",\"ts\":0,\"pid\":" + pid + ",\"tid\":0,\"args\":{\"name\":\"" + m_escapeJson(m_processName) + "\"}},\n";
+        std::lock_guard<std::mutex> lock(m_spansMutex);
+        for (const auto& span : m_spans) {
+            ret += "{\"name\":\"" + std::string(span.name) + "\",\"cat\":\"" + span.category + "\",\"ph\":\"X\",\"ts\":" + std::to_string(span.startUs) +
+                ",\"dur\":" + std::to_string(span.durationNs / 1000) + "." + m_threeDigits(span.durationNs % 1000) + ",\"pid\":" + pid +
+                ",\"tid\":" + std::to_string(span.threadId) + "},\n";
+        }
+        return ret;
+    }
+    // a directory receive one shard file per process, without lock.
+    // else the events are appended to the file under a lock.
+    // the file is a json array without the closing ']', chrome and perfetto can open it as is
+    bool writeTrace(const std::string& vPath) {
+        const auto events = getTraceEvents();
+        if (m_isDirectory(vPath)) {
+            std::random_device rd;
+            const auto shardFile = vPath + "/" + std::to_string(m_getProcessId()) + "." + std::to_string(rd()) + ".trace";
+            std::FILE* fp = std::fopen(shardFile.c_str(), "wb");
+            if (fp == nullptr) {
+                return false;
+            }
+            const bool ret = (std::fwrite(events.data(), 1, events.size(), fp) == events.size());
+            return (std::fclose(fp) == 0) && ret;
+        }
+        return m_appendLocked(vPath, events, "[\n");
+    }
+    // merge a trace file or a directory of shards in one trace sorted by time
+    static bool mergeTrace(const std::string& vInput, const std::string& vOutput) {
+        std::vector<std::string> files;
+        if (m_isDirectory(vInput)) {
+            m_listTraceFiles(vInput, files);
+        } else {
+            files.push_back(vInput);
+        }
+        std::vector<std::pair<int64_t, std::string>> events;
+        std::string line;
+        for (const auto& file : files) {
+            std::ifstream stream(file, std::ios::in | std::ios::binary);
+            while (std::getline(stream, line)) {
+                while (!line.empty() && (line.back() == '\r' || line.back() == ',' || line.back() == ' ')) {
+                    line.pop_back();
+                }
+                if (line.size() < 2 || line.front() != '{') {
+                    continue;  // '[', ']' or empty
+                }
+                int64_t ts = 0;
+                const auto pos = line.find("\"ts\":");
+                if (pos != std::string::npos) {
+                    ts = std::strtoll(line.c_str() + pos + 5, nullptr, 10);
+                }
+                events.emplace_back(ts, line);
+            }
+        }
+        std::stable_sort(events.begin(), events.end(), [](const std::pair<int64_t, std::string>& a, const std::pair<int64_t, std::string>& b) { return a.first < b.first; });
+        std::ofstream out(vOutput, std::ios::out | std::ios::binary);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << "{\"traceEvents\":[\n";
+        for (size_t i = 0; i < events.size(); ++i) {
+            out << events[i].second << ((i + 1 < events.size()) ? ",\n" : "\n");
+        }
+        out << "],\"displayTimeUnit\":\"ms\"}\n";
+        return out.good();
+    }
+
+private:
+    Stats() : m_origin(Clock::now()), m_originUs(m_getWallUs()) {}
+    static int64_t m_getWallUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    static int64_t m_getProcessId() {
+#ifdef WINDOWS_OS
+        return static_cast<int64_t>(_getpid());
+#else
+        return static_cast<int64_t>(getpid());
+#endif
+    }
+#ifdef EZ_STATS_ALLOCATIONS
+    static Phase& m_currentPhase() {
+        thread_local Phase phase = Phase::Count;
+        return phase;
+    }
+#endif  // EZ_STATS_ALLOCATIONS
+    static int64_t m_getThreadId() {
+        static std::atomic<int64_t> s_nextId{0};
+        thread_local int64_t id = s_nextId++;
+        return id;
+    }
+    static std::string m_threeDigits(const int64_t vNumber) {
+        std::string ret = std::to_string(vNumber);
+        return std::string(3 - ret.size(), '0') + ret;
+    }
+    static std::string m_escapeJson(const std::string& vStr) {
+        std::string ret;
+        for (const auto c : vStr) {
+            if (c == '"' || c == '\\') {
+                ret += '\\';
+            }
+            ret += c;
+        }
+        return ret;
+    }
+    // vHeader is written first if the file is empty
+    static bool m_appendLocked(const std::string& vFilePathName, const std::string& vContent, const std::string& vHeader) {
+        FileLock lock(vFilePathName);
+        std::FILE* fp = std::fopen(vFilePathName.c_str(), "ab");
+        if (fp == nullptr) {
+            return false;
+        }
+        std::string content = vContent;
+        if (!vHeader.empty() && std::fseek(fp, 0, SEEK_END) == 0 && std::ftell(fp) == 0) {
+            content = vHeader + vContent;
+        }
+        const bool ret = (std::fwrite(content.data(), 1, content.size(), fp) == content.size());
+        return (std::fclose(fp) == 0) && ret;
+    }
+    static bool m_isDirectory(const std::string& vPath) {
+#ifdef WINDOWS_OS
+        const DWORD attributes = GetFileAttributesA(vPath.c_str());
+        return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+        struct stat st;
+        return stat(vPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+    }
+    static void m_listTraceFiles(const std::string& vDir, std::vector<std::string>& vOutFiles) {
+        static const std::string ext = ".trace";
+        const auto isTrace = [](const std::string& vName) {  //
+            return vName.size() > ext.size() && vName.compare(vName.size() - ext.size(), ext.size(), ext) == 0;
+        };
+#ifdef WINDOWS_OS
+        WIN32_FIND_DATAA data;
+        HANDLE handle = FindFirstFileA((vDir + "\\*").c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        do {
+            if (isTrace(data.cFileName)) {
+                vOutFiles.push_back(vDir + "/" + data.cFileName);
+            }
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+#else
+        DIR* dir = opendir(vDir.c_str());
+        if (dir == nullptr) {
+            return;
+        }
+        while (const auto* ent = readdir(dir)) {
+            if (isTrace(ent->d_name)) {
+                vOutFiles.push_back(vDir + "/" + ent->d_name);
+            }
+        }
+        closedir(dir);
+#endif
+        std::sort(vOutFiles.begin(), vOutFiles.end());
+    }
+};
+
+// set the origin of the startup phase during the static initialization
+static const Stats& ezStatsOrigin = Stats::get();
+
+}  // namespace ez
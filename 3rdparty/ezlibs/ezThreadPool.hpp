@@ -0,0 +1,202 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezThreadPool is part of the ezLibs project : https://github.com/aiekick/ezLibs.git
+
+/* Work stealing thread pool
+ each worker own a deque :
+ - a worker push and pop its own tasks at the back (the last task is hot in cache)
+ - an idle worker steal the oldest task at the front of the deque of another worker
+ so the uneven tasks are balanced without a static split
+*/
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+namespace ez {
+
+class ThreadPool {
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_queuedTasks{0};  // in the deques
+    std::atomic<size_t> m_pendingTasks{0};  // queued or running
+    std::atomic<size_t> m_nextWorker{0};  // round robin for the tasks submitted from outside
+    std::atomic<bool> m_stop{false};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCv;
+    std::mutex m_doneMutex;
+    std::condition_variable m_doneCv;
+
+public:
+    // 0 : all the cores
+    explicit ThreadPool(size_t vThreadCount = 0) {
+        if (vThreadCount == 0) {
+            vThreadCount = std::thread::hardware_concurrency();
+        }
+        if (vThreadCount == 0) {
+            vThreadCount = 1;
+        }
+        m_workers.reserve(vThreadCount);
+        for (size_t i = 0; i < vThreadCount; ++i) {
+            m_workers.emplace_back(new Worker());
+        }
+        m_threads.reserve(vThreadCount);
+        for (size_t i = 0; i < vThreadCount; ++i) {
+            m_threads.emplace_back(&ThreadPool::m_run, this, i);
+        }
+    }
+    ~ThreadPool() {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop = true;
+        }
+        m_sleepCv.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getThreadCount() const { return m_workers.size(); }
+
+    // index of the worker running the current task, -1 outside of the pool
+    static int32_t getWorkerIndex() { return m_currentWorker().second; }
+
+    // a task submitted from a worker go in its own deque, else in the deques by round robin
+    void submit(Task vTask) {
+        ++m_pendingTasks;
+        const auto& current = m_currentWorker();
+        size_t idx = 0;
+        if (current.first == this && current.second >= 0) {
+            idx = static_cast<size_t>(current.second);
+        } else {
+            idx = m_nextWorker++ % m_workers.size();
+        }
+        {  // counted before to be pushed, so a worker never see more tasks than counted
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            ++m_queuedTasks;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_workers[idx]->mutex);
+            m_workers[idx]->tasks.push_back(std::move(vTask));
+        }
+        m_sleepCv.notify_one();
+    }
+
+    // wait until all the tasks are done, the tasks added by the tasks included.
+    // must not be called from a task
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_doneMutex);
+        m_doneCv.wait(lock, [this]() { return m_pendingTasks == 0; });
+    }
+
+    // one task per index, then wait
+    template <typename TFUNCTOR>
+    void parallelFor(const size_t vCount, TFUNCTOR vFunctor) {
+        for (size_t i = 0; i < vCount; ++i) {
+            submit([i, &vFunctor]() { vFunctor(i); });
+        }
+        wait();
+    }
+
+private:
+    static std::pair<ThreadPool*, int32_t>& m_currentWorker() {
+        thread_local std::pair<ThreadPool*, int32_t> current{nullptr, -1};
+        return current;
+    }
+
+    bool m_popLocal(const size_t vIdx, Task& vOutTask) {
+        auto& worker = *m_workers[vIdx];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        vOutTask = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool m_steal(const size_t vIdx, Task& vOutTask) {
+        const size_t count = m_workers.size();
+        for (size_t i = 1; i < count; ++i) {
+            auto& victim = *m_workers[(vIdx + i) % count];
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (lock.owns_lock() && !victim.tasks.empty()) {
+                vOutTask = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void m_run(const size_t vIdx) {
+        m_currentWorker() = std::make_pair(this, static_cast<int32_t>(vIdx));
+        Task task;
+        while (true) {
+            if (m_popLocal(vIdx, task) || m_steal(vIdx, task)) {
+                --m_queuedTasks;
+                task();
+                task = nullptr;
+                if (--m_pendingTasks == 0) {
+                    std::lock_guard<std::mutex> lock(m_doneMutex);
+                    m_doneCv.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            if (m_stop) {
+                break;
+            }
+            // a failed try_lock or a task not yet pushed can be missed, so we retry without sleeping
+            if (m_queuedTasks > 0) {
+                lock.unlock();
+                std::this_thread::yield();
+            } else {
+                m_sleepCv.wait(lock, [this]() { return m_stop || m_queuedTasks > 0; });
+            }
+        }
+    }
+};
+
+}  // namespace ez
@@ -22,31 +22,507 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <ezlibs/ezStats.hpp>
 #include <ezlibs/ezApp.hpp>
 #include <ezlibs/ezArgs.hpp>
 #include <ezlibs/ezFigFont.hpp>
 #include <ezlibs/ezBuildInc.hpp>
+#include <ezlibs/ezBuildLease.hpp>
+#include <ezlibs/ezBuildScan.hpp>
+#include <ezlibs/ezBuildInspect.hpp>
+#include <ezlibs/ezFileWatcher.hpp>
+
+#include <memory>
+
+#ifdef WINDOWS_OS
+#include <process.h>
+#define getProcessId _getpid
+#else
+#define getProcessId getpid
+#endif
+
+#ifdef EZ_STATS_ALLOCATIONS
+#include <new>
+#include <cstdlib>
+
+// the free is kept out of the inlined operators, else gcc warns with -Wmismatched-new-delete
+#if defined(_MSC_VER)
+#define NOINLINE_DEALLOCATE __declspec(noinline)
+#else
+#define NOINLINE_DEALLOCATE __attribute__((noinline))
+#endif
+
+// counted for the stats per phase, a few relaxed atomic adds per allocation when --stats is off.
+// all the forms are replaced so each new is paired with its delete
+static void* allocate(std::size_t vSize) noexcept {
+    ez::Stats::countAllocation(vSize);
+    return std::malloc(vSize != 0 ? vSize : 1);
+}
+static NOINLINE_DEALLOCATE void deallocate(void* vPtr) noexcept {
+    if (vPtr != nullptr) {
+        ez::Stats::countFree();
+        std::free(vPtr);
+    }
+}
+void* operator new(std::size_t vSize) {
+    if (void* ptr = allocate(vSize)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t vSize) {
+    return operator new(vSize);
+}
+void* operator new(std::size_t vSize, const std::nothrow_t&) noexcept {
+    return allocate(vSize);
+}
+void* operator new[](std::size_t vSize, const std::nothrow_t&) noexcept {
+    return allocate(vSize);
+}
+void operator delete(void* vPtr) noexcept {
+    deallocate(vPtr);
+}
+void operator delete[](void* vPtr) noexcept {
+    deallocate(vPtr);
+}
+void operator delete(void* vPtr, std::size_t) noexcept {
+    deallocate(vPtr);
+}
+void operator delete[](void* vPtr, std::size_t) noexcept {
+    deallocate(vPtr);
+}
+void operator delete(void* vPtr, const std::nothrow_t&) noexcept {
+    deallocate(vPtr);
+}
+void operator delete[](void* vPtr, const std::nothrow_t&) noexcept {
+    deallocate(vPtr);
+}
+#endif  // EZ_STATS_ALLOCATIONS
+
+// emit the stats and the trace at the end of main, whatever the return path
+class StatsReport {
+private:
+    ez::Args& m_args;
+
+public:
+    explicit StatsReport(ez::Args& vArgs) : m_args(vArgs) {}
+    ~StatsReport() {
+        if (ez::Stats::get().isEnabled()) {
+            const auto file = m_args.getValue<std::string>("stats");
+            if (file.empty()) {
+                std::cout << ez::Stats::get().getJson();
+            } else {
+                ez::Stats::get().appendTo(file);
+            }
+        }
+        if (ez::Stats::get().isTraceEnabled()) {
+            ez::Stats::get().writeTrace(m_args.getValue<std::string>("trace"));
+        }
+    }
+};
+
+// --label-cache=<dir>, --label-cache for the cache of the user, else BUILDINC_LABEL_CACHE (a directory shared by the CI jobs)
+static std::string getLabelCacheDir(ez::Args& vArgs) {
+    if (vArgs.isPresent("label-cache")) {
+        const auto dir = vArgs.getValue<std::string>("label-cache");
+        return dir.empty() ? ez::FigFontCache::getDefaultDirectory() : dir;
+    }
+    const char* dir = std::getenv("BUILDINC_LABEL_CACHE");
+    return (dir != nullptr) ? std::string(dir) : std::string();
+}
+
+static uint64_t getLabelCacheSize(ez::Args& vArgs) {
+    return static_cast<uint64_t>(vArgs.getValue<size_t>("label-cache-size")) * 1024U * 1024U;
+}
+
+// set the parts of the builder given by the command line, the same for each generation
+static void setupBuilder(ez::Args& vArgs, ez::BuildInc& vBuilder, const std::string& vProject, const std::string& vLabel) {
+    vBuilder.setSync(vArgs.isPresent("fsync")).setReproducible(vArgs.isPresent("reproducible"));
+    if (vArgs.isPresent("marker")) {
+        vBuilder.setMarker(true);
+    }
+    vBuilder.setLabelCache(getLabelCacheDir(vArgs), getLabelCacheSize(vArgs));
+    vBuilder.setProject(vProject).setLabel(vLabel).setFigFontFile(vArgs.getValue<std::string>("figfont"));
+    const std::pair<const char*, ez::BuildInc::OutputFormat> outputs[] = {
+        {"json", ez::BuildInc::OutputFormat::Json},
+        {"cmake", ez::BuildInc::OutputFormat::CMake},
+        {"env", ez::BuildInc::OutputFormat::Env},
+        {"python", ez::BuildInc::OutputFormat::Python},
+    };
+    for (const auto& output : outputs) {
+        if (vArgs.hasValue(output.first)) {
+            vBuilder.addOutput(output.second, vArgs.getValue<std::string>(output.first));
+        }
+    }
+    if (vArgs.hasValue("set")) {
+        for (const auto& field : ez::str::splitStringToVector(vArgs.getValue<std::string>("set"), ',')) {
+            const auto pos = field.find('=');
+            if (pos != std::string::npos) {
+                const auto key = field.substr(0, pos);
+                const auto value = field.substr(pos + 1);
+                int64_t number = 0;
+                if (ez::str::stringToNumber(value, number) && std::to_string(number) == value) {
+                    vBuilder.setField(key, value);
+                } else {
+                    vBuilder.setFieldString(key, value);
+                }
+            }
+        }
+    }
+    if (vArgs.hasValue("unset")) {
+        for (const auto& key : ez::str::splitStringToVector(vArgs.getValue<std::string>("unset"), ',')) {
+            vBuilder.removeField(key);
+        }
+    }
+}
+
+// the builders of the projects of the header, with the command line applied
+static std::vector<ez::BuildInc*> setupProjects(ez::Args& vArgs, ez::MultiBuildInc& vMulti, const std::vector<std::string>& vProjects) {
+    std::vector<ez::BuildInc*> ret;
+    for (const auto& project : vProjects) {
+        auto& builder = vMulti.getProject(project);
+        std::string label = vArgs.getValue<std::string>("label");
+        if (label.empty()) {
+            label = project;
+        }
+        setupBuilder(vArgs, builder, project, label);
+        ret.push_back(&builder);
+    }
+    return ret;
+}
+
+// one depfile for the header, with the files read by all the projects
+static bool writeDepFile(ez::Args& vArgs, const std::vector<ez::BuildInc*>& vBuilders) {
+    const auto depFile = vArgs.getValue<std::string>("depfile");
+    if (depFile.empty() || vBuilders.empty()) {
+        return true;
+    }
+    for (size_t idx = 1; idx < vBuilders.size(); ++idx) {
+        for (const auto& file : vBuilders.at(idx)->getReadFiles()) {
+            vBuilders.front()->addReadFile(file);
+        }
+    }
+    return vBuilders.front()->writeDepFile(depFile);
+}
+
+// stay resident and regenerate the outputs when the header or the figfont changed.
+// the build number is not incremented, and only the changed outputs are rewritten
+static int watch(ez::Args& vArgs, const std::vector<std::string>& vProjects, const std::string& vFile, const std::vector<std::string>& vReadFiles) {
+    ez::FileWatcher watcher;
+    bool ret = watcher.addFile(vFile);
+    for (const auto& file : vReadFiles) {
+        ret &= watcher.addFile(file);
+    }
+    const auto figFontFile = vArgs.getValue<std::string>("figfont");
+    if (!figFontFile.empty() && !ez::FigFont::isBuiltin(figFontFile)) {
+        ret &= watcher.addFile(figFontFile);  // even if not valid yet
+    }
+    if (!ret) {
+        std::cout << "watch mode not available" << std::endl;
+        return 1;
+    }
+    int32_t debounceMs = vArgs.getValue<int32_t>("watch-debounce");
+    if (debounceMs <= 0) {
+        debounceMs = 50;
+    }
+    std::vector<std::string> changedFiles;
+    while (watcher.wait(changedFiles, debounceMs)) {
+        ez::MultiBuildInc multi(vFile);
+        if (!multi.isLocked()) {
+            continue;
+        }
+        multi.setSync(vArgs.isPresent("fsync"));
+        const auto builders = setupProjects(vArgs, multi, vProjects);
+        multi.write();
+        writeDepFile(vArgs, builders);
+    }
+    return 1;
+}
+
+// a number of the lease of the node, above vFloor
+static bool allocateLeaseNumber(ez::Args& vArgs, const std::string& vProject, const std::string& vFile, const int64_t vFloor, int64_t& vOutBuildNumber) {
+    std::string nodeName = vArgs.getValue<std::string>("node");
+    if (nodeName.empty()) {
+        nodeName = ez::lease::getHostName();
+    }
+    ez::lease::Node node(vArgs.getValue<std::string>("lease"), vFile + ".lease", nodeName);
+    node.setSync(vArgs.isPresent("fsync"));
+    int64_t leaseSize = vArgs.getValue<int64_t>("lease-size");
+    if (leaseSize <= 0) {
+        leaseSize = 100;
+    }
+    return node.allocate(vProject, leaseSize, vFloor, vOutBuildNumber);
+}
+
+// the build number of --shard or --lease, allocated before the lock of the header from an unlocked read of it,
+// so the workers and the nodes don't wait each other on the header
+static bool allocateBuildNumber(ez::Args& vArgs, const std::string& vProject, const std::string& vFile, int64_t& vOutBuildNumber) {
+    std::string content;
+    ez::buildinc::readFile(vFile, content);
+    ez::MultiBuildInc snapshot(vFile, content);
+    const int64_t floor = snapshot.getProject(vProject).getBuildNumber();
+    if (vArgs.isPresent("shard")) {
+        const auto shard = ez::str::splitStringToVector(vArgs.getValue<std::string>("shard"), '/');
+        int64_t shardIdx = 0, shardCount = 0;
+        if (shard.size() != 2 || !ez::str::stringToNumber(shard.at(0), shardIdx) || !ez::str::stringToNumber(shard.at(1), shardCount)) {
+            return false;
+        }
+        ez::ShardBuildNumber sharder(vFile + ".shards", shardIdx, shardCount);
+        int64_t buildNumber = 0;
+        if (!sharder.next(floor, buildNumber)) {
+            return false;
+        }
+        // the header report the highest number committed by all the workers
+        vOutBuildNumber = std::max(buildNumber, sharder.getHighestCommitted());
+        return true;
+    }
+    return allocateLeaseNumber(vArgs, vProject, vFile, floor, vOutBuildNumber);
+}
+
+// update the projects of a header in one locked pass, the blocks of the other projects are kept
+static int updateProjects(ez::Args& vArgs, const std::string& vProjects, const std::string& vFile) {
+    const auto projects = ez::str::splitStringToVector(vProjects, ',');
+    if (projects.empty()) {
+        return 1;
+    }
+    const bool timeBased = (vArgs.getValue<std::string>("id-scheme") == "time");
+    const bool allocated = !timeBased && (vArgs.isPresent("shard") || vArgs.isPresent("lease"));
+    if (allocated && projects.size() != 1) {
+        std::cout << "--shard and --lease number one project" << std::endl;
+        return 1;
+    }
+    int64_t allocatedNumber = 0;
+    if (allocated && !allocateBuildNumber(vArgs, projects.front(), vFile, allocatedNumber)) {
+        return 1;
+    }
+    ez::FileLock nodeLock;  // held until the header is written
+    std::unique_ptr<ez::TimeBuildId> generator;
+    if (timeBased) {
+        const bool reproducible = vArgs.isPresent("reproducible");
+        int64_t nodeId = reproducible ? 0 : ez::TimeBuildId::getDefaultNode(ez::lease::getHostName(), getProcessId());
+        const bool givenNode = vArgs.hasValue("node-id");
+        if (givenNode) {
+            nodeId = vArgs.getValue<int64_t>("node-id");
+            if (nodeId < 0 || nodeId > ez::TimeBuildId::nodeMask) {
+                std::cout << "the node id must be in [0, " << ez::TimeBuildId::nodeMask << "]" << std::endl;
+                return 1;
+            }
+        }
+        int64_t sourceDateEpoch = 0;
+        const bool fixedTime = reproducible && ez::TimeBuildId::getSourceDateEpoch(sourceDateEpoch);
+        const auto nodeLockFile = ez::TimeBuildId::getNodeLockFile();
+        if (!fixedTime && !ez::TimeBuildId::claimNode(nodeLockFile, nodeId, givenNode, nodeLock, nodeId)) {
+            if (nodeLock.wasBusy()) {
+                std::cout << "the node " << nodeId << " is used by another process of this host" << std::endl;
+            } else {
+                std::cout << "failed to open the lock file of the nodes " << nodeLockFile << ".lock" << std::endl;
+            }
+            return 1;
+        }
+        generator.reset(new ez::TimeBuildId(nodeId));
+        if (fixedTime) {
+            generator->setFixedTime(sourceDateEpoch * 1000);
+        }
+    }
+    ez::MultiBuildInc multi(vFile);
+    if (!multi.isLocked()) {
+        return 1;
+    }
+    multi.setSync(vArgs.isPresent("fsync"));
+    const auto builders = setupProjects(vArgs, multi, projects);
+    for (auto* builder : builders) {
+        if (vArgs.hasValue("major")) {
+            builder->setMajor(vArgs.getValue<int32_t>("major"));
+        }
+        if (vArgs.hasValue("minor")) {
+            builder->setMinor(vArgs.getValue<int32_t>("minor"));
+        }
+        if (generator != nullptr) {
+            builder->setTimeBasedBuildNumber(*generator);
+        } else if (vArgs.isPresent("shard")) {
+            // the header is read again under the lock and never go back,
+            // a worker slower than the others to reach the lock keeps their higher number
+            builder->setBuildNumber(std::max(allocatedNumber, builder->getBuildNumber()));
+            builder->addReadFile(vFile + ".shards");
+        } else if (allocated) {
+            // the header is read again under the lock and never go back, a number passed by another node
+            // while this one was waiting the lock is replaced by the next one of the lease above the header
+            if (allocatedNumber <= builder->getBuildNumber() &&
+                !allocateLeaseNumber(vArgs, builder->getProject(), vFile, builder->getBuildNumber(), allocatedNumber)) {
+                return 1;
+            }
+            builder->setBuildNumber(allocatedNumber);
+            builder->addReadFile(vFile + ".lease");
+        } else {
+            builder->incBuildNumber();
+        }
+    }
+    if (generator != nullptr) {
+        generator->waitPastLastId();
+    }
+    bool ret = multi.write();
+    for (auto* builder : builders) {
+        builder->printInfos();
+    }
+    ret &= writeDepFile(vArgs, builders);
+    if (ret && vArgs.isPresent("watch")) {
+        std::vector<std::string> readFiles;
+        for (auto* builder : builders) {
+            const auto& files = builder->getReadFiles();
+            readFiles.insert(readFiles.end(), files.begin(), files.end());
+        }
+        multi.unlock();  // each generation of the watch lock the header again
+        return watch(vArgs, projects, vFile, readFiles);
+    }
+    return ret ? 0 : 1;
+}
 
 int main(int vArgc, char* vArgv[]) {
     ez::App app(vArgc, vArgv);
+    for (int i = 1; i < vArgc; ++i) {  // before the args parsing, for time it
+        if (std::strncmp(vArgv[i], "--stats", 7) == 0) {
+            ez::Stats::get().setEnabled(true);
+        } else if (std::strncmp(vArgv[i], "--trace=", 8) == 0) {
+            ez::Stats::get().setTraceEnabled(true);
+        }
+    }
+    ez::Stats::Scope argsScope(ez::Stats::Phase::Args);
     ez::Args args("BuidInc");
-    args.addPositional("project").help("prefix of the build id", "<project>");
+    args.addPositional("project").help("prefix of the build id, or many for a shared header", "<project[,project]>");
     args.addPositional("file").help("file of the build id", "<file>");
     args.addOptional("--label").help("label of the project", "<label>").delimiter(' ');
-    args.addOptional("-ff/--figfont").help("FigFont file; will add a FigFont based label", "<figfont>").delimiter(' ');
+    args.addOptional("-ff/--figfont").help("FigFont file or builtin:standard, builtin:term; will add a FigFont based label", "<figfont>").delimiter(' ');
+    args.addOptional("--label-cache").help("keep the FigFont labels in a cache, of the user or in a directory shared by the CI (or BUILDINC_LABEL_CACHE)", "[=<dir>]").delimiter('=');
+    args.addOptional("--label-cache-size").help("max size of the label cache, the least recently used labels are removed (default: 4)", "<MB>").delimiter(' ');
     args.addOptional("--no-help").help("will not print the help if the required arguments are not set", {});
-    if (args.parse(vArgc, vArgv)) {
-        std::string project = args.getValue<std::string>("project");
-        std::string label = args.getValue<std::string>("label");
-        if (label.empty()) {
-            label = project;
+    args.addOptional("--coordinator").help("run the build number allocator of the build farm", "<[host:]port>").delimiter(' ');
+    args.addOptional("--coordinator-state").help("state file of the allocator (default: BuildIncCoordinator.state)", "<file>").delimiter(' ');
+    args.addOptional("--lease").help("take the build number from a lease of the allocator", "<host:port>").delimiter(' ');
+    args.addOptional("--lease-size").help("count of build numbers asked per lease (default: 100)", "<count>").delimiter(' ');
+    args.addOptional("--node").help("name of this node for the allocator (default: host name)", "<name>").delimiter(' ');
+    args.addOptional("--release-lease").help("give back the unused part of the lease to the allocator", {});
+    args.addOptional("--id-scheme").help("counter (default) or time; time gives a sortable unique build number instead of the previous one", "<scheme>").delimiter(' ');
+    args.addOptional("--node-id").help("node of the time scheme, 0 to 16383, one per host (default: host name and process id, the next free node of the host)", "<id>").delimiter(' ');
+    args.addOptional("--shard").help("sharded numbering, worker k of K gives k, k+K, k+2K, ... without lock", "<k/K>").delimiter(' ');
+    args.addOptional("--depfile").help("write a make/ninja depfile of the files read", "<depfile>").delimiter(' ');
+    args.addOptional("--json").help("write also the build id in a json file", "<file>").delimiter(' ');
+    args.addOptional("--cmake").help("write also the build id in a cmake include file", "<file>").delimiter(' ');
+    args.addOptional("--env").help("write also the build id in a shell env file", "<file>").delimiter(' ');
+    args.addOptional("--python").help("write also the build id in a python module", "<file>").delimiter(' ');
+    args.addOptional("--scan").help("list all the build id files of a directory tree", "<root>").delimiter(' ');
+    args.addOptional("--scan-json").help("with --scan, print the result in json instead of a table", {});
+    args.addOptional("--bump-major").help("with --scan, increment the major number of all the files found", {});
+    args.addOptional("--bump-minor").help("with --scan, increment the minor number of all the files found", {});
+    args.addOptional("--bump-build").help("with --scan, increment the build number of all the files found", {});
+    args.addOptional("--compile-font").help("compile a FigFont in a binary font (default: <in>.bff), mapped at load, rebuilt when the .flf change. a .hpp output get the c++ tables of a builtin", "<in.flf[,out.bff|out.hpp]>").delimiter(' ');
+    args.addOptional("--marker").help("compile a marker of the build id in the binaries, kept in the header once added", {});
+    args.addOptional("--inspect").help("print the build ids found in a binary built with --marker", "<binary>").delimiter(' ');
+    args.addOptional("--no-io-uring").help("with --scan, use the blocking io instead of io_uring", {});
+    args.addOptional("--threads").help("count of threads (default: all the cores)", "<count>").delimiter(' ');
+    args.addOptional("--watch").help("stay resident and regenerate the outputs when the header or the figfont change", {});
+    args.addOptional("--watch-debounce").help("delay without change before to regenerate (default: 50)", "<ms>").delimiter(' ');
+    args.addOptional("--set").help("set user fields, the values not integers are quoted", "<key=value[,key=value]>").delimiter(' ');
+    args.addOptional("--unset").help("remove user fields", "<key[,key]>").delimiter(' ');
+    args.addOptional("--major").help("set the major number", "<number>").delimiter(' ');
+    args.addOptional("--minor").help("set the minor number", "<number>").delimiter(' ');
+    args.addOptional("--fsync").help("flush the written files on the disk", {});
+    args.addOptional("--reproducible").help("same bytes for the same state: SOURCE_DATE_EPOCH for the time scheme, node id 0 by default, normalized paths", {});
+    args.addOptional("--trace").help("write a chrome trace of the phases in a file shared by the builds, or one file per build in a directory", "=<file|dir>").delimiter('=');
+    args.addOptional("--trace-merge").help("merge a shared trace file or a directory of traces in one trace", "<file|dir>").delimiter(' ');
+    args.addOptional("--trace-out").help("with --trace-merge, the merged trace (default: <file|dir>.json)", "<file>").delimiter(' ');
+    args.addOptional("--stats").help("print the timings of each phase in json, or append them to a file", "[=<file>]").delimiter('=');
+    const bool parsed = args.parse(vArgc, vArgv);
+    argsScope.stop();
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    StatsReport statsReport(args);
+    if (args.isPresent("trace-merge")) {
+        const auto input = args.getValue<std::string>("trace-merge");
+        std::string output = args.getValue<std::string>("trace-out");
+        if (output.empty()) {
+            output = input + ".json";
+        }
+        return ez::Stats::mergeTrace(input, output) ? 0 : 1;
+    }
+    if (args.isPresent("coordinator")) {
+        std::string stateFile = args.getValue<std::string>("coordinator-state");
+        if (stateFile.empty()) {
+            stateFile = "BuildIncCoordinator.state";
+        }
+        ez::lease::Coordinator coordinator(stateFile);
+        if (!coordinator.listen(args.getValue<std::string>("coordinator"))) {
+            return 1;
+        }
+        return coordinator.run() ? 0 : 1;
+    }
+    if (args.isPresent("scan")) {
+        ez::BuildScan scanner;
+        scanner.setThreadCount(args.getValue<size_t>("threads"));
+        scanner.setUseIoUring(!args.isPresent("no-io-uring"));
+        scanner.setLabelCache(getLabelCacheDir(args), getLabelCacheSize(args));
+        scanner.scan(args.getValue<std::string>("scan"));
+        ez::BuildScan::Bump part = ez::BuildScan::Bump::None;
+        if (args.isPresent("bump-major")) {
+            part = ez::BuildScan::Bump::Major;
+        } else if (args.isPresent("bump-minor")) {
+            part = ez::BuildScan::Bump::Minor;
+        } else if (args.isPresent("bump-build")) {
+            part = ez::BuildScan::Bump::Build;
+        }
+        if (part != ez::BuildScan::Bump::None) {
+            if (!scanner.bump(part, args.getValue<std::string>("figfont"))) {
+                return 1;
+            }
+        }
+        if (args.isPresent("scan-json")) {
+            std::cout << scanner.getJson();
+        } else {
+            std::cout << scanner.getTable();
+        }
+        return 0;
+    }
+    if (args.isPresent("compile-font")) {
+        const auto files = ez::str::splitStringToVector(args.getValue<std::string>("compile-font"), ',');
+        if (files.empty()) {
+            return 1;
         }
-        std::string figFontFile = args.getValue<std::string>("figfont");
+        std::string output = (files.size() > 1) ? files.at(1) : std::string();
+        if (output.empty()) {
+            const auto dot = files.at(0).find_last_of('.');
+            const auto slash = files.at(0).find_last_of("/\\");
+            output = ((dot != std::string::npos && (slash == std::string::npos || dot > slash)) ? files.at(0).substr(0, dot) : files.at(0)) + ".bff";
+        }
+        ez::FigFont font;
+        if (!font.load(files.at(0)).isValid() || !font.compile(output)) {
+            std::cout << "failed to compile " << files.at(0) << " in " << output << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (args.isPresent("inspect")) {
+        ez::BuildInspect inspector;
+        if (!inspector.inspect(args.getValue<std::string>("inspect"))) {
+            std::cout << "no build id marker found" << std::endl;
+            return 1;
+        }
+        std::cout << inspector.getText();
+        return 0;
+    }
+    if (parsed) {
+        std::string project = args.getValue<std::string>("project");
+        ez::Stats::get().setProcessName("BuildInc " + project);
         std::string file = args.getValue<std::string>("file");
         if (!file.empty()) {
-            ez::BuildInc builder(file);
-            builder.setProject(project).setLabel(label).setFigFontFile(figFontFile);
-            builder.incBuildNumber().write().printInfos();
+            if (args.isPresent("lease") && args.isPresent("release-lease")) {
+                std::string nodeName = args.getValue<std::string>("node");
+                if (nodeName.empty()) {
+                    nodeName = ez::lease::getHostName();
+                }
+                ez::lease::Node node(args.getValue<std::string>("lease"), file + ".lease", nodeName);
+                return node.release() ? 0 : 1;
+            }
+            return updateProjects(args, project, file);
         } else {
             if (!args.isPresent("no-help")) {
                 args.printHelp();
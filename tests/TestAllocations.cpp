@@ -0,0 +1,187 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// heap allocations of the increment path :
+// a warmed up builder with the extra outputs and a FigFont banner is incremented and written again,
+// no allocation is allowed, even when the build number get one more digit. the operator new of this test count them.
+// the infos printed after a write are the same frame as before, rendered in a reused buffer
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezFigFont.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+// the free is kept out of the inlined operators, else gcc warns with -Wmismatched-new-delete
+#if defined(_MSC_VER)
+#define NOINLINE_DEALLOCATE __declspec(noinline)
+#else
+#define NOINLINE_DEALLOCATE __attribute__((noinline))
+#endif
+
+static std::atomic<int64_t> s_allocations(0);
+
+// all the forms are replaced, each new is paired with its delete
+static void* allocate(std::size_t vSize) noexcept {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(vSize != 0 ? vSize : 1);
+}
+static NOINLINE_DEALLOCATE void deallocate(void* vPtr) noexcept {
+    std::free(vPtr);
+}
+void* operator new(std::size_t vSize) {
+    if (void* ptr = allocate(vSize)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t vSize) {
+    return operator new(vSize);
+}
+void* operator new(std::size_t vSize, const std::nothrow_t&) noexcept {
+    return allocate(vSize);
+}
+void* operator new[](std::size_t vSize, const std::nothrow_t&) noexcept {
+    return allocate(vSize);
+}
+void operator delete(void* vPtr) noexcept {
+    deallocate(vPtr);
+}
+void operator delete[](void* vPtr) noexcept {
+    deallocate(vPtr);
+}
+void operator delete(void* vPtr, std::size_t) noexcept {
+    deallocate(vPtr);
+}
+void operator delete[](void* vPtr, std::size_t) noexcept {
+    deallocate(vPtr);
+}
+void operator delete(void* vPtr, const std::nothrow_t&) noexcept {
+    deallocate(vPtr);
+}
+void operator delete[](void* vPtr, const std::nothrow_t&) noexcept {
+    deallocate(vPtr);
+}
+
+static const int32_t s_writes = 500;
+
+// the allocations of vWrites increments, after two for the warm up
+static int64_t countWrites(ez::BuildInc& vBuilder, const int32_t vWrites) {
+    vBuilder.incBuildNumber().write();
+    vBuilder.incBuildNumber().write();
+    const auto start = s_allocations.load();
+    for (int32_t i = 0; i < vWrites; ++i) {
+        vBuilder.incBuildNumber().write();
+    }
+    return s_allocations.load() - start;
+}
+
+// the frame of the infos, every row padded to the longest one
+static std::string getFrame(const std::vector<std::string>& vRows) {
+    size_t width = 0;
+    for (const auto& row : vRows) {
+        width = std::max(width, row.size());
+    }
+    const auto spliter = std::string(width + 6, '-') + "\n";
+    std::string ret = spliter;
+    for (const auto& row : vRows) {
+        ret += "-- " + row + std::string(width - row.size(), ' ') + " --\n";
+    }
+    return ret + spliter;
+}
+
+// the numbers, the frame with and without project, and a failed write
+static void testInfos(const std::string& vWorkDir) {
+    std::string number;
+    ez::buildinc::appendNumber(number, 0, 2);
+    ez::buildinc::appendNumber(number, 7, 3);
+    ez::buildinc::appendNumber(number, 1234, 2);
+    CHECK(number == "000071234");
+    number.clear();
+    ez::buildinc::appendNumber(number, -42);
+    ez::buildinc::appendNumber(number, INT64_MIN);
+    CHECK(number == "-42-9223372036854775808");
+    const auto header = vWorkDir + "/Infos.h";
+    ez::BuildInc builder(header);
+    builder.setProject("Toto").setMinor(2).setBuildNumber(41).write();
+    CHECK(builder.getInfos() == getFrame({"Project : Toto", "Build Id : 0.2.41 / 000241", "In file : " + header}));
+    builder.setProject("").setMajor(12);
+    CHECK(builder.getInfos() == getFrame({"Build Id : 12.2.41 / 120241", "In file : " + header}));
+    const auto missing = vWorkDir + "/no/dir/Infos.h";
+    ez::BuildInc failed(missing);
+    failed.setProject("Toto").write();
+    CHECK(!failed.getLastWriteStatus());
+    CHECK(failed.getInfos() == getFrame({"Project : Toto", "Build Id : 0.0.0 / 00000", "failed to write to : " + missing}));
+    builder.printInfos();  // warm up
+    const auto start = s_allocations.load();
+    for (int32_t i = 0; i < 10; ++i) {
+        builder.incBuildNumber().printInfos();
+    }
+    CHECK(s_allocations.load() == start);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    {
+        ez::BuildInc builder(workDir + "/Build.h");
+        builder.setProject("Toto").setLabel("Toto").setMinor(2).setBuildNumber(9900);  // the number get a digit more
+        builder.addOutput(ez::BuildInc::OutputFormat::Json, workDir + "/Build.json")
+            .addOutput(ez::BuildInc::OutputFormat::CMake, workDir + "/Build.cmake")
+            .addOutput(ez::BuildInc::OutputFormat::Env, workDir + "/Build.env")
+            .addOutput(ez::BuildInc::OutputFormat::Python, workDir + "/Build.py");
+        const auto allocations = countWrites(builder, s_writes);
+        std::cout << "allocations : " << allocations << " for " << s_writes << " writes with the extra outputs" << std::endl;
+        CHECK(allocations == 0);
+        CHECK(builder.getLastWriteStatus());
+    }
+    {
+        const auto font = workDir + "/font.flf";
+        test::writeFile(font, test::getSyntheticFont());
+        ez::BuildInc builder(workDir + "/BuildFigFont.h");
+        builder.setProject("Toto").setLabel("Toto").setFigFontFile(font);
+        const auto allocations = countWrites(builder, s_writes);
+        std::cout << "allocations : " << allocations << " for " << s_writes << " writes with a FigFont banner" << std::endl;
+        CHECK(allocations == 0);
+        CHECK(test::readFile(workDir + "/BuildFigFont.h").find("_FigFontLabel") != std::string::npos);
+    }
+    {  // the label is rendered again at each increment
+        const auto font = workDir + "/font.flf";
+        ez::BuildInc builder(workDir + "/BuildFigFontNumber.h");
+        builder.setProject("Toto").setLabel("Toto").setBuildNumber(9900).setFigFontFile(font).useBuildNumber(true);
+        const auto allocations = countWrites(builder, s_writes);
+        std::cout << "allocations : " << allocations << " for " << s_writes << " writes with the build number in the FigFont banner" << std::endl;
+        CHECK(allocations == 0);
+    }
+    testInfos(workDir);
+    return test::result("Allocations");
+}
@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// batch io under a low limit of open files :
+// more files than the limit are written then read in one call, with io_uring and with the blocking path,
+// then again while most of the descriptors are already used by the process
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBatchIO.hpp>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+
+static const int32_t s_files = 1000;
+static const rlim_t s_maxOpenFiles = 64;
+
+static void writeThenRead(const std::string& vDir, const bool vUseIoUring, const std::string& vTag) {
+    ez::BatchIO io(vUseIoUring);
+    std::vector<std::string> files, contents;
+    for (int32_t i = 0; i < s_files; ++i) {
+        files.push_back(vDir + "/file" + std::to_string(i) + ".h");
+        contents.push_back("#define File" + std::to_string(i) + "_" + vTag + " " + std::to_string(i) + "\n");
+    }
+    std::vector<const std::string*> toWrite;
+    for (const auto& content : contents) {
+        toWrite.push_back(&content);
+    }
+    std::vector<bool> status;
+    io.writeFiles(files, toWrite, status);
+    CHECK(status.size() == files.size());
+    CHECK(std::count(status.begin(), status.end(), true) == s_files);
+    std::vector<std::string> read;
+    io.readFiles(files, read, status);
+    CHECK(std::count(status.begin(), status.end(), true) == s_files);
+    CHECK(read == contents);
+    // each file given once to the callback, its content final, the missing one as failed
+    auto withMissing = files;
+    withMissing.insert(withMissing.begin() + s_files / 2, vDir + "/missing.h");
+    std::vector<int32_t> calls(withMissing.size(), 0);
+    std::vector<uint8_t> oks(withMissing.size(), 0);
+    size_t contentErrors = 0;
+    io.readFiles(withMissing, read, status, [&](const size_t vIdx, const bool vOk) {
+        ++calls[vIdx];
+        oks[vIdx] = vOk ? 1 : 0;
+        const size_t file = (vIdx < static_cast<size_t>(s_files / 2)) ? vIdx : vIdx - 1;
+        if (vOk && (vIdx == static_cast<size_t>(s_files / 2) || read[vIdx] != contents[file])) {
+            ++contentErrors;
+        }
+    });
+    CHECK(std::count(calls.begin(), calls.end(), 1) == s_files + 1);
+    CHECK(std::count(oks.begin(), oks.end(), 1) == s_files);
+    CHECK(oks[s_files / 2] == 0 && !status[s_files / 2]);
+    CHECK(contentErrors == 0U);
+    // a missing file is an error, not a retry
+    io.readFiles({vDir + "/missing.h"}, read, status);
+    CHECK(status.size() == 1 && !status.front());
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    rlimit limit{};
+    CHECK(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+    limit.rlim_cur = std::min(limit.rlim_cur, s_maxOpenFiles);
+    CHECK(setrlimit(RLIMIT_NOFILE, &limit) == 0);
+    std::cout << "batch io : io_uring " << (ez::BatchIO(true).isIoUringUsed() ? "used" : "not available") << ", " << s_files << " files, "
+              << limit.rlim_cur << " descriptors" << std::endl;
+    writeThenRead(workDir, true, "uring");
+    writeThenRead(workDir, false, "blocking");
+    // most of the descriptors are used, the batches get EMFILE and end with the blocking path
+    std::vector<int> held;
+    for (rlim_t i = 0; i < limit.rlim_cur - 12; ++i) {
+        const int fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            held.push_back(fd);
+        }
+    }
+    writeThenRead(workDir, true, "held");
+    for (const auto fd : held) {
+        close(fd);
+    }
+    return test::result("BatchIO");
+}
@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// depfile : the files read by BuildInc are the prerequisites of the header,
+// the header itself is never listed, and the paths are escaped for make and ninja
+
+#include "TestUtils.hpp"
+
+// the font and the shards are listed, the header is not, even when it was read
+static void testPrerequisites(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto header = vWorkDir + "/Build.h";
+    const auto depFile = vWorkDir + "/Build.h.d";
+    const auto font = vWorkDir + "/font.flf";
+    test::writeFile(font, test::getSyntheticFont());
+    CHECK(test::runProcess({vBuildInc, "Toto", header, "--depfile", depFile}) == 0);
+    CHECK(test::readFile(depFile) == header + ":\n");
+    for (int32_t run = 0; run < 2; ++run) {  // the second run read the header
+        CHECK(test::runProcess({vBuildInc, "Toto", header, "-ff", font, "--depfile", depFile}) == 0);
+        CHECK(test::readFile(depFile) == header + ": \\\n  " + font + "\n");
+    }
+    CHECK(test::runProcess({vBuildInc, "Toto", header, "-ff", font, "--shard", "1/2", "--depfile", depFile}) == 0);
+    CHECK(test::readFile(depFile) == header + ": \\\n  " + font + " \\\n  " + header + ".shards\n");
+}
+
+// a font not loaded is not a prerequisite, a depfile not written fails the run
+static void testFailures(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto header = vWorkDir + "/Build.h";
+    const auto depFile = vWorkDir + "/Build.h.d";
+    const auto garbage = vWorkDir + "/garbage.flf";
+    test::writeFile(garbage, "not a font\n");
+    CHECK(test::runProcess({vBuildInc, "Toto", header, "-ff", garbage, "--depfile", depFile}) == 0);
+    CHECK(test::readFile(depFile) == header + ":\n");
+    CHECK(test::runProcess({vBuildInc, "Toto", header, "-ff", vWorkDir + "/missing.flf", "--depfile", depFile}) == 0);
+    CHECK(test::readFile(depFile) == header + ":\n");
+    CHECK(test::runProcess({vBuildInc, "Toto", header, "--depfile", vWorkDir + "/no/dir/Build.h.d"}) != 0);
+}
+
+// ' ' and '#' are escaped by a backslash, '$' by '$'
+static void testEscaping(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto dir = vWorkDir + "/a b#c$d";
+    test::makeDirs(dir);
+    const auto header = dir + "/Build.h";
+    const auto depFile = vWorkDir + "/Escaped.d";
+    const auto font = dir + "/font.flf";
+    test::writeFile(font, test::getSyntheticFont());
+    CHECK(test::runProcess({vBuildInc, "Toto", header, "-ff", font, "--depfile", depFile}) == 0);
+    const auto escapedDir = vWorkDir + "/a\\ b\\#c$$d";
+    CHECK(test::readFile(depFile) == escapedDir + "/Build.h: \\\n  " + escapedDir + "/font.flf\n");
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testPrerequisites(vArgv[1], workDir);
+    testFailures(vArgv[1], workDir);
+    testEscaping(vArgv[1], workDir);
+    return test::result("Depfile");
+}
@@ -0,0 +1,289 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// binary FigFont : a .bff render as its .flf, is rebuilt when the .flf change and only refreshed when
+// just its mtime changed, is kept when the .flf is gone, a garbage or truncated file is rejected.
+// unicode : the code tagged glyphs are found from a utf8 label, in the .flf and in the .bff.
+// render : appendString keep the start of its buffer, a label longer than the glyphs kept on the stack.
+// placement against figlet : labels rendered with fonts/standard.flf must give the rows of figlet 2.2.5
+// for the same font and text, with the blank rows dropped as BuildInc does. the .bff must give the same rows.
+// builtins : they render as their .flf, and the tables checked in are the output of --compile-font
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezFigFont.hpp>
+
+#include <ctime>
+
+#ifndef BUILDINC_FONTS_DIR  // set by cmake to the fonts of the repo
+#define BUILDINC_FONTS_DIR "fonts"
+#endif
+
+static const std::string s_label = "Toto 0.1.2";
+
+static int64_t getMTime(const std::string& vFile) {
+    struct stat st;
+    if (stat(vFile.c_str(), &st) != 0) {
+        return -1;
+    }
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+// move the mtime of a file back, so a rewrite is seen even in the same clock tick
+static void setOldMTime(const std::string& vFile, const time_t vSeconds) {
+    const timespec times[2] = {{vSeconds, 0}, {vSeconds, 0}};
+    utimensat(AT_FDCWD, vFile.c_str(), times, 0);
+}
+
+static std::string render(const std::string& vFile) {
+    ez::FigFont font(vFile);
+    return font.isValid() ? font.printString(s_label) : std::string();
+}
+
+// the rows of the glyph of an ascii char in the synthetic font, with their end marks
+static std::string getSyntheticGlyph(const char vChar) {
+    const auto font = test::getSyntheticFont();
+    size_t pos = font.find('\n') + 1U;
+    for (int32_t line = 0; line < (vChar - 32) * 4; ++line) {
+        pos = font.find('\n', pos) + 1U;
+    }
+    size_t end = pos;
+    for (int32_t line = 0; line < 4; ++line) {
+        end = font.find('\n', end) + 1U;
+    }
+    return font.substr(pos, end - pos);
+}
+
+// code tags in decimal, hexadecimal and octal, in the dense table, in a page and above the bmp.
+// each code tag takes the glyph of an ascii char, so its render is the render of this char
+static void testUnicode(const std::string& vWorkDir) {
+    const auto flf = vWorkDir + "/unicode.flf";
+    const auto bff = vWorkDir + "/unicode.bff";
+    std::string font = test::getSyntheticFont();
+    font += "233  LATIN SMALL LETTER E WITH ACUTE\n" + getSyntheticGlyph('E');
+    font += "0x4E2D  first definition\n" + getSyntheticGlyph('X');
+    font += "0x4E2D  CJK, the last definition is kept\n" + getSyntheticGlyph('U');
+    font += "0770  octal\n" + getSyntheticGlyph('O');
+    font += "0x1F600  above the bmp\n" + getSyntheticGlyph('S');
+    font += "not a code tag\n";
+    test::writeFile(flf, font);
+    for (const auto& file : {flf, bff}) {
+        ez::FigFont figFont(file);
+        CHECK(figFont.isValid());
+        if (file == flf) {
+            CHECK(figFont.compile(bff));
+        }
+        CHECK(figFont.printString("\xc3\xa9") == figFont.printString("E"));  // U+00E9
+        CHECK(figFont.printString("\xe4\xb8\xad") == figFont.printString("U"));  // U+4E2D
+        CHECK(figFont.printString("\xc7\xb8") == figFont.printString("O"));  // U+01F8
+        CHECK(figFont.printString("\xf0\x9f\x98\x80") == figFont.printString("S"));  // U+1F600
+        CHECK(figFont.printString("a\xe4\xb8\xad\xf0\x9f\x98\x80") == figFont.printString("aUS"));
+        CHECK(figFont.printString("\xe9") == figFont.printString("E"));  // not utf8, taken as latin1
+        CHECK(figFont.printString("\xc4") == figFont.printString("?"));  // the deutsch chars of the synthetic font
+    }
+}
+
+// the rows of a render, without their '\n'
+static std::vector<std::string> getRows(const std::string& vRender) {
+    std::vector<std::string> ret;
+    std::stringstream ss(vRender);
+    std::string row;
+    while (std::getline(ss, row)) {
+        ret.push_back(row);
+    }
+    return ret;
+}
+
+// with a full width font the rows of a label are the rows of its halves put side by side
+static void testRender(const std::string& vWorkDir) {
+    const auto flf = vWorkDir + "/fullwidth.flf";
+    auto content = test::getSyntheticFont();
+    content.replace(0, content.find('\n'), "flf2a$ 4 3 8 -1 0");
+    test::writeFile(flf, content);
+    ez::FigFont font(flf);
+    CHECK(font.isValid());
+    std::string half;
+    for (int32_t i = 0; i < 150; ++i) {
+        half += static_cast<char>('a' + i % 26);
+    }
+    const auto label = half + half;  // 300 glyphs
+    const auto rows = getRows(font.printString(label));
+    const auto halfRows = getRows(font.printString(half));
+    CHECK(rows.size() == 4U && halfRows.size() == 4U);
+    for (size_t r = 0; r < rows.size() && r < halfRows.size(); ++r) {
+        CHECK(rows[r] == halfRows[r] + halfRows[r]);
+    }
+    std::string buffer = "kept\n";
+    font.appendString(buffer, label);
+    CHECK(buffer == "kept\n" + font.printString(label));
+    CHECK(font.printString("\x01").empty());  // no glyph, the blank rows are dropped
+}
+
+struct Reference {
+    const char* label;  // utf8
+    const char* rows;
+};
+
+// the rows of the placement code of figlet 2.2.5 (readfontchar, smushamt, smushem, addchar) for fonts/standard.flf,
+// smushed with the layout of the font, the blank rows dropped
+static const Reference s_references[] = {
+    {"Hello",
+     " _   _      _ _       \n"
+     "| | | | ___| | | ___  \n"
+     "| |_| |/ _ \\ | |/ _ \\ \n"
+     "|  _  |  __/ | | (_) |\n"
+     "|_| |_|\\___|_|_|\\___/ \n"},
+    {"BuildInc v1.2.3",
+     " ____        _ _     _ ___                    _   ____    _____ \n"
+     "| __ ) _   _(_) | __| |_ _|_ __   ___  __   _/ | |___ \\  |___ / \n"
+     "|  _ \\| | | | | |/ _` || || '_ \\ / __| \\ \\ / / |   __) |   |_ \\ \n"
+     "| |_) | |_| | | | (_| || || | | | (__   \\ V /| |_ / __/ _ ___) |\n"
+     "|____/ \\__,_|_|_|\\__,_|___|_| |_|\\___|   \\_/ |_(_)_____(_)____/ \n"},
+    {"\xC3\x84\xC3\x96\xC3\x9C",  // ÄÖÜ
+     " _   _ _   _ _   _ \n"
+     "(_)_(_|_)_(_|_) (_)\n"
+     "  /_\\  / _ \\| | | |\n"
+     " / _ \\| |_| | |_| |\n"
+     "/_/ \\_\\\\___/ \\___/ \n"},
+};
+
+static void testPlacement(const std::string& vWorkDir) {
+    ez::FigFont font(BUILDINC_FONTS_DIR "/standard.flf");
+    CHECK(font.isValid());
+    const auto bffFile = vWorkDir + "/standard.bff";
+    CHECK(font.compile(bffFile));
+    ez::FigFont bff(bffFile);
+    CHECK(bff.isValid());
+    for (const auto& reference : s_references) {
+        const auto rows = font.printString(reference.label);
+        if (!CHECK(rows == reference.rows)) {
+            std::cerr << "label : " << reference.label << "\nexpected :\n" << reference.rows << "rendered :\n" << rows;
+        }
+        CHECK(bff.printString(reference.label) == reference.rows);
+    }
+}
+
+static void testBuiltins(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto tables = test::readFile(BUILDINC_FONTS_DIR "/../3rdparty/ezlibs/ezFigFontBuiltins.hpp");
+    CHECK(!tables.empty());
+    for (const auto* name : {"standard", "term"}) {
+        const auto flf = std::string(BUILDINC_FONTS_DIR "/") + name + ".flf";
+        ez::FigFont font(flf);
+        ez::FigFont builtin(std::string("builtin:") + name);
+        CHECK(font.isValid() && builtin.isValid());
+        CHECK(builtin.printString("BuildInc v1.2.3") == font.printString("BuildInc v1.2.3"));
+        CHECK(builtin.printString("\xC3\x84\xC3\x96\xC3\x9C") == font.printString("\xC3\x84\xC3\x96\xC3\x9C"));
+        const auto hpp = vWorkDir + "/" + name + ".hpp";
+        CHECK(test::runProcess({vBuildInc, "--compile-font", flf + "," + hpp}) == 0);
+        const auto function = test::readFile(hpp);
+        CHECK(!function.empty() && tables.find(function) != std::string::npos);
+    }
+    CHECK(!ez::FigFont("builtin:unknown").isValid());
+
+    // a builtin is not a file of the depfile
+    const auto depFile = vWorkDir + "/Builtin.h.d";
+    CHECK(test::runProcess({vBuildInc, "Toto", vWorkDir + "/Builtin.h", "-ff", "builtin:standard", "--depfile", depFile}) == 0);
+    CHECK(test::readFile(vWorkDir + "/Builtin.h").find("_FigFontLabel") != std::string::npos);
+    CHECK(test::readFile(depFile).find("builtin") == std::string::npos);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto flf = workDir + "/font.flf";
+    const auto bff = workDir + "/font.bff";
+    test::writeFile(flf, test::getSyntheticFont());
+    const auto expected = render(flf);
+    CHECK(!expected.empty());
+
+    // compiled by BuildInc, mapped at load, same label
+    CHECK(test::runProcess({buildInc, "--compile-font", flf}) == 0);
+    CHECK(test::isFileExist(bff));
+    {
+        ez::FigFont font(bff);
+        CHECK(font.isValid() && font.isMapped());
+        CHECK(font.getSourceFile() == flf);
+        CHECK(font.printString(s_label) == expected);
+    }
+
+    // the .flf touched : same glyphs, the .bff is refreshed with the new mtime
+    setOldMTime(bff, 1000000000);
+    setOldMTime(flf, 1100000000);
+    CHECK(render(bff) == expected);
+    CHECK(getMTime(bff) != 1000000000LL * 1000000000LL);
+    setOldMTime(bff, 1000000000);
+    CHECK(render(bff) == expected);  // now up to date, not written
+    CHECK(getMTime(bff) == 1000000000LL * 1000000000LL);
+
+    // the .flf edited : parsed again and the .bff rebuilt
+    test::writeFile(flf, test::getSyntheticFont('#'));
+    const auto edited = render(flf);
+    CHECK(!edited.empty() && edited != expected);
+    CHECK(render(bff) == edited);
+    {
+        ez::FigFont font(bff);
+        CHECK(font.isMapped() && font.printString(s_label) == edited);
+    }
+
+    // the .flf removed : the .bff is the font
+    CHECK(std::remove(flf.c_str()) == 0);
+    CHECK(render(bff) == edited);
+
+    // the depfile of a header list the .bff and its .flf
+    test::writeFile(flf, test::getSyntheticFont());
+    const auto depFile = workDir + "/Build.h.d";
+    CHECK(test::runProcess({buildInc, "Toto", workDir + "/Build.h", "-ff", bff, "--depfile", depFile}) == 0);
+    const auto deps = test::readFile(depFile);
+    CHECK(deps.find(bff) != std::string::npos && deps.find(flf) != std::string::npos);
+
+    // a garbage .bff is rejected, a truncated or older one is rebuilt from its .flf, rejected without it
+    const auto garbage = workDir + "/garbage.bff";
+    test::writeFile(garbage, std::string(200, 'x'));
+    CHECK(!ez::FigFont(garbage).isValid());
+    const auto truncated = workDir + "/truncated.bff";
+    const auto content = test::readFile(bff);
+    test::writeFile(truncated, content.substr(0, content.size() / 2));
+    CHECK(render(truncated) == expected);
+    CHECK(test::readFile(truncated) == content);
+    auto older = content;
+    older[4] = 1;  // the version
+    test::writeFile(truncated, older);
+    CHECK(render(truncated) == expected);
+    CHECK(test::readFile(truncated) == content);
+    test::writeFile(truncated, content.substr(0, 40));
+    CHECK(!ez::FigFont(truncated).isValid());
+    CHECK(std::remove(flf.c_str()) == 0);
+    test::writeFile(truncated, content.substr(0, content.size() / 2));
+    CHECK(!ez::FigFont(truncated).isValid());
+
+    testUnicode(workDir);
+    testRender(workDir);
+    testPlacement(workDir);
+    testBuiltins(buildInc, workDir);
+    return test::result("FigFont");
+}
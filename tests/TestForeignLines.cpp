@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// a header with user fields, comments, includes and other defines, bumped by runs and by a scan :
+// every line not generated by BuildInc is kept byte for byte (end of line included) and in its order
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <cstring>
+
+static const char* s_header =
+    "// the version of Toto, edited by hand too\n"
+    "#pragma once\n"
+    "#include <stdint.h>\n"
+    "\n"
+    "#define Toto_Label \"Toto\"\n"
+    "#define Toto_BuildNumber 5\n"
+    "#define Toto_MinorNumber 1\n"
+    "#define Toto_MajorNumber 2\n"
+    "#define Toto_BuildId \"2.1.5\"\n"
+    "#define Toto_BuildIdNum 02015\n"
+    "#define Toto_Custom 42 // the answer\n"
+    "/* a block\n"
+    "   comment */\n"
+    "#include \"other.h\"\n"
+    "#define OTHER_THING 1\n"
+    "  #define indented 2\n"
+    "#define Toto_Macro(a) ((a) + 1)\n"
+    "#define Toto_Text \"a \\\"quoted\\\" text\"\n"
+    "a line of windows\r\n"
+    "\ttab   and trailing spaces   \n"
+    "\n"
+    "\n"
+    "#ifdef TOTO_DEBUG\n"
+    "#define Toto_Debug 1\n"
+    "#endif\n"
+    "// the last line, without end of line";
+
+// the lines with their end, the last one may have none
+static std::vector<std::string> splitLines(const std::string& vContent) {
+    std::vector<std::string> ret;
+    size_t start = 0;
+    while (start < vContent.size()) {
+        const auto end = vContent.find('\n', start);
+        const auto next = (end == std::string::npos) ? vContent.size() : end + 1;
+        ret.push_back(vContent.substr(start, next - start));
+        start = next;
+    }
+    return ret;
+}
+
+// the lines not written by BuildInc : all but the generated defines and the fields set by the test
+static std::vector<std::string> getForeignLines(const std::string& vContent) {
+    static const char* generated[] = {"Label ", "BuildNumber ", "MinorNumber ", "MajorNumber ", "BuildId ", "BuildIdNum ", "Added "};
+    std::vector<std::string> ret;
+    for (const auto& line : splitLines(vContent)) {
+        bool isGenerated = false;
+        for (const auto* key : generated) {
+            isGenerated |= (line.compare(0, 13, "#define Toto_") == 0 && line.compare(13, std::strlen(key), key) == 0);
+        }
+        if (!isGenerated) {
+            ret.push_back(line);
+        }
+    }
+    return ret;
+}
+
+static void checkForeignLines(const std::string& vHeader, const std::vector<std::string>& vExpected, const int64_t vBuildNumber, const char* vStep) {
+    const auto content = test::readFile(vHeader);
+    const auto lines = getForeignLines(content);
+    if (!CHECK(lines == vExpected)) {
+        std::cerr << vStep << " :\n" << content << std::endl;
+    }
+    ez::BuildInc builder(vHeader);
+    CHECK(builder.getBuildNumber() == vBuildNumber);
+    std::string value;
+    CHECK(builder.getField("Custom", value) && value == "42 // the answer");
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto header = workDir + "/Build.h";
+    test::writeFile(header, s_header);
+    const auto expected = getForeignLines(s_header);
+    CHECK(expected.size() == 20U);
+    CHECK(expected.back() == "// the last line, without end of line");
+
+    // two runs, the second adds a field
+    CHECK(test::runProcess({buildInc, "Toto", header}) == 0);
+    checkForeignLines(header, expected, 6, "first run");
+    CHECK(test::runProcess({buildInc, "Toto", header, "--set", "Added=1"}) == 0);
+    checkForeignLines(header, expected, 7, "second run");
+    std::string value;
+    CHECK(ez::BuildInc(header).getField("Added", value) && value == "1");
+    CHECK(test::readFile(header).find("#define Toto_Custom 42 // the answer\n#define Toto_Added 1\n/* a block\n") != std::string::npos);
+
+    // the bump of a scan, through the batch io
+    CHECK(test::runProcess({buildInc, "--scan", workDir, "--bump-build"}) == 0);
+    checkForeignLines(header, expected, 8, "scan bump");
+
+    // the generated defines stay at their place, after the lines before the first one
+    const std::string start = "// the version of Toto, edited by hand too\n#pragma once\n#include <stdint.h>\n\n#define Toto_Label ";
+    CHECK(test::readFile(header).compare(0, start.size(), start) == 0);
+    return test::result("ForeignLines");
+}
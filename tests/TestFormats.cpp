@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// the five outputs rendered in one run, with a label and a field full of the chars to escape,
+// then read back by their own consumer : BuildInc for the header, a json parser,
+// sh for the env file, cmake for the include file and python for the module
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <cstdlib>
+
+#ifndef BUILDINC_CMAKE_COMMAND  // set by cmake
+#define BUILDINC_CMAKE_COMMAND "cmake"
+#endif
+
+// quotes, backslash, dollar, tab, new line, a control char without short form and utf-8
+static const std::string s_label = "Say \"hi\" \\ $HOME 'q'\ttab\nline\x01 end \xc3\xa9";
+static const std::string s_field = "it's \"x\" $y \\z\t\x1f";
+
+// the two values printed by a consumer, one per line, in the order label then field
+static void checkPrinted(const std::string& vFile, const char* vConsumer) {
+    const auto printed = test::readFile(vFile);
+    if (!CHECK(printed == s_label + "\n" + s_field)) {
+        std::cerr << vConsumer << " printed [" << printed << "]" << std::endl;
+    }
+}
+
+static bool hasCommand(const std::string& vCommand) {
+    return std::system(("command -v " + vCommand + " >/dev/null 2>&1").c_str()) == 0;
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto header = workDir + "/Build.h";
+    const auto json = workDir + "/Build.json";
+    const auto cmake = workDir + "/Build.cmake";
+    const auto env = workDir + "/Build.env";
+    const auto python = workDir + "/build.py";
+    const auto out = workDir + "/out.txt";
+    CHECK(test::runProcess({buildInc, "Toto", header, "--label", s_label, "--set", "Text=" + s_field + ",Count=42",  //
+                            "--json", json, "--cmake", cmake, "--env", env, "--python", python},
+                           out) == 0);
+
+    // header : the next run reads the same label
+    ez::BuildInc builder(header);
+    CHECK(builder.getLabel() == s_label);
+    CHECK(builder.getBuildNumber() == 1);
+
+    // json : strict parser, the control chars must be escaped
+    test::Json root;
+    CHECK(test::Json::parse(test::readFile(json), root));
+    CHECK(root["Project"].string == "Toto");
+    CHECK(root["Label"].string == s_label);
+    CHECK(root["Text"].string == s_field);
+    CHECK(root["Count"].type == test::Json::Type::Number && root["Count"].number == 42.0);
+    CHECK(root["BuildNumber"].number == 1.0);
+    CHECK(root["BuildId"].string == builder.getBuildIdStr());
+
+    // env : sourced by sh
+    CHECK(test::runProcess({"/bin/sh", "-c", ". \"$1\" && printf '%s\\n%s' \"$Toto_Label\" \"$Toto_Text\"", "sh", env}, out) == 0);
+    checkPrinted(out, "sh");
+    CHECK(test::runProcess({"/bin/sh", "-c", ". \"$1\" && printf '%s %s' \"$Toto_Count\" \"$Toto_BuildId\"", "sh", env}, out) == 0);
+    CHECK(test::readFile(out) == "42 " + builder.getBuildIdStr());
+
+    // cmake : included by a script
+    const auto script = workDir + "/print.cmake";
+    test::writeFile(script, "include(\"" + cmake + "\")\nfile(WRITE \"" + out + "\" \"${Toto_Label}\\n${Toto_Text}\")\n");
+    CHECK(test::runProcess({BUILDINC_CMAKE_COMMAND, "-P", script}) == 0);
+    checkPrinted(out, "cmake");
+
+    // python : run as a module by a script, if there is a python (found in the PATH by sh)
+    if (hasCommand("python3")) {
+        const auto printer = workDir + "/print.py";
+        test::writeFile(printer,
+                        "import runpy, sys\n"
+                        "m = runpy.run_path(sys.argv[1])\n"
+                        "assert m['Toto_Count'] == 42 and m['Toto_BuildNumber'] == 1\n"
+                        "sys.stdout.buffer.write((m['Toto_Label'] + '\\n' + m['Toto_Text']).encode('utf-8'))\n");
+        CHECK(test::runProcess({"/bin/sh", "-c", "exec python3 \"$1\" \"$2\"", "sh", printer, python}, out) == 0);
+        checkPrinted(out, "python");
+    } else {
+        std::cout << "formats : no python3, the python module is not checked" << std::endl;
+    }
+    return test::result("Formats");
+}
@@ -0,0 +1,218 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// label cache : hit, miss, a key collision is a miss (digest and text compared),
+// the least recently used entries evicted, the temporary files let by a crash removed.
+// then through BuildInc : BUILDINC_LABEL_CACHE and --label-cache-size
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezFigFontCache.hpp>
+
+#include <dirent.h>
+
+#include <ctime>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#ifndef BUILDINC_FONTS_DIR  // set by cmake to the fonts of the repo
+#define BUILDINC_FONTS_DIR "fonts"
+#endif
+
+static std::vector<std::string> listFiles(const std::string& vDir, const char* vExt) {
+    std::vector<std::string> ret;
+    if (DIR* dir = opendir(vDir.c_str())) {
+        while (const auto* ent = readdir(dir)) {
+            const size_t len = std::strlen(ent->d_name);
+            const size_t extLen = std::strlen(vExt);
+            if (len > extLen && std::strcmp(ent->d_name + len - extLen, vExt) == 0) {
+                ret.push_back(vDir + "/" + ent->d_name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+// the mtime is the time of the last use for the eviction
+static void setAge(const std::string& vFile, const int64_t vSeconds) {
+    struct timespec times[2];
+    clock_gettime(CLOCK_REALTIME, &times[0]);
+    times[0].tv_sec -= static_cast<time_t>(vSeconds);
+    times[1] = times[0];
+    utimensat(AT_FDCWD, vFile.c_str(), times, 0);
+}
+
+static bool isHit(ez::FigFontCache& vCache, const uint64_t vDigest, const std::string& vText, const std::string& vLabel) {
+    std::string label;
+    return vCache.load(vDigest, vText, label) && label == vLabel;
+}
+
+// the file of an entry, found by its label
+static std::string findEntry(const std::string& vDir, const std::string& vLabel) {
+    for (const auto& file : listFiles(vDir, ".lbl")) {
+        const auto content = test::readFile(file);
+        if (content.size() >= vLabel.size() && content.compare(content.size() - vLabel.size(), vLabel.size(), vLabel) == 0) {
+            return file;
+        }
+    }
+    return {};
+}
+
+static void testHitMiss(const std::string& vWorkDir) {
+    const auto dir = vWorkDir + "/hit";
+    ez::FigFontCache cache;
+    std::string label;
+    CHECK(!cache.load(1, "A", label));  // disabled
+    cache.setDirectory(dir + "/");
+    CHECK(cache.getDirectory() == dir);
+    CHECK(!cache.load(1, "A", label));  // no directory yet
+    CHECK(cache.store(1, "A", "label of A"));
+    CHECK(isHit(cache, 1, "A", "label of A"));
+    CHECK(!cache.load(2, "A", label));  // another font
+    CHECK(!cache.load(1, "B", label));  // another text
+    label = "prefix ";
+    CHECK(cache.load(1, "A", label) && label == "prefix label of A");  // appended
+    CHECK(listFiles(dir, ".lbl").size() == 1U);
+    CHECK(listFiles(dir, ".tmp").empty());
+}
+
+// two keys on one file are simulated by copying an entry on the file of another key :
+// the digest and the text are compared, so the wrong label is never given
+static void testCollision(const std::string& vWorkDir) {
+    const auto dir = vWorkDir + "/collision";
+    ez::FigFontCache cache;
+    cache.setDirectory(dir);
+    CHECK(cache.store(1, "A", "label of A"));
+    CHECK(cache.store(1, "B", "label of B"));
+    CHECK(cache.store(2, "A", "label of A by 2"));
+    const auto fileA = findEntry(dir, "label of A");
+    const auto fileB = findEntry(dir, "label of B");
+    const auto fileA2 = findEntry(dir, "label of A by 2");
+    CHECK(!fileA.empty() && !fileB.empty() && !fileA2.empty());
+    test::writeFile(fileB, test::readFile(fileA));  // same digest, other text
+    test::writeFile(fileA2, test::readFile(fileA));  // same text, other digest
+    std::string label;
+    CHECK(!cache.load(1, "B", label));
+    CHECK(!cache.load(2, "A", label));
+    CHECK(label.empty());
+    CHECK(isHit(cache, 1, "A", "label of A"));
+}
+
+// the entries over the max size are evicted from the least recently used, a hit is a use
+static void testEviction(const std::string& vWorkDir) {
+    const auto dir = vWorkDir + "/eviction";
+    const std::string label(175, '#');  // 24 + 1 + 175 = 200 bytes per entry
+    ez::FigFontCache cache;
+    cache.setDirectory(dir).setMaxSize(1000);
+    for (int32_t i = 0; i < 4; ++i) {
+        const auto text = std::to_string(i);
+        CHECK(cache.store(1, text, label.substr(1) + text));
+        setAge(findEntry(dir, label.substr(1) + text), 100 - i);  // 0 is the oldest
+    }
+    CHECK(listFiles(dir, ".lbl").size() == 4U);  // 800 bytes
+    CHECK(isHit(cache, 1, "0", label.substr(1) + "0"));  // 0 is the newest now
+    CHECK(cache.store(1, "4", label.substr(1) + "4"));  // 1000 bytes, fit
+    CHECK(listFiles(dir, ".lbl").size() == 5U);
+    CHECK(cache.store(1, "5", label.substr(1) + "5"));  // 1200 bytes, down to 750
+    CHECK(listFiles(dir, ".lbl").size() == 3U);
+    std::string out;
+    CHECK(!cache.load(1, "1", out));
+    CHECK(!cache.load(1, "2", out));
+    CHECK(!cache.load(1, "3", out));
+    CHECK(isHit(cache, 1, "0", label.substr(1) + "0"));
+    CHECK(isHit(cache, 1, "4", label.substr(1) + "4"));
+    CHECK(isHit(cache, 1, "5", label.substr(1) + "5"));
+}
+
+// the temporary files older than an hour are let by a crash, the recent ones can be a store in progress
+static void testStaleTmpFiles(const std::string& vWorkDir) {
+    const auto dir = vWorkDir + "/tmp";
+    ez::FigFontCache cache;
+    cache.setDirectory(dir);
+    CHECK(cache.store(1, "A", "label of A"));
+    const auto stale = dir + "/0123456789abcdef.lbl.otherhost.42.0.tmp";
+    const auto recent = dir + "/0123456789abcdef.lbl.otherhost.43.0.tmp";
+    test::writeFile(stale, "half written");
+    test::writeFile(recent, "in progress");
+    setAge(stale, 2 * 3600);
+    setAge(recent, 60);
+    cache.evict();
+    CHECK(!test::isFileExist(stale));
+    CHECK(test::isFileExist(recent));
+    CHECK(isHit(cache, 1, "A", "label of A"));
+}
+
+static int64_t readCounter(const std::string& vJson, const std::string& vName) {
+    const auto key = "\"" + vName + "\":";
+    const auto pos = vJson.find(key);
+    return (pos == std::string::npos) ? -1 : std::strtoll(vJson.c_str() + pos + key.size(), nullptr, 10);
+}
+
+static void testBuildInc(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const std::string font = BUILDINC_FONTS_DIR "/standard.flf";
+    // the directory of BUILDINC_LABEL_CACHE, shared by the CI jobs : the second run is a hit
+    const auto envDir = vWorkDir + "/env";
+    setenv("BUILDINC_LABEL_CACHE", envDir.c_str(), 1);
+    for (int32_t run = 0; run < 2; ++run) {
+        const auto stats = vWorkDir + "/env" + std::to_string(run) + ".json";
+        CHECK(test::runProcess({vBuildInc, "Toto", vWorkDir + "/Env.h", "-ff", font, "--stats=" + stats}, vWorkDir + "/out.txt") == 0);
+        const auto json = test::readFile(stats);
+        CHECK(readCounter(json, "labelCacheHits") == run);
+        CHECK(readCounter(json, "labelCacheMisses") == 1 - run);
+    }
+    CHECK(listFiles(envDir, ".lbl").size() == 1U);
+    unsetenv("BUILDINC_LABEL_CACHE");
+    // --label-cache-size in MB : 4 old entries of 300 KB, the store of the label evicts the 2 oldest (down to 768 KB)
+    const auto sizeDir = test::resetDir(vWorkDir + "/size");
+    std::vector<std::string> olds;
+    for (int32_t i = 0; i < 4; ++i) {
+        olds.push_back(sizeDir + "/000000000000000" + std::to_string(i) + ".lbl");
+        test::writeFile(olds.back(), std::string(300 * 1024, 'x'));
+        setAge(olds.back(), 100 - i);
+    }
+    CHECK(test::runProcess({vBuildInc, "Toto", vWorkDir + "/Size.h", "-ff", font, "--label-cache=" + sizeDir, "--label-cache-size", "1"},
+                           vWorkDir + "/out.txt") == 0);
+    CHECK(!test::isFileExist(olds[0]));
+    CHECK(!test::isFileExist(olds[1]));
+    CHECK(test::isFileExist(olds[2]));
+    CHECK(test::isFileExist(olds[3]));
+    CHECK(listFiles(sizeDir, ".lbl").size() == 3U);  // with the label of Toto
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testHitMiss(workDir);
+    testCollision(workDir);
+    testEviction(workDir);
+    testStaleTmpFiles(workDir);
+    testBuildInc(vArgv[1], workDir);
+    return test::result("LabelCache");
+}
@@ -0,0 +1,251 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// loopback harness of the lease allocator :
+// a coordinator of this process serves BuildInc nodes (2 processes per node, one lease file),
+// the nodes are killed at random and the coordinator is restarted from its state,
+// the numbers of the builds must stay unique. a silent client must not block the others
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+#include <ezlibs/ezBuildLease.hpp>
+
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <memory>
+#include <csignal>
+#include <cstdlib>
+
+class CoordinatorThread {
+private:
+    ez::lease::Coordinator m_coordinator;
+    std::thread m_thread;
+
+public:
+    CoordinatorThread(const std::string& vStateFile, const int32_t vPort) : m_coordinator(vStateFile) {
+        m_coordinator.setTimeout(500);
+        // a restart on the same port can wait a bit : a BuildInc being started by another thread
+        // keep a copy of the previous listen socket until its exec
+        bool listening = m_coordinator.listen("127.0.0.1:" + std::to_string(vPort));
+        for (int32_t retry = 0; !listening && vPort != 0 && retry < 100; ++retry) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            listening = m_coordinator.listen("127.0.0.1:" + std::to_string(vPort));
+        }
+        if (listening) {
+            m_thread = std::thread([this]() { m_coordinator.run(); });
+        }
+    }
+    ~CoordinatorThread() {
+        m_coordinator.stop();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+    bool isRunning() const { return m_thread.joinable(); }
+    int32_t getPort() const { return m_coordinator.getPort(); }
+};
+
+// the build number printed by BuildInc : "Build Id : <major>.<minor>.<build> / <num>"
+static int64_t readBuildNumber(const std::string& vStdOutFile) {
+    const auto content = test::readFile(vStdOutFile);
+    const std::string key = "Build Id : ";
+    auto pos = content.find(key);
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    pos = content.find(" / ", pos);
+    const auto dot = content.rfind('.', pos);
+    return (pos == std::string::npos || dot == std::string::npos) ? -1 : std::strtoll(content.c_str() + dot + 1, nullptr, 10);
+}
+
+// a client connected but silent is dropped at the timeout, the others are served meanwhile
+static void testSilentClient(const std::string& vWorkDir) {
+    CoordinatorThread coordinator(vWorkDir + "/silent.state", 0);
+    CHECK(coordinator.isRunning());
+    const auto address = "127.0.0.1:" + std::to_string(coordinator.getPort());
+    const int silent = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(coordinator.getPort()));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(connect(silent, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ez::lease::Node node(address, vWorkDir + "/silent.lease", "n0");
+        int64_t number = 0;
+        CHECK(node.allocate("Toto", 10, 0, number));
+        CHECK(number == 1);
+    }
+    const auto elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(elapsedMs < 250.0);
+    char c = 0;
+    CHECK(recv(silent, &c, 1, 0) == 0);  // closed by the coordinator at the timeout
+    close(silent);
+}
+
+// two nodes objects on one lease file : the second waits for the first, and continue its lease
+static void testLeaseFileLock(const std::string& vWorkDir) {
+    CoordinatorThread coordinator(vWorkDir + "/lock.state", 0);
+    const auto address = "127.0.0.1:" + std::to_string(coordinator.getPort());
+    const auto leaseFile = vWorkDir + "/lock.lease";
+    std::atomic<bool> secondDone(false);
+    int64_t first = 0, second = 0;
+    std::thread other;
+    {
+        ez::lease::Node node(address, leaseFile, "n0");
+        CHECK(node.isLocked());
+        CHECK(node.allocate("Toto", 10, 0, first));
+        other = std::thread([&]() {
+            ez::lease::Node otherNode(address, leaseFile, "n0");
+            otherNode.allocate("Toto", 10, 0, second);
+            secondDone = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        CHECK(!secondDone);  // blocked on the lock of the lease file
+    }
+    other.join();
+    CHECK(secondDone);
+    CHECK(second == first + 1);
+}
+
+// two nodes writing one header, each with its own lease file : the node n1 holds the lock of the header
+// while the node n0 waits for it with a number of its lower lease, the header must not go back
+static void testTwoNodesOneHeader(const std::string& vBuildInc, const std::string& vWorkDir) {
+    CoordinatorThread coordinator(vWorkDir + "/two.state", 0);
+    CHECK(coordinator.isRunning());
+    const auto address = "127.0.0.1:" + std::to_string(coordinator.getPort());
+    const auto dir = test::resetDir(vWorkDir + "/two");
+    const auto header = dir + "/Build.h";
+    const auto out = dir + "/out.txt";
+    const std::vector<std::string> n0 = {vBuildInc, "Toto", header, "--lease", address, "--lease-size", "10", "--node", "n0"};
+    CHECK(test::runProcess(n0, out) == 0);
+    CHECK(readBuildNumber(out) == 1);  // lease [1, 11) of n0
+    int64_t n1Number = 0;
+    pid_t pid = -1;
+    {
+        ez::MultiBuildInc multi(header);  // the lock of the header, n1 is writing
+        CHECK(multi.isLocked());
+        pid = test::startProcess(n0, out);
+        // n0 takes 2 from its lease, then waits for the header
+        const auto start = std::chrono::steady_clock::now();
+        while (test::readFile(header + ".lease") != "Toto 1 11 3\n" && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        CHECK(test::readFile(header + ".lease") == "Toto 1 11 3\n");
+        ez::lease::Node node(address, dir + "/n1.lease", "n1");
+        CHECK(node.allocate("Toto", 10, multi.getProject("Toto").getBuildNumber(), n1Number));
+        CHECK(n1Number == 11);  // lease [11, 21) of n1
+        multi.getProject("Toto").setBuildNumber(n1Number);
+        CHECK(multi.write());
+    }
+    CHECK(test::waitProcess(pid) == 0);
+    // 2 is passed by the header, n0 takes a number above it and never one of n1
+    const int64_t n0Number = readBuildNumber(out);
+    CHECK(n0Number > n1Number);
+    CHECK(n0Number >= 21);
+    ez::MultiBuildInc multi(header, test::readFile(header));
+    CHECK(multi.getProject("Toto").getBuildNumber() == n0Number);
+}
+
+// the nodes are killed at random and the coordinator restarted, no number is given twice
+static void testCrashes(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const int32_t nodes = 4;
+    const int32_t processesPerNode = 2;
+    const int32_t runs = 40;
+    const auto stateFile = vWorkDir + "/crash.state";
+    std::unique_ptr<CoordinatorThread> coordinator(new CoordinatorThread(stateFile, 0));
+    CHECK(coordinator->isRunning());
+    const int32_t port = coordinator->getPort();
+    const auto address = "127.0.0.1:" + std::to_string(port);
+    std::mutex mutex;
+    std::vector<int64_t> numbers;
+    std::vector<std::vector<int64_t>> numbersPerProcess(nodes * processesPerNode);
+    int32_t killed = 0, failed = 0;
+    std::vector<std::thread> threads;
+    for (int32_t n = 0; n < nodes; ++n) {
+        const auto nodeDir = test::resetDir(vWorkDir + "/node" + std::to_string(n));
+        for (int32_t p = 0; p < processesPerNode; ++p) {
+            threads.emplace_back([&, n, p, nodeDir]() {
+                std::mt19937 rng(static_cast<uint32_t>(n * 10 + p));
+                std::uniform_int_distribution<int32_t> kill(0, 4);
+                std::uniform_int_distribution<int32_t> delayUs(0, 3000);
+                const auto out = nodeDir + "/p" + std::to_string(p) + ".txt";
+                for (int32_t r = 0; r < runs; ++r) {
+                    const pid_t pid = test::startProcess(
+                        {vBuildInc, "Toto", nodeDir + "/Build.h", "--lease", address, "--lease-size", "7", "--node", "n" + std::to_string(n)}, out);
+                    const bool toKill = (kill(rng) == 0);
+                    if (toKill) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(delayUs(rng)));
+                        ::kill(pid, SIGKILL);
+                    }
+                    const int32_t code = test::waitProcess(pid);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (code == 0) {
+                        const int64_t number = readBuildNumber(out);
+                        numbers.push_back(number);
+                        numbersPerProcess[n * processesPerNode + p].push_back(number);
+                    } else if (code < 0) {
+                        ++killed;
+                    } else {
+                        ++failed;  // the coordinator was restarting
+                    }
+                }
+            });
+        }
+    }
+    for (int32_t restart = 0; restart < 3; ++restart) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        coordinator.reset();  // stop, the state is reloaded by the next one
+        coordinator.reset(new CoordinatorThread(stateFile, port));
+        CHECK(coordinator->isRunning());
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "lease : " << numbers.size() << " builds, " << killed << " killed, " << failed << " failed" << std::endl;
+    CHECK(numbers.size() > static_cast<size_t>(nodes * processesPerNode * runs / 2));
+    CHECK(std::set<int64_t>(numbers.begin(), numbers.end()).size() == numbers.size());
+    for (const auto& processNumbers : numbersPerProcess) {
+        for (const auto number : processNumbers) {
+            CHECK(number > 0);
+        }
+    }
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testSilentClient(workDir);
+    testLeaseFileLock(workDir);
+    testTwoNodesOneHeader(vArgv[1], workDir);
+    testCrashes(vArgv[1], workDir);
+    return test::result("Lease");
+}
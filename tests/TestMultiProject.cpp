@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// round trip of a header shared by two projects :
+// a project run, a multi project run, the scan and the bump keep the block of the other project,
+// and the concurrent runs and bumps don't lose an increment
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+#include <ezlibs/ezBuildScan.hpp>
+
+#include <thread>
+
+static int64_t getBuildNumber(const std::string& vFile, const std::string& vProject) {
+    ez::MultiBuildInc multi(vFile);
+    return multi.getProject(vProject).getBuildNumber();
+}
+
+static int32_t countProjects(const std::string& vFile) {
+    ez::MultiBuildInc multi(vFile);
+    return static_cast<int32_t>(multi.getProjects().size());
+}
+
+static void testRoundTrip(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto dir = test::resetDir(vWorkDir + "/roundtrip");
+    const auto file = dir + "/v.h";
+    CHECK(test::runProcess({vBuildInc, "A", file, "--major", "3", "--set", "Channel=beta"}) == 0);
+    CHECK(test::runProcess({vBuildInc, "A", file}) == 0);
+    test::writeFile(file, test::readFile(file) + "// kept line\n");
+    // a project added to a file holding only A, A is kept with its numbers
+    CHECK(test::runProcess({vBuildInc, "B", file}) == 0);
+    CHECK(countProjects(file) == 2);
+    CHECK(getBuildNumber(file, "A") == 2);
+    CHECK(getBuildNumber(file, "B") == 1);
+    {
+        ez::MultiBuildInc multi(file);
+        CHECK(multi.getProject("A").getMajor() == 3);
+        CHECK(multi.getProject("B").getMajor() == 0);  // not inherited from A
+        std::string channel;
+        CHECK(multi.getProject("A").getField("Channel", channel) && channel == "\"beta\"");
+        CHECK(!multi.getProject("B").getField("Channel", channel));
+    }
+    CHECK(test::readFile(file).find("// kept line\n") != std::string::npos);
+    CHECK(test::runProcess({vBuildInc, "A,B", file}) == 0);
+    CHECK(getBuildNumber(file, "A") == 3);
+    CHECK(getBuildNumber(file, "B") == 2);
+    // the scan lists the two projects
+    const auto scanFile = vWorkDir + "/scan.json";
+    CHECK(test::runProcess({vBuildInc, "--scan", dir, "--scan-json"}, scanFile) == 0);
+    const auto scan = test::readFile(scanFile);
+    CHECK(scan.find("\"Project\": \"A\"") != std::string::npos);
+    CHECK(scan.find("\"Project\": \"B\"") != std::string::npos);
+    // the bump keeps the two projects, under the lock of the header
+    CHECK(test::runProcess({vBuildInc, "--scan", dir, "--bump-build"}) == 0);
+    CHECK(countProjects(file) == 2);
+    CHECK(getBuildNumber(file, "A") == 4);
+    CHECK(getBuildNumber(file, "B") == 3);
+    CHECK(test::isFileExist(file + ".lock"));
+    CHECK(test::readFile(file).find("// kept line\n") != std::string::npos);
+    // the scan of the library, one entry per project in the file order
+    ez::BuildScan scanner;
+    scanner.scan(dir);
+    CHECK(scanner.getEntries().size() == 2U);
+    if (scanner.getEntries().size() == 2U) {
+        CHECK(scanner.getEntries().at(0).project == "A");
+        CHECK(scanner.getEntries().at(1).project == "B");
+    }
+    CHECK(scanner.bump(ez::BuildScan::Bump::Minor));
+    CHECK(scanner.getWrittenCount() == 1U);
+    CHECK(scanner.getEntries().size() == 2U);
+    ez::MultiBuildInc multi(file);
+    CHECK(multi.getProject("A").getMinor() == 1);
+    CHECK(multi.getProject("B").getMinor() == 1);
+}
+
+// the project runs and the bumps run together, no increment is lost
+static void testConcurrent(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto dir = test::resetDir(vWorkDir + "/concurrent");
+    const auto file = dir + "/v.h";
+    CHECK(test::runProcess({vBuildInc, "A,B", file}) == 0);
+    const int32_t threads = 8;
+    const int32_t runs = 20;
+    std::vector<std::thread> workers;
+    std::vector<int32_t> failures(threads + 1, 0);
+    for (int32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            for (int32_t r = 0; r < runs; ++r) {
+                if (test::runProcess({vBuildInc, (t % 2 == 0) ? "A" : "B", file}) != 0) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    workers.emplace_back([&]() {
+        for (int32_t r = 0; r < runs; ++r) {
+            if (test::runProcess({vBuildInc, "--scan", dir, "--bump-build"}) != 0) {
+                ++failures[threads];
+            }
+        }
+    });
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto failure : failures) {
+        CHECK(failure == 0);
+    }
+    CHECK(countProjects(file) == 2);
+    // 1 + the runs of the project + the bumps
+    CHECK(getBuildNumber(file, "A") == 1 + (threads / 2) * runs + runs);
+    CHECK(getBuildNumber(file, "B") == 1 + (threads / 2) * runs + runs);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testRoundTrip(vArgv[1], workDir);
+    testConcurrent(vArgv[1], workDir);
+    return test::result("MultiProject");
+}
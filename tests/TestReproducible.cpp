@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// reproducible mode :
+// two builds of the same state in two directories must give byte identical headers and markers,
+// a rebuild must keep the bytes and the mtime of the files, for ccache and make
+
+#include "TestUtils.hpp"
+
+#include <cstdlib>
+
+static const char* s_sourceDateEpoch = "1750000000";  // 2025-06-15, after the epoch of the time scheme
+
+static int32_t build(const std::string& vBuildInc, const std::string& vDir, const std::string& vFont) {
+    return test::runProcess({vBuildInc, "Toto", vDir + "/Build.h", "--reproducible", "--marker", "--id-scheme", "time",  //
+                             "-ff", vFont, "--json", vDir + "/Build.json"});
+}
+
+static bool getMTime(const std::string& vFile, timespec& vOutTime) {
+    struct stat st;
+    if (stat(vFile.c_str(), &st) != 0) {
+        return false;
+    }
+    vOutTime = st.st_mtim;
+    return true;
+}
+
+static std::string getDefine(const std::string& vHeader, const std::string& vName) {
+    const auto content = test::readFile(vHeader);
+    const auto pos = content.find("#define " + vName + " ");
+    return (pos == std::string::npos) ? std::string() : content.substr(pos, content.find('\n', pos) - pos);
+}
+
+// the marker as read by --inspect in a binary including the header, if a compiler is known
+static std::string inspectMarker(const std::string& vBuildInc, const std::string& vDir) {
+#ifdef BUILDINC_CXX_COMPILER
+    test::writeFile(vDir + "/main.cpp", "#include \"Build.h\"\nint main() { return 0; }\n");
+    if (test::runProcess({BUILDINC_CXX_COMPILER, vDir + "/main.cpp", "-o", vDir + "/main"}) != 0) {
+        return {};
+    }
+    if (test::runProcess({vBuildInc, "--inspect", vDir + "/main"}, vDir + "/inspect.txt") != 0) {
+        return {};
+    }
+    return test::readFile(vDir + "/inspect.txt");
+#else
+    (void)vBuildInc;
+    (void)vDir;
+    return {};
+#endif
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto dirA = test::resetDir(workDir + "/a");
+    const auto dirB = test::resetDir(workDir + "/b");
+    const auto font = workDir + "/synthetic.flf";
+    test::writeFile(font, test::getSyntheticFont());
+    setenv("SOURCE_DATE_EPOCH", s_sourceDateEpoch, 1);
+    CHECK(build(buildInc, dirA, font) == 0);
+    CHECK(build(buildInc, dirB, font) == 0);
+    const auto header = test::readFile(dirA + "/Build.h");
+    CHECK(!header.empty());
+    CHECK(header == test::readFile(dirB + "/Build.h"));
+    CHECK(test::readFile(dirA + "/Build.json") == test::readFile(dirB + "/Build.json"));
+    const auto buildNumber = getDefine(dirA + "/Build.h", "Toto_BuildNumber");
+    const auto marker = getDefine(dirA + "/Build.h", "Toto_Marker");
+    CHECK(buildNumber != "#define Toto_BuildNumber 0" && !buildNumber.empty());
+    CHECK(!marker.empty() && marker == getDefine(dirB + "/Build.h", "Toto_Marker"));
+    std::cout << "reproducible : " << buildNumber << std::endl;
+#ifdef BUILDINC_CXX_COMPILER
+    const auto inspectA = inspectMarker(buildInc, dirA);
+    CHECK(inspectA.find("BuildIdNum : ") != std::string::npos);
+    CHECK(inspectA == inspectMarker(buildInc, dirB));
+    std::cout << inspectA;
+#endif
+    // a rebuild of the same state keep the bytes and the mtime
+    timespec before{}, after{};
+    CHECK(getMTime(dirA + "/Build.h", before));
+    CHECK(build(buildInc, dirA, font) == 0);
+    CHECK(getMTime(dirA + "/Build.h", after));
+    CHECK(header == test::readFile(dirA + "/Build.h"));
+    CHECK(before.tv_sec == after.tv_sec && before.tv_nsec == after.tv_nsec);
+    // another source date gives another build number
+    setenv("SOURCE_DATE_EPOCH", "1760000000", 1);
+    CHECK(build(buildInc, dirB, font) == 0);
+    CHECK(getDefine(dirB + "/Build.h", "Toto_BuildNumber") != buildNumber);
+    return test::result("Reproducible");
+}
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// a tree of build id files mixed with other files : the scan finds only the build id files,
+// at any depth and with any of the header extensions, then a bump rewrites all of them
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+
+// the entries of the scan, sorted by file
+static bool scan(const std::string& vBuildInc, const std::string& vRoot, const std::string& vOut, test::Json& vEntries) {
+    return test::runProcess({vBuildInc, "--scan", vRoot, "--scan-json", "--threads", "4"}, vOut) == 0 &&  //
+        test::Json::parse(test::readFile(vOut), vEntries) && vEntries.type == test::Json::Type::Array;
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto root = workDir + "/tree";
+    const auto out = workDir + "/out.txt";
+    test::makeDirs(root + "/a/b/c");
+    test::makeDirs(root + "/d");
+    const std::vector<std::pair<std::string, std::string>> headers = {
+        {"Core", root + "/a/Core.h"},
+        {"Gui", root + "/a/b/c/Gui.hpp"},
+        {"Tools", root + "/d/Tools.hxx"},
+    };
+    for (const auto& header : headers) {
+        CHECK(test::runProcess({buildInc, header.first, header.second}, out) == 0);
+    }
+    // not build id files : a plain header, and a build id in a file without a header extension
+    const auto plain = "#pragma once\n\n#define PLAIN_VALUE 1\n";
+    test::writeFile(root + "/a/b/plain.h", plain);
+    test::writeFile(root + "/d/Build.txt", test::readFile(root + "/a/Core.h"));
+
+    test::Json entries;
+    CHECK(scan(buildInc, root, out, entries));
+    CHECK(entries.array.size() == headers.size());
+    for (size_t i = 0; i < entries.array.size() && i < headers.size(); ++i) {
+        const auto& entry = entries.array[i];
+        CHECK(entry["File"].string.find(headers[i].second.substr(root.size())) != std::string::npos);
+        CHECK(entry["Project"].string == headers[i].first);
+        CHECK(entry["BuildNumber"].number == 1.0);
+        CHECK(entry["BuildId"].string == "0.0.1");
+    }
+
+    // the bumps are written in the files and printed
+    CHECK(test::runProcess({buildInc, "--scan", root, "--bump-build"}, out) == 0);
+    CHECK(test::runProcess({buildInc, "--scan", root, "--bump-minor"}, out) == 0);
+    for (const auto& header : headers) {
+        ez::BuildInc builder(header.second);
+        CHECK(builder.getProject() == header.first);
+        CHECK(builder.getBuildNumber() == 2);
+        CHECK(builder.getMinor() == 1);
+    }
+    CHECK(test::runProcess({buildInc, "--scan", root, "--scan-json", "--bump-major"}, out) == 0);
+    CHECK(test::Json::parse(test::readFile(out), entries));
+    for (const auto& entry : entries.array) {
+        CHECK(entry["BuildId"].string == "1.0.2");
+    }
+    CHECK(test::readFile(root + "/a/b/plain.h") == plain);
+    CHECK(ez::BuildInc(root + "/d/Build.txt").getBuildNumber() == 1);
+    return test::result("Scan");
+}
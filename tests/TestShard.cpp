@@ -0,0 +1,86 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// concurrent shard workers : the header never go back and ends on the highest number committed
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <atomic>
+#include <thread>
+
+// the header is replaced by a rename, a reader sees the previous or the next one
+static int64_t readHeaderNumber(const std::string& vFile) {
+    return ez::BuildInc(vFile).getBuildNumber();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto file = workDir + "/Build.h";
+    const int32_t workers = 8;
+    const int32_t runs = 20;
+    std::atomic<bool> running(true);
+    std::atomic<int32_t> backSteps(0);
+    std::thread reader([&]() {
+        int64_t last = 0;
+        while (running) {
+            const int64_t number = readHeaderNumber(file);
+            if (number < last) {
+                ++backSteps;
+            }
+            last = std::max(last, number);
+        }
+    });
+    std::vector<std::thread> threads;
+    std::vector<int32_t> failures(workers, 0);
+    for (int32_t w = 1; w <= workers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (int32_t r = 0; r < runs; ++r) {
+                if (test::runProcess({buildInc, "Toto", file, "--shard", std::to_string(w) + "/" + std::to_string(workers)}) != 0) {
+                    ++failures[w - 1];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    running = false;
+    reader.join();
+    for (const auto failure : failures) {
+        CHECK(failure == 0);
+    }
+    CHECK(backSteps == 0);
+    // each worker gave runs numbers of its sequence, an empty slot start above the header
+    const int64_t highest = ez::ShardBuildNumber(file + ".shards", 1, workers).getHighestCommitted();
+    CHECK(highest >= workers * runs);
+    CHECK(readHeaderNumber(file) == highest);
+    return test::result("Shard");
+}
@@ -0,0 +1,147 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// the json line of --stats : its shape (all the phases and the counters),
+// and the counters per phase of a FigFont build, the allocations included
+
+#include "TestUtils.hpp"
+
+static const char* s_phases[] = {"startup", "args", "read", "parse", "figfont", "render", "write", "fsync"};
+static const char* s_counters[] = {"bytesRead",    "bytesWritten",   "filesRead",      "filesWritten",     "allocations",
+                                   "allocatedBytes", "labelCacheHits", "labelCacheMisses", "frees"};
+
+// the last line of the output, the json one
+static std::string getLastLine(const std::string& vOutput) {
+    auto end = vOutput.size();
+    while (end > 0 && vOutput[end - 1] == '\n') {
+        --end;
+    }
+    const auto start = vOutput.rfind('\n', end - 1);
+    return vOutput.substr((start == std::string::npos) ? 0 : start + 1, end - ((start == std::string::npos) ? 0 : start + 1));
+}
+
+static bool isCount(const test::Json& vValue) {
+    return vValue.type == test::Json::Type::Number && vValue.number >= 0.0 && vValue.number == static_cast<double>(static_cast<int64_t>(vValue.number));
+}
+
+// all the keys, no other
+static void checkShape(const test::Json& vStats) {
+    CHECK(vStats.type == test::Json::Type::Object);
+    CHECK(isCount(vStats["pid"]) && vStats["pid"].number > 0.0);
+    CHECK(isCount(vStats["timeMs"]) && vStats["timeMs"].number > 1.7e12);  // since 1970, after 2023
+    CHECK(isCount(vStats["totalNs"]) && vStats["totalNs"].number > 0.0);
+    const auto& phases = vStats["phases"];
+    CHECK(phases.type == test::Json::Type::Object);
+    CHECK(phases.object.size() == sizeof(s_phases) / sizeof(s_phases[0]));
+    for (const auto* name : s_phases) {
+        const auto& phase = phases[name];
+        CHECK(phase.object.size() == 4U);
+        for (const auto* key : {"ns", "calls", "allocations", "allocatedBytes"}) {
+            CHECK(isCount(phase[key]));
+        }
+    }
+    for (const auto* name : s_counters) {
+        CHECK(isCount(vStats[name]));
+    }
+    CHECK(vStats.object.size() == 4U + sizeof(s_counters) / sizeof(s_counters[0]));
+}
+
+static int64_t get(const test::Json& vStats, const char* vPhase, const char* vKey) {
+    return static_cast<int64_t>(vStats["phases"][vPhase][vKey].number);
+}
+
+static int64_t get(const test::Json& vStats, const char* vCounter) {
+    return static_cast<int64_t>(vStats[vCounter].number);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+    const auto header = workDir + "/Build.h";
+    const auto out = workDir + "/out.txt";
+    const auto font = workDir + "/font.flf";
+    test::writeFile(font, test::getSyntheticFont());
+
+    // no --stats, no json
+    CHECK(test::runProcess({buildInc, "Toto", header}, out) == 0);
+    CHECK(test::readFile(out).find('{') == std::string::npos);
+    const auto headerSize = static_cast<int64_t>(test::readFile(header).size());
+
+    // --stats : the line at the end of the output
+    CHECK(test::runProcess({buildInc, "Toto", header, "-ff", font, "--stats"}, out) == 0);
+    test::Json stats;
+    CHECK(test::Json::parse(getLastLine(test::readFile(out)), stats));
+    checkShape(stats);
+    // the header read then written once, the font loaded once
+    CHECK(get(stats, "read", "calls") == 1);
+    CHECK(get(stats, "write", "calls") == 1);
+    CHECK(get(stats, "figfont", "calls") == 1);
+    CHECK(get(stats, "fsync", "calls") == 0);
+    CHECK(get(stats, "filesRead") == 1);
+    CHECK(get(stats, "bytesRead") == headerSize);
+    CHECK(get(stats, "filesWritten") == 1);
+    CHECK(get(stats, "bytesWritten") == static_cast<int64_t>(test::readFile(header).size()));
+    // the allocations of the phases are a part of the total, the font and the args allocate
+    int64_t phaseAllocations = 0, phaseBytes = 0;
+    for (const auto* name : s_phases) {
+        phaseAllocations += get(stats, name, "allocations");
+        phaseBytes += get(stats, name, "allocatedBytes");
+    }
+    CHECK(phaseAllocations > 0);
+    CHECK(phaseAllocations <= get(stats, "allocations"));
+    CHECK(phaseBytes <= get(stats, "allocatedBytes"));
+    CHECK(get(stats, "figfont", "allocations") > 0);
+    CHECK(get(stats, "args", "allocations") > 0);
+    CHECK(get(stats, "fsync", "allocations") == 0);
+    CHECK(get(stats, "frees") > 0);
+    CHECK(get(stats, "frees") <= get(stats, "allocations"));
+
+    // --fsync is a phase
+    CHECK(test::runProcess({buildInc, "Toto", header, "--fsync", "--stats"}, out) == 0);
+    CHECK(test::Json::parse(getLastLine(test::readFile(out)), stats));
+    checkShape(stats);
+    CHECK(get(stats, "fsync", "calls") >= 1);
+    CHECK(get(stats, "figfont", "allocations") == 0);  // no font to load
+
+    // --stats=<file> : one line appended per build
+    const auto statsFile = workDir + "/stats.jsonl";
+    for (int32_t run = 0; run < 3; ++run) {
+        CHECK(test::runProcess({buildInc, "Toto", header, "--stats=" + statsFile}, out) == 0);
+        CHECK(test::readFile(out).find('{') == std::string::npos);
+    }
+    std::istringstream lines(test::readFile(statsFile));
+    std::string line;
+    int32_t count = 0;
+    while (std::getline(lines, line)) {
+        CHECK(test::Json::parse(line, stats));
+        checkShape(stats);
+        ++count;
+    }
+    CHECK(count == 3);
+    return test::result("Stats");
+}
@@ -0,0 +1,130 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// work stealing pool : each task run once, wait() include the tasks added by the tasks,
+// the tasks of one worker are stolen by the others, and a scan or a bump on the pool
+// give the same result with one thread or many
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezThreadPool.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// every index once, for many thread counts
+static void testParallelFor() {
+    for (const size_t threads : {1U, 2U, 7U}) {
+        ez::ThreadPool pool(threads);
+        CHECK(pool.getThreadCount() == threads);
+        std::vector<std::atomic<int32_t>> runs(10000);
+        for (int32_t pass = 0; pass < 3; ++pass) {  // the pool is reused after a wait
+            pool.parallelFor(runs.size(), [&runs](const size_t i) { ++runs[i]; });
+        }
+        size_t wrong = 0;
+        for (const auto& run : runs) {
+            wrong += (run != 3) ? 1U : 0U;
+        }
+        CHECK(wrong == 0U);
+    }
+}
+
+// a tree of tasks submitted by the tasks, wait() return when the last leaf is done
+static void testNestedSubmit() {
+    ez::ThreadPool pool(4);
+    std::atomic<int32_t> leaves(0);
+    std::function<void(int32_t)> visit = [&pool, &leaves, &visit](const int32_t vDepth) {
+        if (vDepth == 0) {
+            ++leaves;
+            return;
+        }
+        for (int32_t i = 0; i < 4; ++i) {
+            pool.submit([&visit, vDepth]() { visit(vDepth - 1); });
+        }
+    };
+    pool.submit([&visit]() { visit(6); });
+    pool.wait();
+    CHECK(leaves == 4096);
+}
+
+// the tasks pushed by one worker in its own deque are run by the other workers too
+static void testStealing() {
+    ez::ThreadPool pool(4);
+    std::vector<std::atomic<int32_t>> perWorker(pool.getThreadCount());
+    pool.submit([&pool, &perWorker]() {
+        for (int32_t i = 0; i < 64; ++i) {
+            pool.submit([&perWorker]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                ++perWorker[static_cast<size_t>(ez::ThreadPool::getWorkerIndex())];
+            });
+        }
+    });
+    pool.wait();
+    int32_t total = 0;
+    size_t busyWorkers = 0;
+    for (const auto& count : perWorker) {
+        total += count;
+        busyWorkers += (count > 0) ? 1U : 0U;
+    }
+    CHECK(total == 64);
+    CHECK(busyWorkers > 1U);
+    CHECK(ez::ThreadPool::getWorkerIndex() == -1);
+}
+
+// the scan and the bump run on the pool, the result must not depend on the thread count
+static void testScanThreads(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const auto root = vWorkDir + "/tree";
+    const auto out = vWorkDir + "/out.txt";
+    for (int32_t i = 0; i < 60; ++i) {
+        const auto dir = root + "/d" + std::to_string(i % 7) + "/e" + std::to_string(i % 3);
+        test::makeDirs(dir);
+        CHECK(test::runProcess({vBuildInc, "P" + std::to_string(i), dir + "/P" + std::to_string(i) + ".h"}, out) == 0);
+    }
+    for (const auto threads : {"1", "2", "8"}) {
+        CHECK(test::runProcess({vBuildInc, "--scan", root, "--threads", threads, "--bump-build"}, out) == 0);
+        CHECK(test::runProcess({vBuildInc, "--scan", root, "--threads", threads, "--scan-json"}, out) == 0);
+        test::Json entries;
+        CHECK(test::Json::parse(test::readFile(out), entries) && entries.array.size() == 60U);
+        for (const auto& entry : entries.array) {  // every file bumped once more by each pass
+            CHECK(entry["BuildNumber"].number == entries.array.front()["BuildNumber"].number);
+        }
+    }
+    CHECK(ez::BuildInc(root + "/d0/e0/P0.h").getBuildNumber() == 4);
+    CHECK(ez::BuildInc(root + "/d6/e2/P41.h").getBuildNumber() == 4);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testParallelFor();
+    testNestedSubmit();
+    testStealing();
+    testScanThreads(vArgv[1], workDir);
+    return test::result("ThreadPool");
+}
@@ -0,0 +1,213 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// uniqueness of the time scheme :
+// millions of ids by threads, then by processes forced on the same start node,
+// then BuildInc processes in parallel, which must keep the other fields of their header
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <thread>
+#include <cstdlib>
+#include <algorithm>
+
+static const int32_t s_processes = 8;
+static const int32_t s_idsPerProcess = 250000;
+
+static bool isUnique(std::vector<int64_t> vIds) {
+    std::sort(vIds.begin(), vIds.end());
+    return std::adjacent_find(vIds.begin(), vIds.end()) == vIds.end();
+}
+
+// ids of many threads on one generator
+static void generate(ez::TimeBuildId& vGenerator, const int32_t vThreads, const int32_t vCount, std::vector<int64_t>& vOutIds) {
+    std::vector<std::vector<int64_t>> ids(vThreads);
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < vThreads; ++t) {
+        threads.emplace_back([&vGenerator, &ids, t, vThreads, vCount]() {
+            for (int32_t i = 0; i < vCount / vThreads; ++i) {
+                ids[t].push_back(vGenerator.next());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& part : ids) {
+        CHECK(std::is_sorted(part.begin(), part.end()));  // ordered by thread
+        vOutIds.insert(vOutIds.end(), part.begin(), part.end());
+    }
+}
+
+// child : claim a node from vNode, then write its ids in vOutFile
+static int childMain(const std::string& vLockFile, const int64_t vNode, const std::string& vOutFile) {
+    ez::FileLock nodeLock;
+    int64_t node = 0;
+    if (!ez::TimeBuildId::claimNode(vLockFile, vNode, false, nodeLock, node)) {
+        return 2;
+    }
+    ez::TimeBuildId generator(node);
+    std::vector<int64_t> ids;
+    generate(generator, 2, s_idsPerProcess, ids);
+    generator.waitPastLastId();
+    std::ofstream file(vOutFile, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(ids.data()), static_cast<std::streamsize>(ids.size() * sizeof(int64_t)));
+    return file ? 0 : 3;
+}
+
+static void testThreads() {
+    ez::TimeBuildId generator(42);
+    std::vector<int64_t> ids;
+    generate(generator, 8, 2000000, ids);
+    CHECK(ids.size() == 2000000U);
+    CHECK(isUnique(ids));
+}
+
+static void testClaim(const std::string& vWorkDir) {
+    const auto lockFile = vWorkDir + "/nodes";
+    ez::FileLock first, second, exact;
+    int64_t firstNode = -1, secondNode = -1, exactNode = -1;
+    CHECK(ez::TimeBuildId::claimNode(lockFile, 7, false, first, firstNode));
+    CHECK(firstNode == 7);
+    CHECK(ez::TimeBuildId::claimNode(lockFile, 7, false, second, secondNode));  // same start node
+    CHECK(secondNode == 8);
+    CHECK(!ez::TimeBuildId::claimNode(lockFile, 7, true, exact, exactNode));  // given node in use
+    CHECK(exact.wasBusy());
+    CHECK(ez::TimeBuildId::claimNode(lockFile, ez::TimeBuildId::nodeMask, false, exact, exactNode));  // wrap
+    CHECK(exactNode == ez::TimeBuildId::nodeMask);
+    first.unlock();
+    exact.unlock();
+    CHECK(ez::TimeBuildId::claimNode(lockFile, 7, true, exact, exactNode));
+    // a lock file not openable is not a busy node
+    ez::FileLock missing;
+    CHECK(!ez::TimeBuildId::claimNode(vWorkDir + "/missing/nodes", 7, false, missing, exactNode));
+    CHECK(!missing.wasBusy());
+}
+
+// all the processes start on the same node, as a collision of hostname hash ^ pid would do.
+// two rounds, so the nodes released by the first round are claimed again
+static void testProcesses(const std::string& vSelf, const std::string& vWorkDir) {
+    const auto lockFile = vWorkDir + "/nodes";
+    std::vector<int64_t> all;
+    for (int32_t round = 0; round < 2; ++round) {
+        std::vector<std::thread> threads;
+        std::vector<int32_t> codes(s_processes, -1);
+        for (int32_t p = 0; p < s_processes; ++p) {
+            threads.emplace_back([&, p]() {
+                const auto outFile = vWorkDir + "/ids." + std::to_string(round) + "." + std::to_string(p);
+                codes[p] = test::runProcess({vSelf, "--generate", lockFile, "1000", outFile});
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (int32_t p = 0; p < s_processes; ++p) {
+            CHECK(codes[p] == 0);
+            const auto content = test::readFile(vWorkDir + "/ids." + std::to_string(round) + "." + std::to_string(p));
+            CHECK(content.size() == s_idsPerProcess * sizeof(int64_t));
+            const auto* ids = reinterpret_cast<const int64_t*>(content.data());
+            all.insert(all.end(), ids, ids + content.size() / sizeof(int64_t));
+        }
+    }
+    CHECK(all.size() == 2U * s_processes * s_idsPerProcess);
+    CHECK(isUnique(all));
+}
+
+// the time scheme replaces only the build number, the header is read as for the counter
+static void testBuildInc(const std::string& vBuildInc, const std::string& vWorkDir) {
+    unsetenv("XDG_RUNTIME_DIR");
+    setenv("TMPDIR", vWorkDir.c_str(), 1);  // node lock file of the spawned BuildInc, per user
+    CHECK(ez::TimeBuildId::getNodeLockFile() == vWorkDir + "/buildinc-nodes-" + std::to_string(getuid()));
+    const std::string header =
+        "#pragma once\n\n"
+        "#define Toto_Label \"Toto\"\n"
+        "#define Toto_BuildNumber 12\n"
+        "#define Toto_MinorNumber 5\n"
+        "#define Toto_MajorNumber 2\n"
+        "#define Toto_BuildId \"2.5.12\"\n"
+        "#define Toto_Channel \"beta\"\n"
+        "// foreign line\n";
+    const int32_t count = 16;
+    std::vector<std::thread> threads;
+    std::vector<int32_t> codes(count, -1);
+    for (int32_t p = 0; p < count; ++p) {
+        const auto file = vWorkDir + "/Build" + std::to_string(p) + ".h";
+        test::writeFile(file, header);
+        threads.emplace_back([&, p, file]() {  //
+            codes[p] = test::runProcess({vBuildInc, "Toto", file, "--id-scheme", "time", "--set", "Arch=x64"});
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::vector<int64_t> numbers;
+    for (int32_t p = 0; p < count; ++p) {
+        CHECK(codes[p] == 0);
+        const auto file = vWorkDir + "/Build" + std::to_string(p) + ".h";
+        const auto content = test::readFile(file);
+        CHECK(content.find("#define Toto_MajorNumber 2\n") != std::string::npos);
+        CHECK(content.find("#define Toto_MinorNumber 5\n") != std::string::npos);
+        CHECK(content.find("#define Toto_Channel \"beta\"\n") != std::string::npos);
+        CHECK(content.find("#define Toto_Arch \"x64\"\n") != std::string::npos);
+        CHECK(content.find("// foreign line\n") != std::string::npos);
+        ez::BuildInc builder(file);
+        CHECK(builder.getBuildNumber() > 12);
+        numbers.push_back(builder.getBuildNumber());
+    }
+    CHECK(isUnique(numbers));
+    // a given node used by another process of the host is a collision
+    ez::FileLock nodeLock;
+    int64_t node = 0;
+    CHECK(ez::TimeBuildId::claimNode(ez::TimeBuildId::getNodeLockFile(), 99, true, nodeLock, node));
+    const auto file = vWorkDir + "/Build0.h";
+    CHECK(test::runProcess({vBuildInc, "Toto", file, "--id-scheme", "time", "--node-id", "99"}) == 1);
+    CHECK(test::runProcess({vBuildInc, "Toto", file, "--id-scheme", "time", "--node-id", "100"}) == 0);
+    CHECK(test::runProcess({vBuildInc, "Toto", file, "--id-scheme", "time", "--node-id", "16384"}) == 1);
+    const auto out = vWorkDir + "/claim.out";
+    CHECK(test::runProcess({vBuildInc, "Toto", file, "--id-scheme", "time", "--node-id", "99"}, out) == 1);
+    CHECK(test::readFile(out).find("is used by another process") != std::string::npos);
+    // the lock file of the nodes can't be opened, reported as is
+    setenv("TMPDIR", (vWorkDir + "/missing").c_str(), 1);
+    CHECK(test::runProcess({vBuildInc, "Toto", file, "--id-scheme", "time"}, out) == 1);
+    CHECK(test::readFile(out).find("failed to open the lock file of the nodes") != std::string::npos);
+    setenv("TMPDIR", vWorkDir.c_str(), 1);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc == 5 && std::string(vArgv[1]) == "--generate") {
+        return childMain(vArgv[2], std::atoll(vArgv[3]), vArgv[4]);
+    }
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testThreads();
+    testClaim(workDir);
+    testProcesses(vArgv[0], workDir);
+    testBuildInc(vArgv[1], workDir);
+    return test::result("TimeBuildId");
+}
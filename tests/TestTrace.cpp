@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// concurrent builds tracing in one shared file, then in a directory :
+// the lines of the shared file are never interleaved, and the merged trace is a valid chrome trace
+// with one pid per process and the events sorted by time
+
+#include "TestUtils.hpp"
+
+#include <set>
+
+static const int32_t s_processes = 8;
+
+// the builds at the same time, their pids
+static std::set<int64_t> runBuilds(const std::string& vBuildInc, const std::string& vWorkDir, const std::string& vTrace) {
+    std::vector<pid_t> pids;
+    for (int32_t p = 0; p < s_processes; ++p) {
+        // two builds per header, they also wait each other on its lock
+        const auto header = vWorkDir + "/Build" + std::to_string(p / 2) + ".h";
+        pids.push_back(test::startProcess({vBuildInc, "Toto", header, "--trace=" + vTrace}, vWorkDir + "/out" + std::to_string(p) + ".txt"));
+    }
+    std::set<int64_t> ret;
+    for (const auto pid : pids) {
+        CHECK(test::waitProcess(pid) == 0);
+        ret.insert(static_cast<int64_t>(pid));
+    }
+    return ret;
+}
+
+// each line of the shared file is one event : '[' then '{..},'
+static void checkSharedFile(const std::string& vFile, const std::set<int64_t>& vPids) {
+    std::istringstream lines(test::readFile(vFile));
+    std::string line;
+    CHECK(std::getline(lines, line) && line == "[");
+    std::set<int64_t> pids;
+    int32_t count = 0;
+    while (std::getline(lines, line)) {
+        CHECK(!line.empty() && line.back() == ',');
+        test::Json event;
+        CHECK(test::Json::parse(line.substr(0, line.size() - 1), event));
+        pids.insert(static_cast<int64_t>(event["pid"].number));
+        ++count;
+    }
+    CHECK(pids == vPids);
+    CHECK(count > s_processes * 4);
+}
+
+static void checkMergedTrace(const std::string& vFile, const std::set<int64_t>& vPids) {
+    test::Json trace;
+    CHECK(test::Json::parse(test::readFile(vFile), trace));
+    CHECK(trace.type == test::Json::Type::Object);
+    const auto& events = trace["traceEvents"];
+    CHECK(events.type == test::Json::Type::Array);
+    std::set<int64_t> namedPids, spanPids, writePids;
+    double lastTs = -1.0;
+    for (const auto& event : events.array) {
+        CHECK(event.type == test::Json::Type::Object);
+        CHECK(event["name"].type == test::Json::Type::String);
+        CHECK(event["ph"].type == test::Json::Type::String);
+        CHECK(event["ts"].type == test::Json::Type::Number);
+        CHECK(event["pid"].type == test::Json::Type::Number);
+        CHECK(event["tid"].type == test::Json::Type::Number);
+        CHECK(event["ts"].number >= lastTs);  // sorted, the metadata first at 0
+        lastTs = event["ts"].number;
+        const auto pid = static_cast<int64_t>(event["pid"].number);
+        if (event["ph"].string == "M") {
+            CHECK(event["name"].string == "process_name");
+            CHECK(event["args"]["name"].string == "BuildInc Toto");
+            CHECK(namedPids.insert(pid).second);  // one process_name per process
+        } else {
+            CHECK(event["ph"].string == "X");
+            CHECK(event["cat"].type == test::Json::Type::String);
+            CHECK(event["dur"].type == test::Json::Type::Number && event["dur"].number >= 0.0);
+            spanPids.insert(pid);
+            if (event["name"].string == "write") {
+                writePids.insert(pid);
+            }
+        }
+    }
+    CHECK(namedPids == vPids);
+    CHECK(spanPids == vPids);
+    CHECK(writePids == vPids);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const std::string buildInc = vArgv[1];
+    const auto workDir = test::resetDir(vArgv[2]);
+
+    // one file shared by the builds, appended under a lock
+    const auto traceFile = workDir + "/builds.trace";
+    const auto filePids = runBuilds(buildInc, workDir, traceFile);
+    CHECK(filePids.size() == static_cast<size_t>(s_processes));
+    checkSharedFile(traceFile, filePids);
+    CHECK(test::runProcess({buildInc, "--trace-merge", traceFile, "--trace-out", workDir + "/file.json"}) == 0);
+    checkMergedTrace(workDir + "/file.json", filePids);
+
+    // one file per build in a directory
+    const auto traceDir = test::resetDir(workDir + "/traces");
+    const auto dirPids = runBuilds(buildInc, workDir, traceDir);
+    CHECK(test::runProcess({buildInc, "--trace-merge", traceDir, "--trace-out", workDir + "/dir.json"}) == 0);
+    checkMergedTrace(workDir + "/dir.json", dirPids);
+    return test::result("Trace");
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// helpers shared by the tests :
+// a test is an executable called by ctest with the BuildInc executable and a work dir,
+// it returns 0 when all its checks pass
+
+#include <ftw.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include <map>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+extern char** environ;
+
+namespace test {
+
+inline int32_t& failures() {
+    static int32_t s_failures = 0;
+    return s_failures;
+}
+
+inline bool check(const bool vCond, const char* vExpr, const char* vFile, const int32_t vLine) {
+    if (!vCond) {
+        std::cerr << vFile << ":" << vLine << ": check failed : " << vExpr << std::endl;
+        ++failures();
+    }
+    return vCond;
+}
+
+#define CHECK(expr) test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+// the exit code of the tests
+inline int32_t result(const char* vName) {
+    if (failures() != 0) {
+        std::cerr << vName << " : " << failures() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << vName << " : ok" << std::endl;
+    return 0;
+}
+
+// start a process, the stdout goes to vStdOutFile or /dev/null. returns its pid, -1 if not started
+inline pid_t startProcess(const std::vector<std::string>& vArgs, const std::string& vStdOutFile = {}) {
+    std::vector<char*> argv;
+    for (const auto& arg : vArgs) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (vStdOutFile.empty()) {
+        posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, 1, vStdOutFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    pid_t pid = 0;
+    const int err = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    return (err == 0) ? pid : -1;
+}
+
+// wait for the end of a process, returns its exit code, -1 if killed
+inline int32_t waitProcess(const pid_t vPid) {
+    if (vPid < 0) {
+        return -1;
+    }
+    int status = 0;
+    while (waitpid(vPid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+inline int32_t runProcess(const std::vector<std::string>& vArgs, const std::string& vStdOutFile = {}) {
+    return waitProcess(startProcess(vArgs, vStdOutFile));
+}
+
+inline std::string readFile(const std::string& vFilePathName) {
+    std::ifstream file(vFilePathName, std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+inline bool writeFile(const std::string& vFilePathName, const std::string& vContent) {
+    std::ofstream file(vFilePathName, std::ios::binary | std::ios::trunc);
+    file << vContent;
+    return static_cast<bool>(file);
+}
+
+inline bool isFileExist(const std::string& vFilePathName) {
+    struct stat st = {};
+    return stat(vFilePathName.c_str(), &st) == 0;
+}
+
+inline void makeDirs(const std::string& vPath) {
+    for (size_t pos = vPath.find('/', 1); pos != std::string::npos; pos = vPath.find('/', pos + 1)) {
+        mkdir(vPath.substr(0, pos).c_str(), 0755);
+    }
+    mkdir(vPath.c_str(), 0755);
+}
+
+inline void removeTree(const std::string& vPath) {
+    nftw(
+        vPath.c_str(),
+        [](const char* vFile, const struct stat*, int, struct FTW*) { return ::remove(vFile); },
+        16,
+        FTW_DEPTH | FTW_PHYS);
+}
+
+// an empty work dir
+inline std::string resetDir(const std::string& vPath) {
+    removeTree(vPath);
+    makeDirs(vPath);
+    return vPath;
+}
+
+// a small FigFont, every glyph is a box of its char drawn with vBorder
+inline std::string getSyntheticFont(const char vBorder = '+') {
+    static constexpr int32_t height = 4;
+    std::string ret = "flf2a$ 4 3 8 0 0\n";
+    const auto addGlyph = [&ret, vBorder](const char vChar) {
+        for (int32_t row = 0; row < height; ++row) {
+            const char c = (vChar == ' ') ? '$' : vChar;
+            if (row == 0 || row == height - 1) {
+                ret += std::string(1, vBorder) + std::string(3, c) + vBorder;
+            } else {
+                ret += std::string(1, '|') + c + "$" + c + "|";
+            }
+            ret += (row == height - 1) ? "@@\n" : "@\n";
+        }
+    };
+    for (char c = 32; c < 127; ++c) {
+        addGlyph(c);
+    }
+    for (int32_t i = 0; i < 7; ++i) {  // the german chars
+        addGlyph('?');
+    }
+    return ret;
+}
+
+// a strict json parser, for check the outputs of BuildInc :
+// no trailing comma, no control char in the strings, no garbage after the value
+struct Json {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Json> array;
+    std::map<std::string, Json> object;
+
+    bool has(const std::string& vKey) const { return object.find(vKey) != object.end(); }
+    const Json& operator[](const std::string& vKey) const {
+        static const Json s_null;
+        const auto it = object.find(vKey);
+        return (it == object.end()) ? s_null : it->second;
+    }
+
+    static bool parse(const std::string& vText, Json& vOut) {
+        size_t pos = 0;
+        vOut = Json();
+        return m_parseValue(vText, pos, vOut) && m_skipSpaces(vText, pos) == vText.size();
+    }
+
+private:
+    static size_t m_skipSpaces(const std::string& vText, size_t& vPos) {
+        while (vPos < vText.size() && (vText[vPos] == ' ' || vText[vPos] == '\t' || vText[vPos] == '\n' || vText[vPos] == '\r')) {
+            ++vPos;
+        }
+        return vPos;
+    }
+    static bool m_parseValue(const std::string& vText, size_t& vPos, Json& vOut) {
+        if (m_skipSpaces(vText, vPos) >= vText.size()) {
+            return false;
+        }
+        const char c = vText[vPos];
+        if (c == '{') {
+            vOut.type = Type::Object;
+            ++vPos;
+            if (m_skipSpaces(vText, vPos) < vText.size() && vText[vPos] == '}') {
+                ++vPos;
+                return true;
+            }
+            while (true) {
+                Json key;
+                if (m_skipSpaces(vText, vPos) >= vText.size() || vText[vPos] != '"' || !m_parseString(vText, vPos, key.string) ||
+                    m_skipSpaces(vText, vPos) >= vText.size() || vText[vPos++] != ':' || !m_parseValue(vText, vPos, vOut.object[key.string])) {
+                    return false;
+                }
+                if (m_skipSpaces(vText, vPos) >= vText.size()) {
+                    return false;
+                }
+                if (vText[vPos] == '}') {
+                    ++vPos;
+                    return true;
+                }
+                if (vText[vPos++] != ',') {
+                    return false;
+                }
+            }
+        }
+        if (c == '[') {
+            vOut.type = Type::Array;
+            ++vPos;
+            if (m_skipSpaces(vText, vPos) < vText.size() && vText[vPos] == ']') {
+                ++vPos;
+                return true;
+            }
+            while (true) {
+                vOut.array.emplace_back();
+                if (!m_parseValue(vText, vPos, vOut.array.back()) || m_skipSpaces(vText, vPos) >= vText.size()) {
+                    return false;
+                }
+                if (vText[vPos] == ']') {
+                    ++vPos;
+                    return true;
+                }
+                if (vText[vPos++] != ',') {
+                    return false;
+                }
+            }
+        }
+        if (c == '"') {
+            vOut.type = Type::String;
+            return m_parseString(vText, vPos, vOut.string);
+        }
+        for (const char* word : {"true", "false", "null"}) {
+            if (vText.compare(vPos, std::string(word).size(), word) == 0) {
+                vOut.type = (word[0] == 'n') ? Type::Null : Type::Bool;
+                vOut.boolean = (word[0] == 't');
+                vPos += std::string(word).size();
+                return true;
+            }
+        }
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+        const size_t start = vPos;
+        auto digits = [&]() {
+            const size_t first = vPos;
+            while (vPos < vText.size() && vText[vPos] >= '0' && vText[vPos] <= '9') {
+                ++vPos;
+            }
+            return vPos > first;
+        };
+        if (vText[vPos] == '-') {
+            ++vPos;
+        }
+        if (vPos < vText.size() && vText[vPos] == '0') {
+            ++vPos;
+        } else if (!digits()) {
+            return false;
+        }
+        if (vPos < vText.size() && vText[vPos] == '.' && (++vPos, !digits())) {
+            return false;
+        }
+        if (vPos < vText.size() && (vText[vPos] == 'e' || vText[vPos] == 'E')) {
+            ++vPos;
+            if (vPos < vText.size() && (vText[vPos] == '+' || vText[vPos] == '-')) {
+                ++vPos;
+            }
+            if (!digits()) {
+                return false;
+            }
+        }
+        vOut.type = Type::Number;
+        vOut.number = std::strtod(vText.substr(start, vPos - start).c_str(), nullptr);
+        return true;
+    }
+    // the escapes are decoded, \u to utf8
+    static bool m_parseString(const std::string& vText, size_t& vPos, std::string& vOut) {
+        ++vPos;  // "
+        while (vPos < vText.size()) {
+            const auto c = static_cast<unsigned char>(vText[vPos++]);
+            if (c == '"') {
+                return true;
+            }
+            if (c < 0x20) {
+                return false;  // must be escaped
+            }
+            if (c != '\\') {
+                vOut += static_cast<char>(c);
+                continue;
+            }
+            if (vPos >= vText.size()) {
+                return false;
+            }
+            const char e = vText[vPos++];
+            switch (e) {
+                case '"': vOut += '"'; break;
+                case '\\': vOut += '\\'; break;
+                case '/': vOut += '/'; break;
+                case 'b': vOut += '\b'; break;
+                case 'f': vOut += '\f'; break;
+                case 'n': vOut += '\n'; break;
+                case 'r': vOut += '\r'; break;
+                case 't': vOut += '\t'; break;
+                case 'u': {
+                    if (vPos + 4 > vText.size()) {
+                        return false;
+                    }
+                    char* end = nullptr;
+                    const std::string hex = vText.substr(vPos, 4);
+                    const auto code = static_cast<uint32_t>(std::strtoul(hex.c_str(), &end, 16));
+                    if (end != hex.c_str() + 4) {
+                        return false;
+                    }
+                    vPos += 4;
+                    if (code < 0x80) {
+                        vOut += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        vOut += static_cast<char>(0xC0 | (code >> 6));
+                        vOut += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {  // the surrogates are kept as is, not needed here
+                        vOut += static_cast<char>(0xE0 | (code >> 12));
+                        vOut += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        vOut += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace test
@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// watch mode :
+// the latency from a change of the FigFont to the header regenerated by a resident BuildInc,
+// and a change lost in an overflow of the inotify queue must still be reported.
+// a signal handled by the process during the wait does not end the watch
+
+#include "TestUtils.hpp"
+
+#include <ezlibs/ezBuildInc.hpp>
+#include <ezlibs/ezFileWatcher.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <pthread.h>
+#include <algorithm>
+
+typedef std::chrono::steady_clock Clock;
+
+static double getElapsedMs(const Clock::time_point& vStart) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - vStart).count();
+}
+
+// wait until the content of the file differ from vPrevious, returns false at the timeout
+static bool waitChange(const std::string& vFile, const std::string& vPrevious, const double vTimeoutMs, std::string& vOutContent) {
+    const auto start = Clock::now();
+    while (getElapsedMs(start) < vTimeoutMs) {
+        vOutContent = test::readFile(vFile);
+        if (!vOutContent.empty() && vOutContent != vPrevious) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return false;
+}
+
+// the font is swapped between two FigFonts, the resident BuildInc must regenerate the banner each time
+static void testLatency(const std::string& vBuildInc, const std::string& vWorkDir) {
+    const int32_t changes = 20;
+    const auto header = vWorkDir + "/Build.h";
+    const auto font = vWorkDir + "/font.flf";
+    const std::string fonts[2] = {test::getSyntheticFont('+'), test::getSyntheticFont('*')};
+    test::writeFile(font, fonts[0]);
+    const pid_t pid = test::startProcess({vBuildInc, "Toto", header, "-ff", font, "--watch", "--watch-debounce", "10"});
+    CHECK(pid > 0);
+    std::string content;
+    CHECK(waitChange(header, {}, 5000.0, content));
+    const int64_t buildNumber = ez::BuildInc(header).getBuildNumber();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));  // the watch is set after the first generation
+    std::vector<double> latencies;
+    for (int32_t i = 1; i <= changes; ++i) {
+        const auto previous = test::readFile(header);
+        const auto start = Clock::now();
+        test::writeFile(font, fonts[i % 2]);
+        if (CHECK(waitChange(header, previous, 2000.0, content))) {
+            latencies.push_back(getElapsedMs(start));
+        }
+    }
+    ::kill(pid, SIGTERM);
+    test::waitProcess(pid);
+    CHECK(ez::BuildInc(header).getBuildNumber() == buildNumber);  // not incremented by the watch
+    CHECK(latencies.size() == static_cast<size_t>(changes));
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << "watch : latency of " << latencies.size() << " changes, debounce 10 ms, median " << latencies.at(latencies.size() / 2)  //
+                  << " ms, max " << latencies.back() << " ms" << std::endl;
+        CHECK(latencies.back() < 1000.0);
+    }
+}
+
+// the queue is filled by the events of other files, the event of the watched file is lost in the overflow
+static void testOverflow(const std::string& vWorkDir) {
+    const auto dir = test::resetDir(vWorkDir + "/overflow");
+    const auto watched = dir + "/Build.h";
+    test::writeFile(watched, "a");
+    ez::FileWatcher watcher;
+    CHECK(watcher.addFile(watched));
+    int32_t maxEvents = std::atoi(test::readFile("/proc/sys/fs/inotify/max_queued_events").c_str());
+    if (maxEvents <= 0) {
+        maxEvents = 16384;
+    }
+    for (int32_t i = 0; i <= maxEvents; ++i) {  // one event by creation at least
+        test::writeFile(dir + "/other" + std::to_string(i), {});
+    }
+    test::writeFile(watched, "b");
+    std::atomic<bool> done(false);
+    std::vector<std::string> changed;
+    std::thread waiter([&]() {
+        watcher.wait(changed, 10);
+        done = true;
+    });
+    const auto start = Clock::now();
+    while (!done && getElapsedMs(start) < 2000.0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(done);
+    if (!done) {
+        test::writeFile(watched, "c");  // unblock the wait
+    }
+    waiter.join();
+    CHECK(std::find(changed.begin(), changed.end(), watched) != changed.end());
+}
+
+static void onSignal(int) {}
+
+// the poll of the wait is interrupted by a handled signal (EINTR), the wait goes on until the change
+static void testSignal(const std::string& vWorkDir) {
+    const auto dir = test::resetDir(vWorkDir + "/signal");
+    const auto watched = dir + "/Build.h";
+    test::writeFile(watched, "a");
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = 0;  // no SA_RESTART, poll is never restarted anyway
+    CHECK(sigaction(SIGUSR1, &action, nullptr) == 0);
+    ez::FileWatcher watcher;
+    CHECK(watcher.addFile(watched));
+    std::atomic<bool> done(false);
+    bool ret = false;
+    std::vector<std::string> changed;
+    std::thread waiter([&]() {
+        ret = watcher.wait(changed, 10);
+        done = true;
+    });
+    for (int32_t i = 0; i < 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        pthread_kill(waiter.native_handle(), SIGUSR1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!done);  // still waiting
+    test::writeFile(watched, "b");
+    const auto start = Clock::now();
+    while (!done && getElapsedMs(start) < 2000.0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        pthread_kill(waiter.native_handle(), SIGUSR1);  // during the debounce too
+    }
+    CHECK(done);
+    if (!done) {
+        test::writeFile(watched, "c");  // unblock the wait
+    }
+    waiter.join();
+    CHECK(ret);
+    CHECK(std::find(changed.begin(), changed.end(), watched) != changed.end());
+    signal(SIGUSR1, SIG_DFL);
+}
+
+int main(int vArgc, char* vArgv[]) {
+    if (vArgc != 3) {
+        std::cerr << "usage : " << vArgv[0] << " <BuildInc> <work dir>" << std::endl;
+        return 1;
+    }
+    const auto workDir = test::resetDir(vArgv[2]);
+    testLatency(vArgv[1], workDir);
+    testOverflow(workDir);
+    testSignal(workDir);
+    return test::result("Watch");
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// counting global operator new/delete for the benchmarks of the tools dir.
+// to include in one translation unit of the tool only, the operators are not inline.
+// the size is kept before each block, for the bytes still allocated
+
+#include <new>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+
+// the free is kept out of the inlined operators, gcc would see a malloc'd block
+// given by new and warn with -Wmismatched-new-delete and -Warray-bounds
+#if defined(_MSC_VER)
+#define NOINLINE_DEALLOCATE __declspec(noinline)
+#else
+#define NOINLINE_DEALLOCATE __attribute__((noinline))
+#endif
+
+namespace bench {
+
+inline std::atomic<int64_t>& allocations() {
+    static std::atomic<int64_t> s_allocations(0);
+    return s_allocations;
+}
+
+inline std::atomic<int64_t>& allocatedBytes() {
+    static std::atomic<int64_t> s_allocatedBytes(0);
+    return s_allocatedBytes;
+}
+
+// allocated and not freed yet
+inline std::atomic<int64_t>& liveBytes() {
+    static std::atomic<int64_t> s_liveBytes(0);
+    return s_liveBytes;
+}
+
+// the max of the live bytes, since the last reset
+inline std::atomic<int64_t>& peakBytes() {
+    static std::atomic<int64_t> s_peakBytes(0);
+    return s_peakBytes;
+}
+
+inline void resetPeak() {
+    peakBytes().store(liveBytes().load());
+}
+
+static constexpr size_t allocationPrefix = alignof(std::max_align_t);
+
+inline void* allocate(std::size_t vSize) noexcept {
+    allocations().fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes().fetch_add(static_cast<int64_t>(vSize), std::memory_order_relaxed);
+    const auto live = liveBytes().fetch_add(static_cast<int64_t>(vSize), std::memory_order_relaxed) + static_cast<int64_t>(vSize);
+    auto peak = peakBytes().load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes().compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    auto* ptr = static_cast<char*>(std::malloc(vSize + allocationPrefix));
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+    *reinterpret_cast<std::size_t*>(ptr) = vSize;
+    return ptr + allocationPrefix;
+}
+
+NOINLINE_DEALLOCATE inline void deallocate(void* vPtr) noexcept {
+    if (vPtr != nullptr) {
+        auto* ptr = static_cast<char*>(vPtr) - allocationPrefix;
+        liveBytes().fetch_sub(static_cast<int64_t>(*reinterpret_cast<std::size_t*>(ptr)), std::memory_order_relaxed);
+        std::free(ptr);
+    }
+}
+
+}  // namespace bench
+
+void* operator new(std::size_t vSize) {
+    if (void* ptr = bench::allocate(vSize)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t vSize) {
+    return operator new(vSize);
+}
+void* operator new(std::size_t vSize, const std::nothrow_t&) noexcept {
+    return bench::allocate(vSize);
+}
+void* operator new[](std::size_t vSize, const std::nothrow_t&) noexcept {
+    return bench::allocate(vSize);
+}
+void operator delete(void* vPtr) noexcept {
+    bench::deallocate(vPtr);
+}
+void operator delete[](void* vPtr) noexcept {
+    bench::deallocate(vPtr);
+}
+void operator delete(void* vPtr, std::size_t) noexcept {
+    bench::deallocate(vPtr);
+}
+void operator delete[](void* vPtr, std::size_t) noexcept {
+    bench::deallocate(vPtr);
+}
+void operator delete(void* vPtr, const std::nothrow_t&) noexcept {
+    bench::deallocate(vPtr);
+}
+void operator delete[](void* vPtr, const std::nothrow_t&) noexcept {
+    bench::deallocate(vPtr);
+}
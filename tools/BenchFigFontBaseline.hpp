@@ -0,0 +1,521 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2014-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// ezFigFont of ezLibs before the glyph index and the one allocation renderer, kept as the reference of BuildIncFigFontBench :
+// a std::map of row vectors while parsing, a binary search per glyph per row, and a render by rows through a stringstream
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <sys/stat.h>
+
+#include <ezlibs/ezLog.hpp>
+#include <ezlibs/ezMappedFile.hpp>
+
+#ifdef WINDOWS_OS
+#include <process.h>
+#endif
+
+namespace ez_baseline {
+
+using ez::MappedFile;
+
+/* Binary FigFont (.bff), a compiled .flf mapped at load without parsing :
+ [BffHeader][source path, padded to 4 bytes][codes : int32 x glyphCount, sorted]
+ [row offsets : uint32 x (glyphCount * height + 1)][row data]
+ the row r of the glyph g is rowData[rowOffsets[g * height + r], rowOffsets[g * height + r + 1])
+ the source .flf is checked at load (mtime and size, then hash) and the cache is rebuilt if it changed.
+ the numbers are in the native endianness
+*/
+class FigFont {
+public:
+    static constexpr uint32_t bffVersion = 1;
+
+private:
+    struct BffHeader {
+        char magic[4];  // 'EZFF'
+        uint32_t version;
+        int32_t height;
+        int32_t baseline;
+        int32_t maxLength;
+        int32_t oldLayout;
+        int32_t fullLayout;
+        int32_t printDirection;
+        int32_t codetagCount;
+        uint32_t hardblank;
+        uint32_t glyphCount;
+        uint32_t rowDataSize;
+        uint32_t sourcePathSize;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceMtime;  // nanoseconds
+        uint64_t sourceHash;  // FNV-1a of the .flf
+    };
+    static_assert(sizeof(BffHeader) == 80, "the BffHeader must not have padding");
+    struct Source {
+        std::string path;  // the .flf
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+    };
+
+	bool m_isValid{false};
+    struct Header {
+        uint8_t endChar{};
+        uint8_t hardblank{};  // Filling char
+        int32_t height{};  // char height
+        int32_t baseline{};  // base line from top
+        int32_t maxLength{};  // max width of achar
+        int32_t oldLayout{}; // Old Layout
+        int32_t commentLines{};  // Comments line count just after header line
+        int32_t printDirection{};  // printing direction
+        int32_t fullLayout{};  // Full Layout
+        int32_t codetagCount{};  // codeTagCount (optional)
+        std::vector<std::string> commentBlock;
+    } m_header;
+    // the glyphs, in the owned buffers for a .flf, in the mapping for a .bff
+    const int32_t* m_codes = nullptr;
+    const uint32_t* m_rowOffsets = nullptr;
+    const char* m_rowData = nullptr;
+    uint32_t m_glyphCount = 0;
+    std::vector<int32_t> m_ownCodes;
+    std::vector<uint32_t> m_ownRowOffsets;
+    std::vector<char> m_ownRowData;
+    MappedFile m_mapped;
+    Source m_source;
+
+public:
+    FigFont() = default;
+    FigFont(const std::string& vFilePathName) { load(vFilePathName); }  // the members must be constructed before m_load
+    ~FigFont() = default;
+    bool isValid() { return m_isValid; }
+    // a .bff file is mapped, else the file is parsed as a .flf
+    FigFont& load(const std::string& vFilePathName) {
+        m_isValid = m_load(vFilePathName);
+        return *this;
+	}
+    std::string printString(const std::string& vPattern) {
+        return m_printString(vPattern);
+    }
+    // write the loaded font as a .bff, it will be rebuilt at load if the source .flf change
+    bool compile(const std::string& vBffFilePathName) {
+        return m_isValid && m_writeBff(vBffFilePathName);
+    }
+    // the .flf of the font, the file loaded or the source of the .bff
+    const std::string& getSourceFile() { return m_source.path; }
+    bool isMapped() { return m_mapped.getData() != nullptr; }
+	
+private:
+    static bool m_isBffFile(const std::string& vFilePathName) {
+        return vFilePathName.size() > 4 && vFilePathName.compare(vFilePathName.size() - 4, 4, ".bff") == 0;
+    }
+
+	bool m_load(const std::string& vFilePathName) {
+        m_reset();
+        if (vFilePathName.empty()) {
+            return false;
+        }
+        if (m_isBffFile(vFilePathName)) {
+            return m_loadBff(vFilePathName);
+        }
+        std::string content;
+        if (!m_readFile(vFilePathName, content)) {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Failed to open the file %s", vFilePathName.c_str());
+#endif // EZ_TOOLS_LOG
+            return false;
+        }
+        m_source.path = vFilePathName;
+        m_getFileInfos(vFilePathName, m_source.size, m_source.mtime);
+        m_source.hash = m_getHash(content);
+        return m_parseFlf(content);
+    }
+
+    void m_reset() {
+        m_mapped.close();
+        m_codes = nullptr;
+        m_rowOffsets = nullptr;
+        m_rowData = nullptr;
+        m_glyphCount = 0;
+        m_ownCodes.clear();
+        m_ownRowOffsets.clear();
+        m_ownRowData.clear();
+        m_source = Source();
+    }
+
+    bool m_parseFlf(const std::string& vContent) {
+        std::istringstream file(vContent);
+        std::string header;
+        std::getline(file, header);
+        m_trimCR(header);
+        std::istringstream headerStream(header);
+        std::string magicNumber;
+        headerStream >> magicNumber;
+        if (magicNumber.substr(0, 5) != "flf2a") {
+#ifdef EZ_TOOLS_LOG
+            LogVarError("%s", "Not a valid FIGfont file");
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+
+        /*
+          flf2a$ 6 5 20 15 3 0 143 229    NOTE: The first five characters in
+            |  | | | |  |  | |  |   |     the entire file must be "flf2a".			
+           /  /  | | |  |  | |  |    \		   
+  Signature  /  /  | |  |  | |   \   Codetag_Count
+    Hardblank  /  /  |  |  |  \   Full_Layout*
+         Height  /   |  |   \  Print_Direction
+         Baseline   /    \   Comment_Lines
+          Max_Length      Old_Layout*
+        */
+        m_header.hardblank = magicNumber[5];
+        headerStream >>  //
+            m_header.height >>  //
+            m_header.baseline >>  //
+            m_header.oldLayout >>  //
+            m_header.maxLength >>  //
+            m_header.commentLines >>  //
+            m_header.printDirection >>  //
+            m_header.fullLayout >>  //
+            m_header.codetagCount;
+
+        std::string line;
+        m_header.commentBlock.clear();
+        m_header.commentBlock.reserve(m_header.commentLines);
+        for (int i = 0; i < m_header.commentLines; ++i) {
+            std::getline(file, line);
+            m_header.commentBlock.push_back(line);
+        }
+        size_t idx = 0;
+        static constexpr size_t baseChar = 32;
+        static constexpr size_t required_chars_count = 127 - baseChar;
+        static constexpr size_t additionnal_chars_count = 7;
+        std::array<size_t, additionnal_chars_count> additionnal_chars{196, 214, 220, 228, 246, 252, 223};
+        size_t cChar = baseChar;
+        std::map<int32_t, std::vector<std::string>> glyphs;  // sorted by code, a code defined twice keep the last
+        while (file) {
+            if (idx < required_chars_count) {
+                cChar = idx + baseChar;
+                if (!m_parseChar(file, cChar, glyphs)) {
+                    // return false;
+                }
+            } else if (idx - required_chars_count < additionnal_chars_count) {
+                cChar = additionnal_chars.at(idx - required_chars_count);
+                if (!m_parseChar(file, cChar, glyphs)) {
+                    // return false;
+                }
+            } else {
+                if (!m_parseChar(file, 0, glyphs)) {
+                    // return false;
+                }
+            }
+            ++idx;
+        }
+        m_flatten(glyphs);
+        return true;
+	}
+
+    // a font saved with CRLF gives the same glyphs
+    static void m_trimCR(std::string& vRow) {
+        if (!vRow.empty() && vRow.back() == '\r') {
+            vRow.pop_back();
+        }
+    }
+
+    bool m_parseChar(std::istream& vFile, const size_t vChar, std::map<int32_t, std::vector<std::string>>& vInOutGlyphs) {
+        std::string row;
+        size_t charCode = vChar;
+        std::vector<std::string> rows;
+        if (charCode < 32) {
+            std::getline(vFile, row);
+            size_t spacePos = row.find(' ');
+            if (spacePos != std::string::npos) {
+                const auto numStr = row.substr(0, spacePos);
+                const auto descStr = row.substr(spacePos + 1);
+                charCode = static_cast<size_t>(std::stoi(numStr));
+            } else {
+                return false;
+            }
+        }
+        rows.reserve(m_header.height);
+        for (int i = 0; i < m_header.height; ++i) {
+            std::getline(vFile, row);
+            m_trimCR(row);
+            if (!row.empty()) {
+                while (row.back() == '@') {
+                    row.pop_back();
+                }
+                if (row.front() == ' ') {
+                    row = row.substr(1);
+                }
+                for (auto& c : row) {
+                    if (c == static_cast<char>(m_header.hardblank)) {
+                        c = ' ';
+                    }
+                }
+            }
+            rows.push_back(row);
+        }
+        vInOutGlyphs[static_cast<int32_t>(charCode)] = rows;
+        return true;
+    }
+
+    // the parsed glyphs in the contiguous layout of the .bff
+    void m_flatten(const std::map<int32_t, std::vector<std::string>>& vGlyphs) {
+        const auto height = static_cast<size_t>(std::max(m_header.height, 0));
+        m_ownCodes.reserve(vGlyphs.size());
+        m_ownRowOffsets.reserve(vGlyphs.size() * height + 1U);
+        for (const auto& glyph : vGlyphs) {
+            m_ownCodes.push_back(glyph.first);
+            for (size_t r = 0; r < height; ++r) {
+                m_ownRowOffsets.push_back(static_cast<uint32_t>(m_ownRowData.size()));
+                if (r < glyph.second.size()) {
+                    m_ownRowData.insert(m_ownRowData.end(), glyph.second[r].begin(), glyph.second[r].end());
+                }
+            }
+        }
+        m_ownRowOffsets.push_back(static_cast<uint32_t>(m_ownRowData.size()));
+        m_codes = m_ownCodes.data();
+        m_rowOffsets = m_ownRowOffsets.data();
+        m_rowData = m_ownRowData.data();
+        m_glyphCount = static_cast<uint32_t>(m_ownCodes.size());
+    }
+
+    static size_t m_getPadding(const size_t vSize) { return (4U - (vSize & 3U)) & 3U; }
+
+    bool m_loadBff(const std::string& vFilePathName) {
+        if (!m_mapped.open(vFilePathName) || !m_mapBff()) {
+            m_reset();
+#ifdef EZ_TOOLS_LOG
+            LogVarError("Not a valid binary FigFont file %s", vFilePathName.c_str());
+#endif  // EZ_TOOLS_LOG
+            return false;
+        }
+        if (m_source.path.empty()) {
+            return true;  // no source, the cache is the font
+        }
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        if (!m_getFileInfos(m_source.path, size, mtime)) {
+            return true;  // the source is gone, the cache is kept
+        }
+        if (size == m_source.size && mtime == m_source.mtime) {
+            return true;
+        }
+        std::string content;
+        if (!m_readFile(m_source.path, content)) {
+            return true;
+        }
+        const auto hash = m_getHash(content);
+        if (hash != m_source.hash) {  // the font changed, the cache is rebuilt
+            auto source = m_source;
+            m_reset();
+            m_source = source;
+            m_source.hash = hash;
+            if (!m_parseFlf(content)) {
+                return false;
+            }
+        }
+        m_source.size = size;
+        m_source.mtime = mtime;
+        // for the next loads, the font loaded stay valid if the write fail
+        m_writeBff(vFilePathName);
+        return true;
+    }
+
+    // check the sizes and point the glyphs on the mapping, without copy
+    bool m_mapBff() {
+        const uint8_t* data = m_mapped.getData();
+        const uint64_t size = m_mapped.getSize();
+        BffHeader header;
+        if (size < sizeof(BffHeader)) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(BffHeader));
+        if (std::memcmp(header.magic, "EZFF", 4) != 0 || header.version != bffVersion || header.height <= 0) {
+            return false;
+        }
+        const uint64_t codesOffset = sizeof(BffHeader) + header.sourcePathSize + m_getPadding(header.sourcePathSize);
+        const uint64_t rowCount = static_cast<uint64_t>(header.glyphCount) * static_cast<uint64_t>(header.height) + 1U;
+        const uint64_t offsetsOffset = codesOffset + static_cast<uint64_t>(header.glyphCount) * sizeof(int32_t);
+        const uint64_t dataOffset = offsetsOffset + rowCount * sizeof(uint32_t);
+        if (dataOffset + header.rowDataSize != size) {
+            return false;
+        }
+        const auto* offsets = reinterpret_cast<const uint32_t*>(data + offsetsOffset);
+        for (uint64_t i = 0; i < rowCount; ++i) {  // a corrupted file must not read out of the mapping
+            if (offsets[i] > header.rowDataSize || (i > 0 && offsets[i] < offsets[i - 1])) {
+                return false;
+            }
+        }
+        m_header.height = header.height;
+        m_header.baseline = header.baseline;
+        m_header.maxLength = header.maxLength;
+        m_header.oldLayout = header.oldLayout;
+        m_header.fullLayout = header.fullLayout;
+        m_header.printDirection = header.printDirection;
+        m_header.codetagCount = header.codetagCount;
+        m_header.hardblank = static_cast<uint8_t>(header.hardblank);
+        m_header.commentBlock.clear();
+        m_codes = reinterpret_cast<const int32_t*>(data + codesOffset);
+        m_rowOffsets = offsets;
+        m_rowData = reinterpret_cast<const char*>(data + dataOffset);
+        m_glyphCount = header.glyphCount;
+        m_source.path.assign(reinterpret_cast<const char*>(data + sizeof(BffHeader)), header.sourcePathSize);
+        m_source.size = header.sourceSize;
+        m_source.mtime = header.sourceMtime;
+        m_source.hash = header.sourceHash;
+        return true;
+    }
+
+    // written in a temporary file then renamed, so a concurrent load never see a partial file
+    bool m_writeBff(const std::string& vFilePathName) {
+        BffHeader header{};
+        std::memcpy(header.magic, "EZFF", 4);
+        header.version = bffVersion;
+        header.height = m_header.height;
+        header.baseline = m_header.baseline;
+        header.maxLength = m_header.maxLength;
+        header.oldLayout = m_header.oldLayout;
+        header.fullLayout = m_header.fullLayout;
+        header.printDirection = m_header.printDirection;
+        header.codetagCount = m_header.codetagCount;
+        header.hardblank = m_header.hardblank;
+        header.glyphCount = m_glyphCount;
+        const size_t rowCount = static_cast<size_t>(m_glyphCount) * static_cast<size_t>(m_header.height) + 1U;
+        header.rowDataSize = m_rowOffsets[rowCount - 1U];
+        header.sourcePathSize = static_cast<uint32_t>(m_source.path.size());
+        header.sourceSize = m_source.size;
+        header.sourceMtime = m_source.mtime;
+        header.sourceHash = m_source.hash;
+        std::string content;
+        content.reserve(sizeof(BffHeader) + m_source.path.size() + 3U + m_glyphCount * sizeof(int32_t) + rowCount * sizeof(uint32_t) + header.rowDataSize);
+        content.append(reinterpret_cast<const char*>(&header), sizeof(BffHeader));
+        content += m_source.path;
+        content.append(m_getPadding(m_source.path.size()), '\0');
+        content.append(reinterpret_cast<const char*>(m_codes), m_glyphCount * sizeof(int32_t));
+        content.append(reinterpret_cast<const char*>(m_rowOffsets), rowCount * sizeof(uint32_t));
+        content.append(m_rowData, header.rowDataSize);
+#ifdef WINDOWS_OS
+        const auto tmpFile = vFilePathName + "." + std::to_string(_getpid()) + ".tmp";
+#else
+        const auto tmpFile = vFilePathName + "." + std::to_string(getpid()) + ".tmp";
+#endif
+        {
+            std::ofstream file(tmpFile, std::ios::out | std::ios::binary | std::ios::trunc);
+            file.write(content.data(), static_cast<std::streamsize>(content.size()));
+            if (!file.good()) {
+                file.close();
+                std::remove(tmpFile.c_str());
+                return false;
+            }
+        }
+#ifdef WINDOWS_OS
+        std::remove(vFilePathName.c_str());
+#endif
+        if (std::rename(tmpFile.c_str(), vFilePathName.c_str()) != 0) {
+            std::remove(tmpFile.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    static bool m_readFile(const std::string& vFilePathName, std::string& vOut) {
+        std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        vOut.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    static bool m_getFileInfos(const std::string& vFilePathName, uint64_t& vOutSize, int64_t& vOutMtime) {
+#ifdef WINDOWS_OS
+        struct _stat64 st;
+        if (_stat64(vFilePathName.c_str(), &st) != 0) {
+            return false;
+        }
+        vOutMtime = static_cast<int64_t>(st.st_mtime) * 1000000000LL;
+#else
+        struct stat st;
+        if (stat(vFilePathName.c_str(), &st) != 0) {
+            return false;
+        }
+#ifdef __APPLE__
+        vOutMtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+        vOutMtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+#endif
+        vOutSize = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    static uint64_t m_getHash(const std::string& vContent) {
+        uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+        for (const auto c : vContent) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+	std::string m_printString(const std::string& vPattern) {
+        std::stringstream ret;
+        std::vector<std::string> rows;
+        rows.resize(m_header.height);
+        size_t row_idx = 0;
+        for (auto& row : rows) {
+            for (const auto c : vPattern) {
+                m_appendCharRow(row, static_cast<uint8_t>(c), row_idx);
+            }
+            ++row_idx;
+            // remove empty rows
+            if (row.find_first_not_of(" ") != std::string::npos) {
+                ret << row << std::endl;
+            }
+        }
+        return ret.str();
+	}
+
+    void m_appendCharRow(std::string& vOut, const int32_t vC, const size_t vRowIdx) {
+        const int32_t* end = m_codes + m_glyphCount;
+        const int32_t* it = std::lower_bound(m_codes, end, vC);
+        if (it != end && *it == vC && vRowIdx < static_cast<size_t>(m_header.height)) {
+            const size_t idx = static_cast<size_t>(it - m_codes) * static_cast<size_t>(m_header.height) + vRowIdx;
+            vOut.append(m_rowData + m_rowOffsets[idx], m_rowOffsets[idx + 1] - m_rowOffsets[idx]);
+        }
+    }
+};
+
+}  // namespace ez_baseline
@@ -0,0 +1,179 @@
+#pragma once
+
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// helpers shared by the benchmarks of the tools dir
+
+#include <ezlibs/ezApp.hpp>
+
+#ifdef WINDOWS_OS
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace bench {
+
+typedef std::chrono::steady_clock Clock;
+
+inline double getElapsedMs(const Clock::time_point& vStart) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - vStart).count();
+}
+
+inline void makeDir(const std::string& vPath) {
+#ifdef WINDOWS_OS
+    _mkdir(vPath.c_str());
+#else
+    mkdir(vPath.c_str(), 0755);
+#endif
+}
+
+inline bool writeFile(const std::string& vFilePathName, const std::string& vContent) {
+    std::ofstream file(vFilePathName, std::ios::out | std::ios::binary | std::ios::trunc);
+    file << vContent;
+    return file.good();
+}
+
+inline std::string readFile(const std::string& vFilePathName) {
+    std::ifstream file(vFilePathName, std::ios::in | std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+// ez::App set the current dir to the dir of the app, so the paths given to the tools are made from it
+inline std::string getAppDir(ez::App& vApp) {
+    char cwd[MAX_PATH + 1] = {};
+    return (GetCurrentDir(cwd, MAX_PATH) != nullptr) ? std::string(cwd) : vApp.getAppPath();
+}
+
+// the BuildInc executable next to the tool
+inline std::string getBuildInc(const std::string& vAppDir) {
+#ifdef WINDOWS_OS
+    return vAppDir + "/BuildInc.exe";
+#else
+    return vAppDir + "/BuildInc";
+#endif
+}
+
+// run a process and wait for its end, its output is dropped and its errors go in vStdErrFile if given
+inline bool runProcess(const std::vector<std::string>& vArgs, const std::string& vStdErrFile = {}) {
+#ifdef WINDOWS_OS
+    (void)vStdErrFile;
+    std::string cmdLine;
+    for (const auto& arg : vArgs) {
+        cmdLine += "\"" + arg + "\" ";
+    }
+    STARTUPINFOA si = {};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {};
+    if (!CreateProcessA(nullptr, &cmdLine[0], nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)) {
+        return false;
+    }
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    return exitCode == 0;
+#else
+    std::vector<char*> argv;
+    for (const auto& arg : vArgs) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    if (!vStdErrFile.empty()) {
+        posix_spawn_file_actions_addopen(&actions, 2, vStdErrFile.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    }
+    pid_t pid = 0;
+    const int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        return false;
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+// to drop an output
+inline const char* getNullDevice() {
+#ifdef WINDOWS_OS
+    return "NUL";
+#else
+    return "/dev/null";
+#endif
+}
+
+// the median of the samples, 0 if empty
+inline double getMedian(std::vector<double> vSamples) {
+    if (vSamples.empty()) {
+        return 0.0;
+    }
+    std::sort(vSamples.begin(), vSamples.end());
+    return vSamples.at(vSamples.size() / 2);
+}
+
+// a small FigFont, every glyph is a box of its char
+inline std::string getSyntheticFont() {
+    static constexpr int32_t height = 4;
+    std::string ret = "flf2a$ 4 3 8 0 0\n";
+    const auto addGlyph = [&ret](const char vChar) {
+        for (int32_t row = 0; row < height; ++row) {
+            const char c = (vChar == ' ') ? '$' : vChar;
+            if (row == 0 || row == height - 1) {
+                ret += std::string(1, '+') + std::string(3, c) + "+";
+            } else {
+                ret += std::string(1, '|') + c + "$" + c + "|";
+            }
+            ret += (row == height - 1) ? "@@\n" : "@\n";
+        }
+    };
+    for (char c = 32; c < 127; ++c) {
+        addGlyph(c);
+    }
+    for (int32_t i = 0; i < 7; ++i) {  // the german chars
+        addGlyph('?');
+    }
+    return ret;
+}
+
+}  // namespace bench
@@ -0,0 +1,175 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Batch io with io_uring against the blocking path :
+// N build id headers are written (tmp file then rename) then read in one call of ez::BatchIO,
+// the median time of each is reported per file count, with the files failed
+
+#include "BenchUtils.hpp"
+
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezBatchIO.hpp>
+
+#ifndef WINDOWS_OS
+#include <sys/resource.h>
+#endif
+
+#include <iomanip>
+#include <iostream>
+
+struct Config {
+    std::string workDir;
+    std::vector<int32_t> files = {10, 1000, 10000};
+    int32_t iterations = 5;
+    int32_t maxOpenFiles = 0;  // 0 for the limit of the process
+    bool json = false;
+};
+
+struct Report {
+    std::string mode;
+    int32_t files = 0;
+    double writeMs = 0.0;  // median
+    double readMs = 0.0;  // median
+    int32_t failures = 0;  // files not written or not read as written
+};
+
+static Report runMode(const Config& vConfig, const std::string& vMode, const int32_t vFiles) {
+    Report report;
+    report.mode = vMode;
+    report.files = vFiles;
+    const auto dir = vConfig.workDir + "/" + std::to_string(vFiles);
+    bench::makeDir(dir);
+    std::vector<std::string> files, contents;
+    for (int32_t i = 0; i < vFiles; ++i) {
+        files.push_back(dir + "/Build" + std::to_string(i) + ".h");
+        contents.push_back("#pragma once\n\n#define Project" + std::to_string(i) + "_Label \"Project" + std::to_string(i) +
+                           "\"\n#define Project" + std::to_string(i) + "_BuildNumber 1234\n#define Project" + std::to_string(i) + "_BuildId \"1.2.1234\"\n");
+    }
+    std::vector<const std::string*> toWrite;
+    for (const auto& content : contents) {
+        toWrite.push_back(&content);
+    }
+    ez::BatchIO io(vMode == "uring");
+    if (vMode == "uring" && !io.isIoUringUsed()) {
+        report.mode = "uring (not available, blocking)";
+    }
+    std::vector<double> writeSamples, readSamples;
+    std::vector<bool> status;
+    std::vector<std::string> read;
+    for (int32_t it = 0; it < vConfig.iterations; ++it) {
+        auto start = bench::Clock::now();
+        io.writeFiles(files, toWrite, status);
+        writeSamples.push_back(bench::getElapsedMs(start));
+        report.failures += static_cast<int32_t>(std::count(status.begin(), status.end(), false));
+        start = bench::Clock::now();
+        io.readFiles(files, read, status);
+        readSamples.push_back(bench::getElapsedMs(start));
+        for (size_t i = 0; i < files.size(); ++i) {
+            report.failures += (status[i] && read[i] == contents[i]) ? 0 : 1;
+        }
+    }
+    report.writeMs = bench::getMedian(writeSamples);
+    report.readMs = bench::getMedian(readSamples);
+    return report;
+}
+
+static void printReports(const Config& vConfig, const std::vector<Report>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "[\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "    {\"mode\": \"" << r.mode << "\", \"files\": " << r.files << ", \"writeMs\": " << r.writeMs << ", \"readMs\": " << r.readMs  //
+               << ", \"failures\": " << r.failures << "}" << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "]\n";
+    } else {
+        ss << vConfig.iterations << " iterations per case, medians" << (vConfig.maxOpenFiles > 0 ? ", " + std::to_string(vConfig.maxOpenFiles) + " descriptors" : std::string()) << "\n";
+        ss << "mode        files   write ms   read ms   us/file w   us/file r   failures\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(9) << r.mode << std::right << std::setw(8) << r.files << std::setw(11) << r.writeMs << std::setw(10) << r.readMs  //
+               << std::setw(12) << (r.writeMs * 1000.0 / r.files) << std::setw(12) << (r.readMs * 1000.0 / r.files) << std::setw(11) << r.failures << "\n";
+        }
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncBatchIOBench");
+    args.addOptional("--work-dir").help("directory of the files (default: BuildIncBatchIOBench.work)", "<dir>").delimiter(' ');
+    args.addOptional("--files").help("file counts, comma separated (default: 10,1000,10000)", "<N[,N]>").delimiter(' ');
+    args.addOptional("--iterations").help("writes and reads per case (default: 5)", "<count>").delimiter(' ');
+    args.addOptional("--max-open-files").help("lower the limit of open files of the process first", "<count>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    const auto appDir = bench::getAppDir(app);
+    Config config;
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = appDir + "/BuildIncBatchIOBench.work";
+    }
+    if (args.hasValue("files")) {
+        config.files.clear();
+        for (const auto& count : ez::str::splitStringToVector(args.getValue<std::string>("files"), ',')) {
+            int32_t files = 0;
+            if (ez::str::stringToNumber(count, files) && files > 0) {
+                config.files.push_back(files);
+            }
+        }
+    }
+    if (args.hasValue("iterations")) {
+        config.iterations = std::max(args.getValue<int32_t>("iterations"), 1);
+    }
+    if (args.hasValue("max-open-files")) {
+        config.maxOpenFiles = std::max(args.getValue<int32_t>("max-open-files"), 16);
+#ifndef WINDOWS_OS
+        rlimit limit{};
+        getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = static_cast<rlim_t>(config.maxOpenFiles);
+        setrlimit(RLIMIT_NOFILE, &limit);
+#endif
+    }
+    config.json = args.isPresent("json");
+    bench::makeDir(config.workDir);
+    std::vector<Report> reports;
+    for (const auto files : config.files) {
+        reports.push_back(runMode(config, "blocking", files));
+        reports.push_back(runMode(config, "uring", files));
+    }
+    printReports(config, reports);
+    for (const auto& report : reports) {
+        if (report.failures != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
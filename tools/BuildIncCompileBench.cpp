@@ -0,0 +1,335 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+// Compile cost of the generated header :
+// generate K consumer TUs of the BuildInc header in each style (plain defines, FigFont banner, marker),
+// then preprocess and compile them one by one with the system compiler
+// and report the time per TU against TUs without the header
+
+#include <ezlibs/ezApp.hpp>
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#ifdef WINDOWS_OS
+#include <direct.h>
+#define makeDir(path) _mkdir(path)
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#define makeDir(path) mkdir(path, 0755)
+extern char** environ;
+#endif
+
+#include <chrono>
+#include <iomanip>
+
+#ifndef BUILDINC_CXX  // set by cmake to the compiler of the build
+#define BUILDINC_CXX "c++"
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+struct Config {
+    std::string buildInc;  // the generator
+    std::string compiler = BUILDINC_CXX;
+    std::string flags;  // added to each compile, comma separated
+    std::string workDir;
+    std::string label = "BuildIncBench";
+    int32_t tus = 50;
+    int32_t bannerHeight = 8;  // rows of the synthetic font
+    bool json = false;
+};
+
+struct Style {
+    const char* name;
+    bool include;  // the TUs include the header
+    std::vector<std::string> buildIncArgs;
+    bool useBanner;  // the TUs use the FigFont label
+};
+
+struct Report {
+    std::string style;
+    size_t headerBytes = 0;
+    size_t preprocessedBytes = 0;  // per TU
+    double preprocessMs = 0.0;  // per TU
+    double compileMs = 0.0;  // per TU
+    size_t failures = 0;
+};
+
+static bool writeFile(const std::string& vFilePathName, const std::string& vContent) {
+    std::ofstream file(vFilePathName, std::ios::out | std::ios::binary);
+    file << vContent;
+    return file.good();
+}
+
+static size_t getFileSize(const std::string& vFilePathName) {
+    std::ifstream file(vFilePathName, std::ios::in | std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<size_t>(file.tellg()) : 0U;
+}
+
+// a FigFont of vHeight rows, every glyph is a box of its char,
+// so the banner size grow with the height like the real fonts
+static bool writeSyntheticFont(const std::string& vFilePathName, const int32_t vHeight) {
+    std::string content = "flf2a$ " + std::to_string(vHeight) + " " + std::to_string(vHeight - 1) + " 16 0 0\n";
+    const auto addGlyph = [&content, vHeight](const char vChar) {
+        for (int32_t row = 0; row < vHeight; ++row) {
+            const char c = (vChar == ' ') ? '$' : vChar;
+            if (row == 0 || row == vHeight - 1) {
+                content += "+" + std::string(6, c) + "+";
+            } else {
+                content += "|" + std::string(1, c) + "$$$$" + std::string(1, c) + "|";
+            }
+            content += (row == vHeight - 1) ? "@@\n" : "@\n";
+        }
+    };
+    for (char c = 32; c < 127; ++c) {
+        addGlyph(c);
+    }
+    for (int32_t i = 0; i < 7; ++i) {  // the german chars
+        addGlyph('?');
+    }
+    return writeFile(vFilePathName, content);
+}
+
+// run a process and wait for its end, its output is dropped
+static bool runProcess(const std::vector<std::string>& vArgs) {
+#ifdef WINDOWS_OS
+    std::string cmdLine;
+    for (const auto& arg : vArgs) {
+        cmdLine += "\"" + arg + "\" ";
+    }
+    STARTUPINFOA si = {};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {};
+    if (!CreateProcessA(nullptr, &cmdLine[0], nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)) {
+        return false;
+    }
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    return exitCode == 0;
+#else
+    std::vector<char*> argv;
+    for (const auto& arg : vArgs) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    pid_t pid = 0;
+    const int err = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        return false;
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+static bool isMsvc(const std::string& vCompiler) {
+    const auto pos = vCompiler.find_last_of("/\\");
+    const auto name = (pos == std::string::npos) ? vCompiler : vCompiler.substr(pos + 1);
+    return name == "cl" || name == "cl.exe" || name == "clang-cl" || name == "clang-cl.exe";
+}
+
+// the compiler command of a TU, vPreprocess only run the preprocessor
+static std::vector<std::string> getCompileArgs(const Config& vConfig, const std::string& vSource, const std::string& vOutput, const bool vPreprocess) {
+    std::vector<std::string> ret = {vConfig.compiler};
+    for (const auto& flag : ez::str::splitStringToVector(vConfig.flags, ',')) {
+        if (!flag.empty()) {
+            ret.push_back(flag);
+        }
+    }
+    if (isMsvc(vConfig.compiler)) {
+        ret.push_back("/nologo");
+        ret.push_back(vPreprocess ? "/P" : "/c");
+        ret.push_back((vPreprocess ? "/Fi" : "/Fo") + vOutput);
+    } else {
+        ret.push_back(vPreprocess ? "-E" : "-c");
+        ret.push_back("-o");
+        ret.push_back(vOutput);
+    }
+    ret.push_back(vSource);
+    return ret;
+}
+
+static std::string getTuSource(const Style& vStyle, const int32_t vIdx) {
+    const auto idx = std::to_string(vIdx);
+    std::string ret;
+    if (vStyle.include) {
+        ret += "#include \"Build.h\"\n";
+    }
+    ret += "const char* getBuildId" + idx + "() {\n";
+    ret += vStyle.include ? "    return Bench_BuildId;\n" : "    return \"0.0.1\";\n";
+    ret += "}\n";
+    if (vStyle.useBanner) {
+        ret += "const char* getBanner" + idx + "() {\n";
+        ret += "    return reinterpret_cast<const char*>(Bench_FigFontLabel);\n";
+        ret += "}\n";
+    }
+    return ret;
+}
+
+static Report runStyle(const Config& vConfig, const Style& vStyle) {
+    Report report;
+    report.style = vStyle.name;
+    const auto dir = vConfig.workDir + "/" + vStyle.name;
+    makeDir(dir.c_str());
+    const auto header = dir + "/Build.h";
+    std::remove(header.c_str());
+    if (vStyle.include) {
+        std::vector<std::string> args = {vConfig.buildInc, "Bench", header, "--label", vConfig.label};
+        args.insert(args.end(), vStyle.buildIncArgs.begin(), vStyle.buildIncArgs.end());
+        if (!runProcess(args)) {
+            ++report.failures;
+            return report;
+        }
+        report.headerBytes = getFileSize(header);
+    }
+    std::vector<std::string> sources;
+    for (int32_t i = 0; i < vConfig.tus; ++i) {
+        sources.push_back(dir + "/tu" + std::to_string(i) + ".cpp");
+        writeFile(sources.back(), getTuSource(vStyle, i));
+    }
+    // one TU at a time, the concurrent compiles would measure the machine, not the header
+    auto start = Clock::now();
+    for (const auto& source : sources) {
+        if (!runProcess(getCompileArgs(vConfig, source, source + ".i", true))) {
+            ++report.failures;
+        }
+    }
+    report.preprocessMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / vConfig.tus;
+    start = Clock::now();
+    for (const auto& source : sources) {
+        if (!runProcess(getCompileArgs(vConfig, source, source + ".o", false))) {
+            ++report.failures;
+        }
+    }
+    report.compileMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / vConfig.tus;
+    size_t preprocessed = 0;
+    for (const auto& source : sources) {
+        preprocessed += getFileSize(source + ".i");
+    }
+    report.preprocessedBytes = preprocessed / sources.size();
+    return report;
+}
+
+static void printReports(const Config& vConfig, const std::vector<Report>& vReports) {
+    const auto& base = vReports.front();  // the TUs without the header
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "[\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "    {\"style\": \"" << r.style << "\", \"tus\": " << vConfig.tus << ", \"failures\": " << r.failures  //
+               << ", \"headerBytes\": " << r.headerBytes << ", \"preprocessedBytes\": " << r.preprocessedBytes  //
+               << ", \"preprocessMs\": " << r.preprocessMs << ", \"compileMs\": " << r.compileMs  //
+               << ", \"preprocessOverheadMs\": " << (r.preprocessMs - base.preprocessMs) << ", \"compileOverheadMs\": " << (r.compileMs - base.compileMs) << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "]\n";
+    } else {
+        ss << "compiler " << vConfig.compiler << " " << vConfig.flags << ", tus " << vConfig.tus << ", banner height " << vConfig.bannerHeight << "\n";
+        ss << "times per TU, overhead against the TUs without the header\n";
+        for (const auto& r : vReports) {
+            ss << "-- " << r.style << (r.failures ? " (" + std::to_string(r.failures) + " failures)" : std::string()) << "\n";
+            ss << "   header        : " << r.headerBytes << " bytes, " << r.preprocessedBytes << " bytes preprocessed\n";
+            ss << "   preprocess ms : " << r.preprocessMs << " (" << std::showpos << (r.preprocessMs - base.preprocessMs) << std::noshowpos << ")\n";
+            ss << "   compile ms    : " << r.compileMs << " (" << std::showpos << (r.compileMs - base.compileMs) << std::noshowpos << ")\n";
+        }
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncCompileBench");
+    args.addOptional("--buildinc").help("BuildInc executable (default: next to this one)", "<file>").delimiter(' ');
+    args.addOptional("--compiler").help("compiler of the TUs (default: the compiler of the build)", "<file>").delimiter(' ');
+    args.addOptional("--flags").help("flags of the compiles, comma separated", "<flag[,flag]>").delimiter(' ');
+    args.addOptional("--work-dir").help("directory of the generated TUs (default: BuildIncCompileBench.work)", "<dir>").delimiter(' ');
+    args.addOptional("--tus").help("count of TUs per style (default: 50)", "<K>").delimiter(' ');
+    args.addOptional("--banner-height").help("rows of the FigFont banner (default: 8)", "<rows>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    // ez::App set the current dir to the dir of the app, the paths given to the tools must be absolute
+    char cwd[MAX_PATH + 1] = {};
+    const std::string appDir = (GetCurrentDir(cwd, MAX_PATH) != nullptr) ? std::string(cwd) : app.getAppPath();
+    Config config;
+    config.buildInc = args.getValue<std::string>("buildinc");
+    if (config.buildInc.empty()) {
+#ifdef WINDOWS_OS
+        config.buildInc = appDir + "/BuildInc.exe";
+#else
+        config.buildInc = appDir + "/BuildInc";
+#endif
+    }
+    if (args.hasValue("compiler")) {
+        config.compiler = args.getValue<std::string>("compiler");
+    }
+    config.flags = args.getValue<std::string>("flags");
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = appDir + "/BuildIncCompileBench.work";
+    }
+    if (args.hasValue("tus")) {
+        config.tus = std::max(args.getValue<int32_t>("tus"), 1);
+    }
+    if (args.hasValue("banner-height")) {
+        config.bannerHeight = std::max(args.getValue<int32_t>("banner-height"), 2);
+    }
+    config.json = args.isPresent("json");
+    makeDir(config.workDir.c_str());
+    const auto fontFile = config.workDir + "/synthetic.flf";
+    writeSyntheticFont(fontFile, config.bannerHeight);
+    const std::vector<Style> styles = {
+        {"none", false, {}, false},
+        {"plain", true, {}, false},
+        {"figfont", true, {"-ff", fontFile}, false},
+        {"figfont-used", true, {"-ff", fontFile}, true},
+        {"marker", true, {"--marker"}, false},
+    };
+    std::vector<Report> reports;
+    for (const auto& style : styles) {
+        reports.push_back(runStyle(config, style));
+    }
+    printReports(config, reports);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Emit time and allocations of the outputs :
+// a warmed up builder is incremented then rendered, written (header and json) and its infos printed,
+// without banner, with a FigFont banner and with a large banner rendered again at each increment.
+// the infos are printed too as before the reused buffer (stringstreams, std::cout), for comparison
+
+#include "BenchUtils.hpp"
+#include "BenchAllocations.hpp"
+
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezFigFont.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+#ifdef WINDOWS_OS
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fileno _fileno
+#define close _close
+#endif
+
+struct Config {
+    std::string workDir;
+    std::string figFont;  // a synthetic font of the work dir if empty
+    int32_t iterations = 2000;
+    int32_t rounds = 5;
+    bool json = false;
+};
+
+struct Report {
+    std::string banner;
+    size_t headerBytes = 0;
+    double renderUs = 0.0;  // per call, median of the rounds
+    double renderAllocs = 0.0;  // per call
+    double writeUs = 0.0;
+    double writeAllocs = 0.0;
+    double infosStreamUs = 0.0;  // the previous path
+    double infosStreamAllocs = 0.0;
+    double infosUs = 0.0;
+    double infosAllocs = 0.0;
+};
+
+// the infos as printed before the reused buffer
+static std::string getStreamInfos(ez::BuildInc& vBuilder) {
+    std::stringstream project, build_id, file, infos;
+    std::string project_str, build_id_str, file_str;
+    build_id << "Build Id : " << vBuilder.getBuildIdStr() << " / " << vBuilder.getBuildIdInt();
+    build_id_str = build_id.str();
+    size_t row_len = build_id_str.size();
+    if (vBuilder.getLastWriteStatus()) {
+        file << "In file : " << vBuilder.getFilePathName();
+    } else {
+        file << "failed to write to : " << vBuilder.getFilePathName();
+    }
+    file_str = file.str();
+    row_len = std::max(row_len, file_str.size());
+    if (!vBuilder.getProject().empty()) {
+        project << "Project : " << vBuilder.getProject();
+        project_str = project.str();
+        row_len = std::max(row_len, project_str.size());
+    }
+    auto spliter = std::string(row_len + 6, '-');
+    infos << spliter << std::endl;
+    if (!vBuilder.getProject().empty()) {
+        infos << "-- " << project_str << std::string(row_len - project_str.size(), ' ') << " --" << std::endl;
+    }
+    infos << "-- " << build_id_str << std::string(row_len - build_id_str.size(), ' ') << " --" << std::endl;
+    infos << "-- " << file_str << std::string(row_len - file_str.size(), ' ') << " --" << std::endl;
+    infos << spliter << std::endl;
+    return infos.str();
+}
+
+// run vIterations calls of vFunc per round, returns the median time and the mean allocations per call
+template <typename TFunc>
+static void measure(const Config& vConfig, TFunc vFunc, double& vOutUs, double& vOutAllocs) {
+    vFunc();  // warm up
+    vFunc();
+    std::vector<double> samples;
+    const auto startAllocs = bench::allocations().load();
+    for (int32_t r = 0; r < vConfig.rounds; ++r) {
+        const auto start = bench::Clock::now();
+        for (int32_t i = 0; i < vConfig.iterations; ++i) {
+            vFunc();
+        }
+        samples.push_back(bench::getElapsedMs(start) * 1000.0 / vConfig.iterations);
+    }
+    vOutUs = bench::getMedian(samples);
+    vOutAllocs = static_cast<double>(bench::allocations().load() - startAllocs) / (vConfig.iterations * vConfig.rounds);
+}
+
+static Report runCase(const Config& vConfig, const std::string& vBanner) {
+    Report report;
+    report.banner = vBanner;
+    const auto dir = vConfig.workDir + "/" + vBanner;
+    bench::makeDir(dir);
+    ez::BuildInc builder(dir + "/Build.h", false);
+    builder.setProject("Toto").setLabel("Toto").setMinor(2).setBuildNumber(100000);
+    if (vBanner == "banner") {
+        builder.setFigFontFile(vConfig.figFont);
+    } else if (vBanner == "large") {  // a long label with the build number, rendered again at each increment
+        builder.setLabel("Toto the build of the application with its very long label shown as a large banner in the header");
+        builder.setFigFontFile(vConfig.figFont).useBuildNumber(true);
+    }
+    builder.addOutput(ez::BuildInc::OutputFormat::Json, dir + "/Build.json");
+    std::string buffer;
+    measure(
+        vConfig,
+        [&]() {
+            buffer.clear();
+            builder.incBuildNumber().render(ez::BuildInc::OutputFormat::Header, buffer);
+        },
+        report.renderUs,
+        report.renderAllocs);
+    report.headerBytes = buffer.size();
+    measure(vConfig, [&]() { builder.incBuildNumber().write(); }, report.writeUs, report.writeAllocs);
+    // the infos go to /dev/null
+    std::cout.flush();
+    const int stdOut = dup(fileno(stdout));
+    std::FILE* null = std::fopen(bench::getNullDevice(), "w");
+    if (null != nullptr) {
+        dup2(fileno(null), fileno(stdout));
+    }
+    measure(vConfig, [&]() { std::cout << getStreamInfos(builder.incBuildNumber()); }, report.infosStreamUs, report.infosStreamAllocs);
+    measure(vConfig, [&]() { builder.incBuildNumber().printInfos(); }, report.infosUs, report.infosAllocs);
+    std::cout.flush();
+    dup2(stdOut, fileno(stdout));
+    close(stdOut);
+    if (null != nullptr) {
+        std::fclose(null);
+    }
+    return report;
+}
+
+static void printReports(const Config& vConfig, const std::vector<Report>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "[\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "    {\"banner\": \"" << r.banner << "\", \"headerBytes\": " << r.headerBytes << ", \"renderUs\": " << r.renderUs << ", \"renderAllocs\": " << r.renderAllocs  //
+               << ", \"writeUs\": " << r.writeUs << ", \"writeAllocs\": " << r.writeAllocs << ", \"infosStreamUs\": " << r.infosStreamUs  //
+               << ", \"infosStreamAllocs\": " << r.infosStreamAllocs << ", \"infosUs\": " << r.infosUs << ", \"infosAllocs\": " << r.infosAllocs << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "]\n";
+    } else {
+        ss << vConfig.iterations << " calls per round, median of " << vConfig.rounds << " rounds, per call : us / allocations\n";
+        ss << "banner   header bytes        render          write   infos (streams)   infos (buffer)\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(8) << r.banner << std::right << std::setw(14) << r.headerBytes                                //
+               << std::setw(9) << r.renderUs << " /" << std::setw(4) << std::setprecision(1) << r.renderAllocs << std::setprecision(2)  //
+               << std::setw(9) << r.writeUs << " /" << std::setw(4) << std::setprecision(1) << r.writeAllocs << std::setprecision(2)    //
+               << std::setw(11) << r.infosStreamUs << " /" << std::setw(4) << std::setprecision(1) << r.infosStreamAllocs << std::setprecision(2)
+               << std::setw(11) << r.infosUs << " /" << std::setw(4) << std::setprecision(1) << r.infosAllocs << std::setprecision(2) << "\n";
+        }
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncEmitBench");
+    args.addOptional("--work-dir").help("directory of the written files (default: BuildIncEmitBench.work)", "<dir>").delimiter(' ');
+    args.addOptional("--figfont").help("FigFont of the banners (default: a synthetic font)", "<file>").delimiter(' ');
+    args.addOptional("--iterations").help("calls per round (default: 2000)", "<count>").delimiter(' ');
+    args.addOptional("--rounds").help("rounds per case (default: 5)", "<count>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    Config config;
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = bench::getAppDir(app) + "/BuildIncEmitBench.work";
+    }
+    if (args.hasValue("figfont")) {
+        config.figFont = args.getValue<std::string>("figfont");
+    }
+    if (args.hasValue("iterations")) {
+        config.iterations = std::max(args.getValue<int32_t>("iterations"), 1);
+    }
+    if (args.hasValue("rounds")) {
+        config.rounds = std::max(args.getValue<int32_t>("rounds"), 1);
+    }
+    config.json = args.isPresent("json");
+    bench::makeDir(config.workDir);
+    if (config.figFont.empty()) {
+        config.figFont = config.workDir + "/synthetic.flf";
+        bench::writeFile(config.figFont, bench::getSyntheticFont());
+    }
+    std::vector<Report> reports;
+    for (const std::string banner : {"none", "banner", "large"}) {
+        reports.push_back(runCase(config, banner));
+    }
+    printReports(config, reports);
+    return 0;
+}
@@ -0,0 +1,434 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// FigFont load and render against the previous ezFigFont (BenchFigFontBaseline.hpp) :
+// the fonts of the repo and a generated font of many unicode code tags are loaded again and again,
+// the time, the allocations, the peak of the heap while loading and the bytes kept by the loaded font
+// are reported for each implementation.
+// then short and long labels are rendered with generated full width fonts, a small and a tall one,
+// so the two implementations must give the same bytes.
+// last, the builtin fonts are compared with their .flf and .bff : load and render in the process,
+// and the startup of a BuildInc generating a header with the font
+
+#include "BenchUtils.hpp"
+#include "BenchAllocations.hpp"
+#include "BenchFigFontBaseline.hpp"
+
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezFigFont.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+#ifndef BUILDINC_FONTS_DIR  // set by cmake to the fonts of the repo
+#define BUILDINC_FONTS_DIR "fonts"
+#endif
+
+struct Config {
+    std::string workDir;
+    int32_t codeTags = 10000;
+    int32_t height = 8;
+    int32_t tallHeight = 40;
+    int32_t iterations = 20;
+    int32_t renders = 2000;
+    int32_t runs = 20;  // BuildInc processes per font
+    std::string buildInc;
+    bool json = false;
+};
+
+struct LoadReport {
+    std::string font;
+    std::string impl;
+    size_t fileBytes = 0;
+    double loadUs = 0.0;  // median
+    int64_t allocations = 0;  // per load
+    int64_t allocatedBytes = 0;  // per load
+    int64_t peakBytes = 0;  // max allocated during the load
+    int64_t keptBytes = 0;  // still allocated by the loaded font
+};
+
+struct RenderReport {
+    std::string font;
+    std::string label;
+    std::string impl;
+    size_t outputBytes = 0;
+    double renderUs = 0.0;  // median of 5 rounds
+    double allocations = 0.0;  // per render
+    bool same = true;  // same bytes as the previous implementation
+};
+
+struct BuiltinReport {
+    std::string font;
+    double loadUs = 0.0;  // median
+    int64_t loadAllocations = 0;
+    double renderUs = 0.0;  // warm, median of 5 rounds
+    double renderAllocations = 0.0;  // warm, in a reused buffer
+    double processMs = 0.0;  // median of the BuildInc runs, from the start to the exit
+    double figFontPhaseUs = 0.0;  // median of the figfont phase given by --stats
+    double totalPhaseUs = 0.0;  // median of the total of --stats, from the static initialization
+    bool same = true;  // same render as the .flf
+};
+
+// a font of the required chars and vCodeTags code tagged glyphs from U+0100, full width.
+// the rows never start with a blank, so the two implementations render the same bytes
+static std::string makeFont(const int32_t vHeight, const int32_t vCodeTags) {
+    const int32_t width = 8;
+    std::string ret = "flf2a$ " + std::to_string(vHeight) + " " + std::to_string(vHeight - 1) + " " + std::to_string(width + 2) + " -1 1\n";
+    ret += "generated by BuildIncFigFontBench\n";
+    static const char chars[] = "#*+=%&ox";
+    const auto appendGlyph = [&](const int32_t vCode) {
+        for (int32_t r = 0; r < vHeight; ++r) {
+            for (int32_t c = 0; c < width; ++c) {
+                ret += (c == 0) ? '|' : ((vCode + r * 3 + c) % 3 == 0 ? ' ' : chars[(vCode + r + c) % 8]);
+            }
+            ret += (r + 1 < vHeight) ? "@\n" : "@@\n";
+        }
+    };
+    for (int32_t code = 32; code < 127; ++code) {
+        appendGlyph(code);
+    }
+    for (const int32_t code : {196, 214, 220, 228, 246, 252, 223}) {
+        appendGlyph(code);
+    }
+    for (int32_t i = 0; i < vCodeTags; ++i) {
+        ret += std::to_string(0x100 + i) + "  GENERATED GLYPH\n";
+        appendGlyph(0x100 + i);
+    }
+    return ret;
+}
+
+template <typename TFont>
+static LoadReport measureLoad(const Config& vConfig, const std::string& vFont, const std::string& vImpl) {
+    LoadReport report;
+    report.font = vFont.substr(vFont.find_last_of("/\\") + 1);
+    report.impl = vImpl;
+    report.fileBytes = bench::readFile(vFont).size();
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(vConfig.iterations));  // not counted in the load
+    for (int32_t it = 0; it < vConfig.iterations; ++it) {
+        const auto liveBefore = bench::liveBytes().load();
+        const auto allocsBefore = bench::allocations().load();
+        const auto bytesBefore = bench::allocatedBytes().load();
+        bench::resetPeak();
+        const auto start = bench::Clock::now();
+        {
+            TFont font;
+            font.load(vFont);
+            samples.push_back(bench::getElapsedMs(start) * 1000.0);
+            report.allocations = bench::allocations().load() - allocsBefore;
+            report.allocatedBytes = bench::allocatedBytes().load() - bytesBefore;
+            report.peakBytes = bench::peakBytes().load() - liveBefore;
+            report.keptBytes = bench::liveBytes().load() - liveBefore;
+            if (!font.isValid()) {
+                report.impl += " (not loaded)";
+            }
+        }
+    }
+    report.loadUs = bench::getMedian(samples);
+    return report;
+}
+
+// vRender(font, label, out) is called for each render, the median of 5 rounds is kept
+template <typename TFont, typename TRender>
+static RenderReport measureRender(const Config& vConfig, const std::string& vFont, const std::string& vLabel, const std::string& vImpl, TRender vRender) {
+    RenderReport report;
+    report.font = vFont.substr(vFont.find_last_of("/\\") + 1);
+    report.label = std::to_string(vLabel.size()) + " chars";
+    report.impl = vImpl;
+    TFont font;
+    font.load(vFont);
+    std::string out;
+    vRender(font, vLabel, out);  // warm up
+    report.outputBytes = out.size();
+    std::vector<double> samples;
+    const auto allocsBefore = bench::allocations().load();
+    for (int32_t round = 0; round < 5; ++round) {
+        const auto start = bench::Clock::now();
+        for (int32_t i = 0; i < vConfig.renders; ++i) {
+            vRender(font, vLabel, out);
+        }
+        samples.push_back(bench::getElapsedMs(start) * 1000.0 / vConfig.renders);
+    }
+    report.renderUs = bench::getMedian(samples);
+    report.allocations = static_cast<double>(bench::allocations().load() - allocsBefore) / (5.0 * vConfig.renders);
+    return report;
+}
+
+static std::vector<RenderReport> runRenders(const Config& vConfig, const std::vector<std::string>& vFonts) {
+    std::string longLabel;
+    while (longLabel.size() < 256) {
+        longLabel += "BuildInc v1.2.3 ";
+    }
+    longLabel.resize(256);
+    std::vector<RenderReport> ret;
+    for (const auto& fontFile : vFonts) {
+        for (const auto& label : {std::string("Toto v1.2.3"), longLabel}) {
+            std::string expected;
+            {
+                ez_baseline::FigFont font(fontFile);
+                expected = font.printString(label);
+            }
+            ret.push_back(measureRender<ez_baseline::FigFont>(vConfig, fontFile, label, "previous",  //
+                                                              [](ez_baseline::FigFont& vFont, const std::string& vLabel, std::string& vOut) { vOut = vFont.printString(vLabel); }));
+            ret.push_back(measureRender<ez::FigFont>(vConfig, fontFile, label, "current",  //
+                                                     [](ez::FigFont& vFont, const std::string& vLabel, std::string& vOut) { vOut = vFont.printString(vLabel); }));
+            ret.back().same = (ez::FigFont(fontFile).printString(label) == expected);
+            ret.push_back(measureRender<ez::FigFont>(vConfig, fontFile, label, "append",  // in a reused buffer, as BuildInc
+                                                     [](ez::FigFont& vFont, const std::string& vLabel, std::string& vOut) {
+                                                         vOut.clear();
+                                                         vFont.appendString(vOut, vLabel);
+                                                     }));
+            ret.back().same = ret[ret.size() - 2].same;
+        }
+    }
+    return ret;
+}
+
+// the number after vKey in a line of --stats, 0 if not found
+static double getJsonNumber(const std::string& vLine, const std::string& vKey) {
+    const auto pos = vLine.find(vKey);
+    return (pos == std::string::npos) ? 0.0 : std::strtod(vLine.c_str() + pos + vKey.size(), nullptr);
+}
+
+static BuiltinReport measureBuiltin(const Config& vConfig, const std::string& vFont, const std::string& vLabel, const std::string& vExpected) {
+    BuiltinReport report;
+    report.font = vFont.substr(vFont.find_last_of("/\\") + 1);
+    std::vector<double> samples;
+    samples.reserve(static_cast<size_t>(vConfig.iterations));
+    for (int32_t it = 0; it < vConfig.iterations; ++it) {
+        const auto allocsBefore = bench::allocations().load();
+        const auto start = bench::Clock::now();
+        ez::FigFont font;
+        font.load(vFont);
+        samples.push_back(bench::getElapsedMs(start) * 1000.0);
+        report.loadAllocations = bench::allocations().load() - allocsBefore;
+    }
+    report.loadUs = bench::getMedian(samples);
+    ez::FigFont font(vFont);
+    std::string out;
+    font.appendString(out, vLabel);
+    report.same = (out == vExpected);
+    samples.clear();
+    const auto allocsBefore = bench::allocations().load();
+    for (int32_t round = 0; round < 5; ++round) {
+        const auto start = bench::Clock::now();
+        for (int32_t i = 0; i < vConfig.renders; ++i) {
+            out.clear();
+            font.appendString(out, vLabel);
+        }
+        samples.push_back(bench::getElapsedMs(start) * 1000.0 / vConfig.renders);
+    }
+    report.renderUs = bench::getMedian(samples);
+    report.renderAllocations = static_cast<double>(bench::allocations().load() - allocsBefore) / (5.0 * vConfig.renders);
+    // a BuildInc generating the header with the font, the header is kept so only the build number change.
+    // the exec of the process hide the load, so the phases of --stats are reported too
+    samples.clear();
+    auto name = report.font;
+    std::replace(name.begin(), name.end(), ':', '_');
+    const auto header = vConfig.workDir + "/" + name + ".h";
+    const auto statsFile = vConfig.workDir + "/" + name + ".jsonl";
+    bench::writeFile(statsFile, {});
+    for (int32_t run = 0; run < vConfig.runs; ++run) {
+        const auto start = bench::Clock::now();
+        if (!bench::runProcess({vConfig.buildInc, "Toto", header, "-ff", vFont, "--stats=" + statsFile})) {
+            report.same = false;
+        }
+        samples.push_back(bench::getElapsedMs(start));
+    }
+    report.processMs = bench::getMedian(samples);
+    std::vector<double> figFontSamples, totalSamples;
+    std::stringstream stats(bench::readFile(statsFile));
+    std::string line;
+    while (std::getline(stats, line)) {
+        figFontSamples.push_back(getJsonNumber(line, "\"figfont\":{\"ns\":") / 1000.0);
+        totalSamples.push_back(getJsonNumber(line, "\"totalNs\":") / 1000.0);
+    }
+    report.figFontPhaseUs = bench::getMedian(figFontSamples);
+    report.totalPhaseUs = bench::getMedian(totalSamples);
+    return report;
+}
+
+static std::vector<BuiltinReport> runBuiltins(const Config& vConfig) {
+    const std::string label = "BuildInc v1.2.3";
+    std::vector<BuiltinReport> ret;
+    for (const std::string name : {"standard", "term"}) {
+        const auto flf = std::string(BUILDINC_FONTS_DIR "/") + name + ".flf";
+        const auto bff = vConfig.workDir + "/" + name + ".bff";
+        ez::FigFont(flf).compile(bff);
+        const auto expected = ez::FigFont(flf).printString(label);
+        for (const auto& font : {"builtin:" + name, flf, bff}) {
+            ret.push_back(measureBuiltin(vConfig, font, label, expected));
+        }
+    }
+    return ret;
+}
+
+// a table, or a member of the json object in json
+static std::string getLoadReports(const Config& vConfig, const std::vector<LoadReport>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if (vConfig.json) {
+        ss << "    \"load\": [\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "        {\"font\": \"" << r.font << "\", \"impl\": \"" << r.impl << "\", \"fileBytes\": " << r.fileBytes << ", \"loadUs\": " << r.loadUs  //
+               << ", \"allocations\": " << r.allocations << ", \"allocatedBytes\": " << r.allocatedBytes << ", \"peakBytes\": " << r.peakBytes << ", \"keptBytes\": " << r.keptBytes << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "    ]";
+    } else {
+        ss << "load, median of " << vConfig.iterations << "\n";
+        ss << "font              impl       file bytes     load us   allocations   allocated bytes   peak bytes   kept bytes\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(18) << r.font << std::setw(9) << r.impl << std::right << std::setw(12) << r.fileBytes << std::setw(12) << r.loadUs  //
+               << std::setw(14) << r.allocations << std::setw(18) << r.allocatedBytes << std::setw(13) << r.peakBytes << std::setw(13) << r.keptBytes << "\n";
+        }
+    }
+    return ss.str();
+}
+
+static std::string getRenderReports(const Config& vConfig, const std::vector<RenderReport>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "    \"render\": [\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "        {\"font\": \"" << r.font << "\", \"label\": \"" << r.label << "\", \"impl\": \"" << r.impl << "\", \"outputBytes\": " << r.outputBytes  //
+               << ", \"renderUs\": " << r.renderUs << ", \"allocations\": " << r.allocations << ", \"same\": " << (r.same ? "true" : "false") << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "    ]";
+    } else {
+        ss << "render, " << vConfig.renders << " renders per round, median of 5 rounds\n";
+        ss << "font           label       impl       output bytes   render us   allocations   same\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(15) << r.font << std::setw(12) << r.label << std::setw(9) << r.impl << std::right << std::setw(14) << r.outputBytes  //
+               << std::setw(12) << r.renderUs << std::setw(14) << r.allocations << std::setw(7) << (r.same ? "yes" : "no") << "\n";
+        }
+    }
+    return ss.str();
+}
+
+static std::string getBuiltinReports(const Config& vConfig, const std::vector<BuiltinReport>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "    \"builtin\": [\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "        {\"font\": \"" << r.font << "\", \"loadUs\": " << r.loadUs << ", \"loadAllocations\": " << r.loadAllocations << ", \"renderUs\": " << r.renderUs  //
+               << ", \"renderAllocations\": " << r.renderAllocations << ", \"processMs\": " << r.processMs << ", \"figFontPhaseUs\": " << r.figFontPhaseUs  //
+               << ", \"totalPhaseUs\": " << r.totalPhaseUs << ", \"same\": " << (r.same ? "true" : "false") << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "    ]";
+    } else {
+        ss << "builtin, label 'BuildInc v1.2.3', load median of " << vConfig.iterations << ", render median of 5 rounds of " << vConfig.renders  //
+           << ", BuildInc median of " << vConfig.runs << " runs\n";
+        ss << "font                 load us   load allocs   render us   render allocs   BuildInc ms   figfont phase us  total us   same\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(18) << r.font << std::right << std::setw(10) << r.loadUs << std::setw(14) << r.loadAllocations << std::setw(12) << r.renderUs  //
+               << std::setw(16) << r.renderAllocations << std::setw(14) << r.processMs  //
+               << std::setw(19) << r.figFontPhaseUs << std::setw(10) << r.totalPhaseUs << std::setw(7) << (r.same ? "yes" : "no") << "\n";
+        }
+    }
+    return ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncFigFontBench");
+    args.addOptional("--work-dir").help("directory of the generated font (default: BuildIncFigFontBench.work)", "<dir>").delimiter(' ');
+    args.addOptional("--code-tags").help("code tagged glyphs of the generated font (default: 10000)", "<count>").delimiter(' ');
+    args.addOptional("--height").help("rows of the generated font (default: 8)", "<rows>").delimiter(' ');
+    args.addOptional("--tall-height").help("rows of the tall font of the renders (default: 40)", "<rows>").delimiter(' ');
+    args.addOptional("--iterations").help("loads per case (default: 20)", "<count>").delimiter(' ');
+    args.addOptional("--renders").help("renders per round (default: 2000)", "<count>").delimiter(' ');
+    args.addOptional("--runs").help("BuildInc runs per font of the builtin part (default: 20)", "<count>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    const auto appDir = bench::getAppDir(app);
+    Config config;
+    config.buildInc = bench::getBuildInc(appDir);
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = appDir + "/BuildIncFigFontBench.work";
+    }
+    if (args.hasValue("code-tags")) {
+        config.codeTags = std::max(args.getValue<int32_t>("code-tags"), 0);
+    }
+    if (args.hasValue("height")) {
+        config.height = std::max(args.getValue<int32_t>("height"), 1);
+    }
+    if (args.hasValue("tall-height")) {
+        config.tallHeight = std::max(args.getValue<int32_t>("tall-height"), 1);
+    }
+    if (args.hasValue("iterations")) {
+        config.iterations = std::max(args.getValue<int32_t>("iterations"), 1);
+    }
+    if (args.hasValue("renders")) {
+        config.renders = std::max(args.getValue<int32_t>("renders"), 1);
+    }
+    if (args.hasValue("runs")) {
+        config.runs = std::max(args.getValue<int32_t>("runs"), 1);
+    }
+    config.json = args.isPresent("json");
+    bench::makeDir(config.workDir);
+    const auto unicodeFont = config.workDir + "/unicode.flf";
+    bench::writeFile(unicodeFont, makeFont(config.height, config.codeTags));
+    const auto smallFont = config.workDir + "/small.flf";
+    bench::writeFile(smallFont, makeFont(config.height, 0));
+    const auto tallFont = config.workDir + "/tall.flf";
+    bench::writeFile(tallFont, makeFont(config.tallHeight, 0));
+    std::vector<LoadReport> loads;
+    for (const auto& font : {std::string(BUILDINC_FONTS_DIR "/standard.flf"), std::string(BUILDINC_FONTS_DIR "/term.flf"), unicodeFont}) {
+        loads.push_back(measureLoad<ez_baseline::FigFont>(config, font, "previous"));
+        loads.push_back(measureLoad<ez::FigFont>(config, font, "current"));
+    }
+    const auto renders = runRenders(config, {smallFont, tallFont});
+    const auto builtins = runBuiltins(config);
+    if (config.json) {
+        std::cout << "{\n" << getLoadReports(config, loads) << ",\n" << getRenderReports(config, renders) << ",\n" << getBuiltinReports(config, builtins) << "\n}\n";
+    } else {
+        std::cout << getLoadReports(config, loads) << getRenderReports(config, renders) << getBuiltinReports(config, builtins);
+    }
+    for (const auto& render : renders) {
+        if (!render.same) {
+            return 1;
+        }
+    }
+    for (const auto& builtin : builtins) {
+        if (!builtin.same) {
+            return 1;
+        }
+    }
+    return 0;
+}
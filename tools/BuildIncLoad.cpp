@@ -0,0 +1,465 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Load generator for BuildInc :
+// create M synthetic projects, then run N concurrent BuildInc increments on them
+// and report the throughput, the latencies, the lost updates and the io.
+// the multi mode increment B projects of the shared header per run, in one read and one write of the file,
+// with B times less runs for the same count of updates
+
+#include <ezlibs/ezApp.hpp>
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#ifdef WINDOWS_OS
+#include <direct.h>
+#define makeDir(path) _mkdir(path)
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#define makeDir(path) mkdir(path, 0755)
+extern char** environ;
+#endif
+
+#include <map>
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Config {
+    std::string buildInc;  // the executable to load
+    std::string workDir;
+    std::string mode = "all";  // shared, per-file, multi or all
+    std::string arrival = "burst";  // burst, uniform or poisson
+    int32_t projects = 100;
+    int32_t invocations = 1000;
+    int32_t concurrency = 8;
+    int32_t batch = 10;  // projects per run of the multi mode
+    int32_t fields = 0;  // user fields added to each header
+    int32_t fieldSize = 16;  // chars of a field value
+    double figFontRatio = 0.0;  // part of the projects using a figfont
+    double rate = 200.0;  // invocations per second for uniform and poisson
+    uint32_t seed = 1;
+    bool json = false;
+};
+
+struct Invocation {
+    int32_t project = 0;  // the first of the batch in the multi mode
+    double arrivalSec = 0.0;  // from the start of the run
+    double latencyMs = 0.0;  // spawn to exit
+    double responseMs = 0.0;  // arrival to exit
+    bool succeed = false;
+};
+
+struct Report {
+    std::string mode;
+    double durationSec = 0.0;
+    size_t invocations = 0;
+    size_t failures = 0;
+    int64_t updates = 0;  // projects incremented by the runs succeed
+    std::vector<double> latencies;
+    std::vector<double> responses;
+    int64_t lostUpdates = 0;
+    int64_t filesRead = 0;
+    int64_t bytesRead = 0;
+    int64_t filesWritten = 0;
+    int64_t bytesWritten = 0;
+};
+
+static std::string getProjectName(const int32_t vIdx) {
+    return "P" + std::to_string(vIdx);
+}
+
+static bool writeFile(const std::string& vFilePathName, const std::string& vContent) {
+    std::ofstream file(vFilePathName, std::ios::out | std::ios::binary);
+    file << vContent;
+    return file.good();
+}
+
+// a small FigFont, every glyph is a box of its char
+static bool writeSyntheticFont(const std::string& vFilePathName) {
+    static constexpr int32_t height = 4;
+    std::string content = "flf2a$ 4 3 8 0 0\n";
+    const auto addGlyph = [&content](const char vChar) {
+        for (int32_t row = 0; row < height; ++row) {
+            const char c = (vChar == ' ') ? '$' : vChar;
+            if (row == 0 || row == height - 1) {
+                content += std::string(1, '+') + std::string(3, c) + "+";
+            } else {
+                content += std::string(1, '|') + c + "$" + c + "|";
+            }
+            content += (row == height - 1) ? "@@\n" : "@\n";
+        }
+    };
+    for (char c = 32; c < 127; ++c) {
+        addGlyph(c);
+    }
+    for (int32_t i = 0; i < 7; ++i) {  // the german chars
+        addGlyph('?');
+    }
+    return writeFile(vFilePathName, content);
+}
+
+static std::string getProjectBlock(const Config& vConfig, const int32_t vIdx) {
+    const auto project = getProjectName(vIdx);
+    std::string ret;
+    ret += "#define " + project + "_Label \"" + project + "\"\n";
+    ret += "#define " + project + "_BuildNumber 0\n";
+    ret += "#define " + project + "_MinorNumber 0\n";
+    ret += "#define " + project + "_MajorNumber 1\n";
+    ret += "#define " + project + "_BuildId \"1.0.0\"\n";
+    ret += "#define " + project + "_BuildIdNum 01000\n";
+    for (int32_t f = 0; f < vConfig.fields; ++f) {
+        ret += "#define " + project + "_Field" + std::to_string(f) + " \"" + std::string(static_cast<size_t>(vConfig.fieldSize), 'x') + "\"\n";
+    }
+    return ret;
+}
+
+static bool isSharedMode(const std::string& vMode) {
+    return vMode == "shared" || vMode == "multi";
+}
+
+// the projects of a run : one, or a batch of consecutive projects in the multi mode
+static int32_t getBatchSize(const Config& vConfig, const std::string& vMode) {
+    return (vMode == "multi") ? std::min(std::max(vConfig.batch, 1), vConfig.projects) : 1;
+}
+
+static std::string getHeaderFile(const Config& vConfig, const std::string& vMode, const int32_t vProject) {
+    if (isSharedMode(vMode)) {
+        return vConfig.workDir + "/" + vMode + "/Versions.h";
+    }
+    return vConfig.workDir + "/per-file/" + getProjectName(vProject) + ".h";
+}
+
+static bool createProjects(const Config& vConfig, const std::string& vMode) {
+    makeDir(vConfig.workDir.c_str());
+    makeDir((vConfig.workDir + "/" + vMode).c_str());
+    if (isSharedMode(vMode)) {
+        std::string content = "#pragma once\n";
+        for (int32_t p = 0; p < vConfig.projects; ++p) {
+            content += "\n" + getProjectBlock(vConfig, p);
+        }
+        return writeFile(getHeaderFile(vConfig, vMode, 0), content);
+    }
+    for (int32_t p = 0; p < vConfig.projects; ++p) {
+        if (!writeFile(getHeaderFile(vConfig, vMode, p), "#pragma once\n\n" + getProjectBlock(vConfig, p))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the projects and the arrival times of all the invocations
+static std::vector<Invocation> getSchedule(const Config& vConfig) {
+    std::mt19937 rng(vConfig.seed);
+    std::uniform_int_distribution<int32_t> projectDist(0, vConfig.projects - 1);
+    std::exponential_distribution<double> gapDist(vConfig.rate);
+    std::vector<Invocation> ret(static_cast<size_t>(vConfig.invocations));
+    double time = 0.0;
+    for (size_t i = 0; i < ret.size(); ++i) {
+        ret[i].project = projectDist(rng);
+        if (vConfig.arrival == "uniform") {
+            ret[i].arrivalSec = static_cast<double>(i) / vConfig.rate;
+        } else if (vConfig.arrival == "poisson") {
+            ret[i].arrivalSec = time;
+            time += gapDist(rng);
+        }
+    }
+    return ret;
+}
+
+// run a process and wait for its end, its output is dropped
+static bool runProcess(const std::vector<std::string>& vArgs) {
+#ifdef WINDOWS_OS
+    std::string cmdLine;
+    for (const auto& arg : vArgs) {
+        cmdLine += "\"" + arg + "\" ";
+    }
+    STARTUPINFOA si = {};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {};
+    if (!CreateProcessA(nullptr, &cmdLine[0], nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)) {
+        return false;
+    }
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    return exitCode == 0;
+#else
+    std::vector<char*> argv;
+    for (const auto& arg : vArgs) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    pid_t pid = 0;
+    const int err = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        return false;
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+static int64_t readBuildNumber(const Config& vConfig, const std::string& vMode, const int32_t vProject) {
+    if (isSharedMode(vMode)) {
+        ez::MultiBuildInc multi(getHeaderFile(vConfig, vMode, vProject));
+        return multi.getProject(getProjectName(vProject)).getBuildNumber();
+    }
+    return ez::BuildInc(getHeaderFile(vConfig, vMode, vProject)).getBuildNumber();
+}
+
+// sum a counter of the json lines of the stats
+static int64_t sumStatsCounter(const std::string& vStatsFile, const std::string& vCounter) {
+    int64_t ret = 0;
+    std::ifstream file(vStatsFile);
+    std::string line;
+    const std::string key = "\"" + vCounter + "\":";
+    while (std::getline(file, line)) {
+        const auto pos = line.find(key);
+        if (pos != std::string::npos) {
+            ret += std::strtoll(line.c_str() + pos + key.size(), nullptr, 10);
+        }
+    }
+    return ret;
+}
+
+static Report runMode(const Config& vConfig, const std::string& vMode) {
+    Report report;
+    report.mode = vMode;
+    createProjects(vConfig, vMode);
+    const std::string fontFile = vConfig.workDir + "/synthetic.flf";
+    writeSyntheticFont(fontFile);
+    const std::string statsFile = vConfig.workDir + "/" + vMode + "/stats.jsonl";
+    std::remove(statsFile.c_str());
+    auto schedule = getSchedule(vConfig);
+    const int32_t batchSize = getBatchSize(vConfig, vMode);
+    schedule.resize((schedule.size() + static_cast<size_t>(batchSize) - 1) / static_cast<size_t>(batchSize));  // the same count of updates
+    std::atomic<size_t> next{0};
+    const auto start = Clock::now();
+    const auto worker = [&]() {
+        while (true) {
+            const size_t idx = next++;
+            if (idx >= schedule.size()) {
+                break;
+            }
+            auto& invocation = schedule[idx];
+            const auto arrival = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(invocation.arrivalSec));
+            std::this_thread::sleep_until(arrival);
+            std::string projects = getProjectName(invocation.project);
+            for (int32_t b = 1; b < batchSize; ++b) {
+                projects += "," + getProjectName((invocation.project + b) % vConfig.projects);
+            }
+            std::vector<std::string> args = {vConfig.buildInc, projects, getHeaderFile(vConfig, vMode, invocation.project)};
+            args.push_back("--stats=" + statsFile);
+            // the same projects use the figfont at each run
+            if (static_cast<double>(invocation.project) < vConfig.figFontRatio * vConfig.projects) {
+                args.push_back("-ff");
+                args.push_back(fontFile);
+            }
+            const auto spawn = Clock::now();
+            invocation.succeed = runProcess(args);
+            const auto end = Clock::now();
+            invocation.latencyMs = std::chrono::duration<double, std::milli>(end - spawn).count();
+            invocation.responseMs = std::chrono::duration<double, std::milli>(end - arrival).count();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < vConfig.concurrency; ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    report.durationSec = std::chrono::duration<double>(Clock::now() - start).count();
+    std::map<int32_t, int64_t> expected;  // succeed increments per project
+    for (const auto& invocation : schedule) {
+        ++report.invocations;
+        if (invocation.succeed) {
+            for (int32_t b = 0; b < batchSize; ++b) {
+                ++expected[(invocation.project + b) % vConfig.projects];
+            }
+            report.updates += batchSize;
+        } else {
+            ++report.failures;
+        }
+        report.latencies.push_back(invocation.latencyMs);
+        report.responses.push_back(invocation.responseMs);
+    }
+    for (const auto& project : expected) {
+        const auto lost = project.second - readBuildNumber(vConfig, vMode, project.first);
+        if (lost > 0) {
+            report.lostUpdates += lost;
+        }
+    }
+    report.filesRead = sumStatsCounter(statsFile, "filesRead");
+    report.bytesRead = sumStatsCounter(statsFile, "bytesRead");
+    report.filesWritten = sumStatsCounter(statsFile, "filesWritten");
+    report.bytesWritten = sumStatsCounter(statsFile, "bytesWritten");
+    std::sort(report.latencies.begin(), report.latencies.end());
+    std::sort(report.responses.begin(), report.responses.end());
+    return report;
+}
+
+static double getPercentile(const std::vector<double>& vSorted, const double vPercent) {
+    if (vSorted.empty()) {
+        return 0.0;
+    }
+    const auto idx = static_cast<size_t>(std::ceil(vPercent / 100.0 * static_cast<double>(vSorted.size()))) - 1;
+    return vSorted[std::min(idx, vSorted.size() - 1)];
+}
+
+static void printReports(const Config& vConfig, const std::vector<Report>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "[\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "    {\"mode\": \"" << r.mode << "\", \"invocations\": " << r.invocations << ", \"failures\": " << r.failures  //
+               << ", \"durationSec\": " << r.durationSec << ", \"throughput\": " << (r.invocations / r.durationSec)  //
+               << ", \"latencyMs\": {\"p50\": " << getPercentile(r.latencies, 50) << ", \"p90\": " << getPercentile(r.latencies, 90)  //
+               << ", \"p99\": " << getPercentile(r.latencies, 99) << ", \"max\": " << getPercentile(r.latencies, 100) << "}"  //
+               << ", \"responseMs\": {\"p50\": " << getPercentile(r.responses, 50) << ", \"p99\": " << getPercentile(r.responses, 99) << "}"  //
+               << ", \"updates\": " << r.updates << ", \"lostUpdates\": " << r.lostUpdates  //
+               << ", \"filesRead\": " << r.filesRead << ", \"bytesRead\": " << r.bytesRead  //
+               << ", \"filesWritten\": " << r.filesWritten << ", \"bytesWritten\": " << r.bytesWritten << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "]\n";
+    } else {
+        ss << "projects " << vConfig.projects << ", invocations " << vConfig.invocations << ", concurrency " << vConfig.concurrency  //
+           << ", arrival " << vConfig.arrival << ", fields " << vConfig.fields << ", figfont ratio " << vConfig.figFontRatio  //
+           << ", batch " << vConfig.batch << "\n";
+        for (const auto& r : vReports) {
+            ss << "-- " << r.mode << "\n";
+            ss << "   throughput    : " << (r.invocations / r.durationSec) << " inv/s (" << r.durationSec << " s, " << r.failures << " failures)\n";
+            ss << "   latency ms    : p50 " << getPercentile(r.latencies, 50) << ", p90 " << getPercentile(r.latencies, 90)  //
+               << ", p99 " << getPercentile(r.latencies, 99) << ", max " << getPercentile(r.latencies, 100) << "\n";
+            ss << "   response ms   : p50 " << getPercentile(r.responses, 50) << ", p99 " << getPercentile(r.responses, 99) << "\n";
+            const double updates = static_cast<double>(std::max<int64_t>(r.updates, 1));
+            ss << "   updates       : " << r.updates << " projects (" << (r.updates / r.durationSec) << " /s), lost " << r.lostUpdates << "\n";
+            ss << "   files read    : " << r.filesRead << " (" << r.bytesRead << " bytes, " << (r.bytesRead / updates) << " per update)\n";
+            ss << "   files written : " << r.filesWritten << " (" << r.bytesWritten << " bytes, " << (r.bytesWritten / updates) << " per update)\n";
+        }
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncLoad");
+    args.addOptional("--buildinc").help("BuildInc executable (default: next to this one)", "<file>").delimiter(' ');
+    args.addOptional("--work-dir").help("directory of the synthetic projects (default: BuildIncLoad.work)", "<dir>").delimiter(' ');
+    args.addOptional("--mode").help("shared, per-file, multi or all (default: all)", "<mode>").delimiter(' ');
+    args.addOptional("--projects").help("count of projects (default: 100)", "<M>").delimiter(' ');
+    args.addOptional("--invocations").help("count of BuildInc runs (default: 1000)", "<count>").delimiter(' ');
+    args.addOptional("--concurrency").help("count of concurrent BuildInc runs (default: 8)", "<N>").delimiter(' ');
+    args.addOptional("--batch").help("projects of the shared header incremented per run in the multi mode (default: 10)", "<B>").delimiter(' ');
+    args.addOptional("--arrival").help("burst, uniform or poisson (default: burst)", "<pattern>").delimiter(' ');
+    args.addOptional("--rate").help("runs per second of the uniform and poisson arrivals (default: 200)", "<rate>").delimiter(' ');
+    args.addOptional("--fields").help("user fields per project, for bigger headers (default: 0)", "<count>").delimiter(' ');
+    args.addOptional("--field-size").help("chars of a user field (default: 16)", "<count>").delimiter(' ');
+    args.addOptional("--figfont-ratio").help("part of the projects using a FigFont label, 0 to 1 (default: 0)", "<ratio>").delimiter(' ');
+    args.addOptional("--seed").help("seed of the schedule (default: 1)", "<seed>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    // ez::App set the current dir to the dir of the app, the paths given to BuildInc must be absolute
+    char cwd[MAX_PATH + 1] = {};
+    const std::string appDir = (GetCurrentDir(cwd, MAX_PATH) != nullptr) ? std::string(cwd) : app.getAppPath();
+    Config config;
+    config.buildInc = args.getValue<std::string>("buildinc");
+    if (config.buildInc.empty()) {
+#ifdef WINDOWS_OS
+        config.buildInc = appDir + "/BuildInc.exe";
+#else
+        config.buildInc = appDir + "/BuildInc";
+#endif
+    }
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = appDir + "/BuildIncLoad.work";
+    }
+    const std::pair<const char*, int32_t*> intArgs[] = {
+        {"projects", &config.projects},
+        {"invocations", &config.invocations},
+        {"concurrency", &config.concurrency},
+        {"batch", &config.batch},
+        {"fields", &config.fields},
+        {"field-size", &config.fieldSize},
+    };
+    for (const auto& arg : intArgs) {
+        if (args.hasValue(arg.first)) {
+            *arg.second = std::max(args.getValue<int32_t>(arg.first), 0);
+        }
+    }
+    config.projects = std::max(config.projects, 1);
+    config.concurrency = std::max(config.concurrency, 1);
+    if (args.hasValue("mode")) {
+        config.mode = args.getValue<std::string>("mode");
+    }
+    if (args.hasValue("arrival")) {
+        config.arrival = args.getValue<std::string>("arrival");
+    }
+    if (args.hasValue("rate")) {
+        config.rate = std::max(args.getValue<double>("rate"), 0.001);
+    }
+    if (args.hasValue("figfont-ratio")) {
+        config.figFontRatio = args.getValue<double>("figfont-ratio");
+    }
+    if (args.hasValue("seed")) {
+        config.seed = args.getValue<uint32_t>("seed");
+    }
+    config.json = args.isPresent("json");
+    std::vector<Report> reports;
+    for (const auto* mode : {"shared", "per-file", "multi"}) {
+        if (config.mode == "all" || config.mode == mode) {
+            reports.push_back(runMode(config, mode));
+        }
+    }
+    printReports(config, reports);
+    return 0;
+}
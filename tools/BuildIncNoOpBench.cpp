@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// No-op build with the depfile :
+// a make rule generates the header with --depfile, then make is run again without change.
+// the no-op builds must not run BuildInc, and make must not drop a circular dependency.
+// they are timed against a rule always run, then the FigFont is touched and must rerun the rule
+
+#include "BenchUtils.hpp"
+
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <thread>
+#include <iomanip>
+#include <iostream>
+
+struct Config {
+    std::string buildInc;
+    std::string make = "make";
+    std::string workDir;
+    int32_t iterations = 20;
+    bool json = false;
+};
+
+struct Report {
+    double noOpMs = 0.0;  // median of a make without change
+    double alwaysMs = 0.0;  // median of a make running BuildInc each time
+    int32_t noOpReruns = 0;  // BuildInc runs during the no-op builds
+    int32_t circularWarnings = 0;
+    bool targetInDepFile = false;  // the header listed in its own prerequisites
+    bool rerunOnFontChange = false;
+    int32_t failures = 0;
+};
+
+static int64_t readBuildNumber(const std::string& vHeader) {
+    ez::BuildInc builder(vHeader);
+    return builder.getBuildNumber();
+}
+
+static std::string getMakefile(const Config& vConfig, const bool vAlways) {
+    const auto header = vConfig.workDir + "/Build.h";
+    std::string ret;
+    ret += "all: " + header + "\n";
+    if (vAlways) {
+        ret += ".PHONY: " + header + "\n";
+    }
+    ret += header + ":\n";
+    ret += "\t" + vConfig.buildInc + " Bench " + header + " -ff " + vConfig.workDir + "/font.flf --depfile " + vConfig.workDir + "/Build.h.d\n";
+    ret += "-include " + vConfig.workDir + "/Build.h.d\n";
+    return ret;
+}
+
+static int32_t countOccurrences(const std::string& vText, const std::string& vWord) {
+    int32_t ret = 0;
+    for (auto pos = vText.find(vWord); pos != std::string::npos; pos = vText.find(vWord, pos + 1)) {
+        ++ret;
+    }
+    return ret;
+}
+
+static Report run(const Config& vConfig) {
+    Report report;
+    const auto header = vConfig.workDir + "/Build.h";
+    const auto errFile = vConfig.workDir + "/make.err";
+    const auto makefile = vConfig.workDir + "/Makefile";
+    const auto font = vConfig.workDir + "/font.flf";
+    std::remove(header.c_str());
+    std::remove(errFile.c_str());
+    bench::writeFile(font, bench::getSyntheticFont());
+    const std::vector<std::string> makeArgs = {vConfig.make, "-s", "-f", makefile};
+    // the no-op builds, after a first build
+    bench::writeFile(makefile, getMakefile(vConfig, false));
+    report.failures += bench::runProcess(makeArgs, errFile) ? 0 : 1;
+    const int64_t built = readBuildNumber(header);
+    std::vector<double> samples;
+    for (int32_t i = 0; i < vConfig.iterations; ++i) {
+        const auto start = bench::Clock::now();
+        report.failures += bench::runProcess(makeArgs, errFile) ? 0 : 1;
+        samples.push_back(bench::getElapsedMs(start));
+    }
+    report.noOpMs = bench::getMedian(samples);
+    report.noOpReruns = static_cast<int32_t>(readBuildNumber(header) - built);
+    // a change of the font must rerun the rule
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));  // a newer mtime
+    bench::writeFile(font, bench::readFile(font));
+    report.failures += bench::runProcess(makeArgs, errFile) ? 0 : 1;
+    report.rerunOnFontChange = (readBuildNumber(header) == built + report.noOpReruns + 1);
+    const auto depFile = bench::readFile(vConfig.workDir + "/Build.h.d");
+    report.targetInDepFile = (depFile.find(header, depFile.find(':')) != std::string::npos);
+    // the rule always run, make warns of a circular dependency each time here, not only when the depfile is older
+    bench::writeFile(makefile, getMakefile(vConfig, true));
+    samples.clear();
+    for (int32_t i = 0; i < vConfig.iterations; ++i) {
+        const auto start = bench::Clock::now();
+        report.failures += bench::runProcess(makeArgs, errFile) ? 0 : 1;
+        samples.push_back(bench::getElapsedMs(start));
+    }
+    report.alwaysMs = bench::getMedian(samples);
+    report.circularWarnings = countOccurrences(bench::readFile(errFile), "Circular");
+    return report;
+}
+
+static void printReport(const Config& vConfig, const Report& vReport) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "{\"iterations\": " << vConfig.iterations << ", \"failures\": " << vReport.failures << ", \"noOpMs\": " << vReport.noOpMs  //
+           << ", \"alwaysMs\": " << vReport.alwaysMs << ", \"noOpReruns\": " << vReport.noOpReruns << ", \"circularWarnings\": " << vReport.circularWarnings  //
+           << ", \"targetInDepFile\": " << (vReport.targetInDepFile ? "true" : "false")  //
+           << ", \"rerunOnFontChange\": " << (vReport.rerunOnFontChange ? "true" : "false") << "}\n";
+    } else {
+        ss << vConfig.make << ", " << vConfig.iterations << " builds per case" << (vReport.failures ? ", " + std::to_string(vReport.failures) + " failures" : std::string()) << "\n";
+        ss << "no-op build ms          : " << vReport.noOpMs << "\n";
+        ss << "build running BuildInc  : " << vReport.alwaysMs << "\n";
+        ss << "reruns in no-op builds  : " << vReport.noOpReruns << "\n";
+        ss << "circular warnings       : " << vReport.circularWarnings << "\n";
+        ss << "target in depfile       : " << (vReport.targetInDepFile ? "yes" : "no") << "\n";
+        ss << "rerun on font change    : " << (vReport.rerunOnFontChange ? "yes" : "no") << "\n";
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncNoOpBench");
+    args.addOptional("--buildinc").help("BuildInc executable (default: next to this one)", "<file>").delimiter(' ');
+    args.addOptional("--make").help("make executable (default: make)", "<file>").delimiter(' ');
+    args.addOptional("--work-dir").help("directory of the makefile and the header (default: BuildIncNoOpBench.work)", "<dir>").delimiter(' ');
+    args.addOptional("--iterations").help("builds per case (default: 20)", "<count>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    const auto appDir = bench::getAppDir(app);
+    Config config;
+    config.buildInc = args.getValue<std::string>("buildinc");
+    if (config.buildInc.empty()) {
+        config.buildInc = bench::getBuildInc(appDir);
+    }
+    if (args.hasValue("make")) {
+        config.make = args.getValue<std::string>("make");
+    }
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = appDir + "/BuildIncNoOpBench.work";
+    }
+    if (args.hasValue("iterations")) {
+        config.iterations = std::max(args.getValue<int32_t>("iterations"), 1);
+    }
+    config.json = args.isPresent("json");
+    bench::makeDir(config.workDir);
+    const auto report = run(config);
+    printReport(config, report);
+    return (report.failures == 0 && report.noOpReruns == 0 && report.circularWarnings == 0 && !report.targetInDepFile && report.rerunOnFontChange) ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Scaling of the multi-project work on the work stealing pool :
+// P headers are parsed, bumped and rendered in memory, one task per header as the bump of --scan.
+// a block of them load a FigFont and render a long banner (the projects of one directory using it),
+// the others only bump a number. the pool is compared to a static split of the headers by thread.
+// the bound is the speedup allowed by the split of the costs of the tasks, measured one by one :
+// the heaviest range for the static split, a list scheduling in the order of submission for the pool
+
+#include "BenchUtils.hpp"
+
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezFigFont.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+#include <ezlibs/ezThreadPool.hpp>
+
+#include <queue>
+#include <thread>
+#include <numeric>
+#include <iomanip>
+#include <iostream>
+
+struct Config {
+    std::string figFont;
+    std::vector<int32_t> threads;
+    int32_t projects = 2000;
+    double figFontRatio = 0.1;  // the first projects use the figfont
+    int32_t iterations = 5;
+    bool json = false;
+};
+
+struct Report {
+    std::string mode;
+    int32_t threads = 0;
+    double durationMs = 0.0;  // median
+    double speedup = 0.0;  // against the same mode with the first thread count, 1 by default
+    double bound = 0.0;  // the speedup allowed by the costs of the tasks
+};
+
+struct Project {
+    std::string file;
+    std::string content;
+    bool figFont = false;
+};
+
+static std::vector<Project> makeProjects(const Config& vConfig) {
+    std::vector<Project> ret(static_cast<size_t>(vConfig.projects));
+    const auto figFonts = static_cast<size_t>(vConfig.projects * vConfig.figFontRatio);
+    for (size_t i = 0; i < ret.size(); ++i) {
+        const auto name = "Project" + std::to_string(i);
+        ret[i].file = "dir/" + name + "/Build.h";
+        ret[i].figFont = (i < figFonts);
+        ez::BuildInc builder(ret[i].file, false);
+        builder.setProject(name).setLabel(name).setMinor(2).setBuildNumber(static_cast<int64_t>(i));
+        builder.render(ez::BuildInc::OutputFormat::Header, ret[i].content);
+    }
+    return ret;
+}
+
+// the work of the bump of one file
+static size_t bump(const Config& vConfig, const Project& vProject) {
+    ez::BuildInc builder(vProject.file, false);
+    builder.parse(vProject.content);
+    builder.incBuildNumber();
+    if (vProject.figFont) {
+        builder.setLabel(builder.getProject() + " with its long banner").setFigFontFile(vConfig.figFont).useBuildNumber(true);
+    }
+    std::string rendered;
+    builder.render(ez::BuildInc::OutputFormat::Header, rendered);
+    return rendered.size();
+}
+
+static double runOnce(const Config& vConfig, const std::vector<Project>& vProjects, const std::string& vMode, const int32_t vThreads) {
+    std::vector<size_t> sizes(vProjects.size(), 0);
+    const auto start = bench::Clock::now();
+    if (vMode == "pool") {
+        ez::ThreadPool pool(static_cast<size_t>(vThreads));
+        pool.parallelFor(vProjects.size(), [&](const size_t i) { sizes[i] = bump(vConfig, vProjects[i]); });
+    } else {  // static : a contiguous range per thread
+        std::vector<std::thread> threads;
+        const size_t perThread = (vProjects.size() + static_cast<size_t>(vThreads) - 1) / static_cast<size_t>(vThreads);
+        for (int32_t t = 0; t < vThreads; ++t) {
+            const size_t begin = std::min(vProjects.size(), static_cast<size_t>(t) * perThread);
+            const size_t end = std::min(vProjects.size(), begin + perThread);
+            threads.emplace_back([&, begin, end]() {
+                for (size_t i = begin; i < end; ++i) {
+                    sizes[i] = bump(vConfig, vProjects[i]);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    return bench::getElapsedMs(start);
+}
+
+// the duration of each task, alone
+static std::vector<double> getTaskCosts(const Config& vConfig, const std::vector<Project>& vProjects) {
+    std::vector<double> ret;
+    for (const auto& project : vProjects) {
+        const auto start = bench::Clock::now();
+        bump(vConfig, project);
+        ret.push_back(bench::getElapsedMs(start));
+    }
+    return ret;
+}
+
+static double getBound(const std::vector<double>& vCosts, const std::string& vMode, const int32_t vThreads) {
+    const double total = std::accumulate(vCosts.begin(), vCosts.end(), 0.0);
+    double makespan = 0.0;
+    if (vMode == "pool") {  // each task to the first worker free
+        std::priority_queue<double, std::vector<double>, std::greater<double>> workers;
+        for (int32_t t = 0; t < vThreads; ++t) {
+            workers.push(0.0);
+        }
+        for (const auto cost : vCosts) {
+            const double end = workers.top() + cost;
+            workers.pop();
+            workers.push(end);
+            makespan = std::max(makespan, end);
+        }
+    } else {
+        const size_t perThread = (vCosts.size() + static_cast<size_t>(vThreads) - 1) / static_cast<size_t>(vThreads);
+        for (size_t begin = 0; begin < vCosts.size(); begin += perThread) {
+            const auto end = vCosts.begin() + static_cast<std::ptrdiff_t>(std::min(vCosts.size(), begin + perThread));
+            makespan = std::max(makespan, std::accumulate(vCosts.begin() + static_cast<std::ptrdiff_t>(begin), end, 0.0));
+        }
+    }
+    return (makespan > 0.0) ? total / makespan : 0.0;
+}
+
+static void printReports(const Config& vConfig, const std::vector<Report>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (vConfig.json) {
+        ss << "[\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "    {\"mode\": \"" << r.mode << "\", \"threads\": " << r.threads << ", \"durationMs\": " << r.durationMs << ", \"speedup\": " << r.speedup << ", \"bound\": " << r.bound << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "]\n";
+    } else {
+        ss << vConfig.projects << " projects, " << static_cast<int32_t>(vConfig.projects * vConfig.figFontRatio) << " with a figfont banner, "  //
+           << std::thread::hardware_concurrency() << " cores, median of " << vConfig.iterations << "\n";
+        ss << "mode     threads   duration ms   speedup   bound\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(8) << r.mode << std::right << std::setw(8) << r.threads << std::setw(14) << r.durationMs << std::setw(10) << r.speedup << std::setw(8) << r.bound << "\n";
+        }
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncPoolBench");
+    args.addOptional("--threads").help("thread counts, comma separated (default: 1,2,4,.. up to the cores)", "<T[,T]>").delimiter(' ');
+    args.addOptional("--projects").help("count of headers (default: 2000)", "<count>").delimiter(' ');
+    args.addOptional("--figfont").help("FigFont of the banners (default: a generated box font)", "<file>").delimiter(' ');
+    args.addOptional("--figfont-ratio").help("part of the headers with a banner, the first ones (default: 0.1)", "<ratio>").delimiter(' ');
+    args.addOptional("--iterations").help("runs per case (default: 5)", "<count>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    Config config;
+    for (const auto& count : ez::str::splitStringToVector(args.getValue<std::string>("threads"), ',')) {
+        int32_t threads = 0;
+        if (ez::str::stringToNumber(count, threads) && threads > 0) {
+            config.threads.push_back(threads);
+        }
+    }
+    if (config.threads.empty()) {
+        const int32_t cores = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1U));
+        for (int32_t threads = 1; threads < cores; threads *= 2) {
+            config.threads.push_back(threads);
+        }
+        config.threads.push_back(cores);
+    }
+    if (args.hasValue("projects")) {
+        config.projects = std::max(args.getValue<int32_t>("projects"), 1);
+    }
+    if (args.hasValue("figfont")) {
+        config.figFont = args.getValue<std::string>("figfont");
+    } else {
+        config.figFont = bench::getAppDir(app) + "/BuildIncPoolBench.flf";
+        bench::writeFile(config.figFont, bench::getSyntheticFont());
+    }
+    if (args.hasValue("figfont-ratio")) {
+        config.figFontRatio = std::min(std::max(args.getValue<double>("figfont-ratio"), 0.0), 1.0);
+    }
+    if (args.hasValue("iterations")) {
+        config.iterations = std::max(args.getValue<int32_t>("iterations"), 1);
+    }
+    config.json = args.isPresent("json");
+    const auto projects = makeProjects(config);
+    const auto costs = getTaskCosts(config, projects);
+    std::vector<Report> reports;
+    for (const std::string mode : {"static", "pool"}) {
+        double firstMs = 0.0;
+        for (const auto threads : config.threads) {
+            std::vector<double> samples;
+            for (int32_t it = 0; it < config.iterations; ++it) {
+                samples.push_back(runOnce(config, projects, mode, threads));
+            }
+            Report report;
+            report.mode = mode;
+            report.threads = threads;
+            report.durationMs = bench::getMedian(samples);
+            if (firstMs == 0.0) {
+                firstMs = report.durationMs;
+            }
+            report.speedup = firstMs / report.durationMs;
+            report.bound = getBound(costs, mode, threads);
+            reports.push_back(report);
+        }
+    }
+    printReports(config, reports);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+MIT License
+
+Copyright (c) 2022-2024 Stephane Cuillerdier (aka aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Sharded numbering against the single file numbering :
+// W workers increment one project, each with its shard or all on the single header,
+// the throughput is reported per worker count, with the backward steps of the header seen by a reader
+
+#include "BenchUtils.hpp"
+
+#include <ezlibs/ezArgs.hpp>
+#include <ezlibs/ezBuildInc.hpp>
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <iomanip>
+#include <iostream>
+
+struct Config {
+    std::string buildInc;
+    std::string workDir;
+    std::vector<int32_t> workers;
+    int32_t runs = 50;  // per worker
+    bool json = false;
+};
+
+struct Report {
+    std::string mode;
+    int32_t workers = 0;
+    int32_t runs = 0;
+    int32_t failures = 0;
+    double durationMs = 0.0;
+    int64_t headerNumber = 0;
+    int64_t expectedNumber = 0;  // the runs for the single file, the highest committed for the shards
+    int32_t backSteps = 0;  // the header number seen going back
+};
+
+// the header is replaced by a rename, a reader sees the previous or the next one
+static int64_t readHeaderNumber(const std::string& vFile) {
+    return ez::BuildInc(vFile).getBuildNumber();
+}
+
+static Report runMode(const Config& vConfig, const std::string& vMode, const int32_t vWorkers) {
+    Report report;
+    report.mode = vMode;
+    report.workers = vWorkers;
+    report.runs = vWorkers * vConfig.runs;
+    const auto dir = vConfig.workDir + "/" + vMode + "-" + std::to_string(vWorkers);
+    bench::makeDir(dir);
+    const auto header = dir + "/Build.h";
+    std::remove(header.c_str());
+    std::remove((header + ".shards").c_str());
+    std::atomic<bool> running(true);
+    std::thread reader([&]() {  // the header must never go back
+        int64_t last = 0;
+        while (running) {
+            const int64_t number = readHeaderNumber(header);
+            if (number < last) {
+                ++report.backSteps;
+            }
+            last = std::max(last, number);
+        }
+    });
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    const auto start = bench::Clock::now();
+    for (int32_t w = 1; w <= vWorkers; ++w) {
+        threads.emplace_back([&, w]() {
+            std::vector<std::string> args = {vConfig.buildInc, "Bench", header};
+            if (vMode == "shard") {
+                args.push_back("--shard");
+                args.push_back(std::to_string(w) + "/" + std::to_string(vWorkers));
+            }
+            int32_t failures = 0;
+            for (int32_t r = 0; r < vConfig.runs; ++r) {
+                failures += bench::runProcess(args) ? 0 : 1;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            report.failures += failures;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    report.durationMs = bench::getElapsedMs(start);
+    running = false;
+    reader.join();
+    report.headerNumber = readHeaderNumber(header);
+    if (vMode == "shard") {
+        report.expectedNumber = ez::ShardBuildNumber(header + ".shards", 1, vWorkers).getHighestCommitted();
+    } else {
+        report.expectedNumber = report.runs;
+    }
+    return report;
+}
+
+static void printReports(const Config& vConfig, const std::vector<Report>& vReports) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if (vConfig.json) {
+        ss << "[\n";
+        for (size_t i = 0; i < vReports.size(); ++i) {
+            const auto& r = vReports[i];
+            ss << "    {\"mode\": \"" << r.mode << "\", \"workers\": " << r.workers << ", \"runs\": " << r.runs << ", \"failures\": " << r.failures  //
+               << ", \"durationMs\": " << r.durationMs << ", \"runsPerSec\": " << (r.runs * 1000.0 / r.durationMs)  //
+               << ", \"headerNumber\": " << r.headerNumber << ", \"expectedNumber\": " << r.expectedNumber << ", \"backSteps\": " << r.backSteps << "}"
+               << ((i + 1 < vReports.size()) ? ",\n" : "\n");
+        }
+        ss << "]\n";
+    } else {
+        ss << "runs per worker " << vConfig.runs << "\n";
+        ss << "mode    workers   runs/s   failures   header   expected   back steps\n";
+        for (const auto& r : vReports) {
+            ss << std::left << std::setw(8) << r.mode << std::right << std::setw(7) << r.workers << std::setw(9) << (r.runs * 1000.0 / r.durationMs)  //
+               << std::setw(11) << r.failures << std::setw(9) << r.headerNumber << std::setw(11) << r.expectedNumber << std::setw(13) << r.backSteps << "\n";
+        }
+    }
+    std::cout << ss.str();
+}
+
+int main(int vArgc, char* vArgv[]) {
+    ez::App app(vArgc, vArgv);
+    ez::Args args("BuildIncShardBench");
+    args.addOptional("--buildinc").help("BuildInc executable (default: next to this one)", "<file>").delimiter(' ');
+    args.addOptional("--work-dir").help("directory of the headers (default: BuildIncShardBench.work)", "<dir>").delimiter(' ');
+    args.addOptional("--workers").help("worker counts, comma separated (default: 1,2,4,.. up to 2 x the cores)", "<W[,W]>").delimiter(' ');
+    args.addOptional("--runs").help("increments per worker (default: 50)", "<count>").delimiter(' ');
+    args.addOptional("--json").help("print the report in json", {});
+    if (!args.parse(vArgc, vArgv)) {
+        args.printHelp();
+        return 1;
+    }
+    if (args.isPresent("help")) {  // printed by the parsing
+        return 0;
+    }
+    const auto appDir = bench::getAppDir(app);
+    Config config;
+    config.buildInc = args.getValue<std::string>("buildinc");
+    if (config.buildInc.empty()) {
+        config.buildInc = bench::getBuildInc(appDir);
+    }
+    config.workDir = args.getValue<std::string>("work-dir");
+    if (config.workDir.empty()) {
+        config.workDir = appDir + "/BuildIncShardBench.work";
+    }
+    for (const auto& count : ez::str::splitStringToVector(args.getValue<std::string>("workers"), ',')) {
+        int32_t workers = 0;
+        if (ez::str::stringToNumber(count, workers) && workers > 0) {
+            config.workers.push_back(workers);
+        }
+    }
+    if (config.workers.empty()) {
+        const int32_t maxWorkers = 2 * static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1U));
+        for (int32_t workers = 1; workers <= maxWorkers; workers *= 2) {
+            config.workers.push_back(workers);
+        }
+    }
+    if (args.hasValue("runs")) {
+        config.runs = std::max(args.getValue<int32_t>("runs"), 1);
+    }
+    config.json = args.isPresent("json");
+    bench::makeDir(config.workDir);
+    std::vector<Report> reports;
+    for (const auto workers : config.workers) {
+        reports.push_back(runMode(config, "single", workers));
+        reports.push_back(runMode(config, "shard", workers));
+    }
+    printReports(config, reports);
+    return 0;
+}